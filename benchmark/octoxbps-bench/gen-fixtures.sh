@@ -0,0 +1,115 @@
+#!/bin/sh
+# Writes the xbps output the benchmarks read from "fixtures". It is generated, not recorded:
+# names, versions, descriptions and paths are made up, but every line has the layout the
+# OctoXBPS parsers expect from xbps-query -Rs, xbps-query -f and xbps-install.
+# A fixed seed is used, so running it again gives the very same files.
+#
+# Usage: gen-fixtures.sh [-s <seed>] [-o <outdir>]
+
+SEED=2024
+OUTDIR=""
+
+while getopts "s:o:" opt
+do
+  case "$opt" in
+    s) SEED="$OPTARG" ;;
+    o) OUTDIR="$OPTARG" ;;
+    *) echo "Usage: $0 [-s <seed>] [-o <outdir>]"; exit 1 ;;
+  esac
+done
+
+if [ -z "$OUTDIR" ]
+then
+  OUTDIR="$(cd "$(dirname "$0")" && pwd)/fixtures"
+fi
+
+mkdir -p "$OUTDIR" || exit 1
+
+# Park-Miller generator, so the output does not depend on the awk implementation
+AWK_RANDOM='
+function rnd(n) { seed = (seed * 16807) % 2147483647; return seed % n }
+BEGIN {
+  split("bzip2 ffmpeg gnome go gtk lua mesa openssl perl qt5 rust xfce xorg xz zlib", prefixes, " ")
+  split("base common core data devel doc extra plugins tools utils", kinds, " ")
+  split("bindings client codec compiler daemon driver editor extension framework library manager parser plugin server terminal theme tool utility widget", words, " ")
+  split(".so .h .py .conf .mo .1", extensions, " ")
+  split("/etc/pkg /usr/bin /usr/include /usr/lib /usr/share/man/man1", dirs, " ")
+}
+function pkgname(  name) {
+  name = prefixes[rnd(15) + 1] "-" kinds[rnd(10) + 1]
+  if (rnd(2) == 1) name = name "-" words[rnd(19) + 1]
+  return name
+}
+'
+
+# "xbps-query -Rs" (400 packages, about half of them installed)
+awk -v seed="$SEED" "$AWK_RANDOM"'
+BEGIN {
+  while (count < 400)
+  {
+    name = pkgname()
+    if (name in seen) continue
+    seen[name] = 1
+    count++
+
+    desc = words[rnd(19) + 1]
+    desc = toupper(substr(desc, 1, 1)) substr(desc, 2)
+    n = rnd(6) + 1
+    for (i = 0; i < n; i++) desc = desc " " words[rnd(19) + 1]
+
+    printf("%s %s-%d.%d.%d_%d %s\n", (rnd(2) == 1 ? "[*]" : "[-]"), name,
+           rnd(5) + 1, rnd(30) + 1, rnd(10), rnd(4) + 1, desc)
+  }
+}' | LC_ALL=C sort -k2,2 > "$OUTDIR/xbps-query-Rs.txt"
+
+# "xbps-query -f" (600 files, some of them in subdirectories xbps does not list)
+awk -v seed="$SEED" "$AWK_RANDOM"'
+BEGIN {
+  while (count < 600)
+  {
+    path = dirs[rnd(5) + 1]
+    n = rnd(4)
+    for (i = 0; i < n; i++) path = path "/" words[rnd(19) + 1]
+
+    file = path "/" words[rnd(19) + 1] rnd(600)
+    if (rnd(6) > 0) file = file extensions[rnd(6) + 1]
+    if (file in seen) continue
+    seen[file] = 1
+    count++
+
+    print file
+  }
+}' | LC_ALL=C sort > "$OUTDIR/xbps-query-f.txt"
+
+# "xbps-install" of 40 packages, with every step xbps prints
+awk -v seed="$SEED" "$AWK_RANDOM"'
+BEGIN {
+  while (count < 40)
+  {
+    name = pkgname()
+    if (name in seen) continue
+    seen[name] = 1
+    pkgs[++count] = name "-1.0_1"
+  }
+
+  print "[*] Downloading binary packages"
+  for (i = 1; i <= count; i++)
+    printf("%s.x86_64.xbps: %d KB [avg rate: %d KB/s]\n", pkgs[i], rnd(9000) + 100, rnd(9000) + 100)
+  for (i = 1; i <= count; i++) print pkgs[i] ": verifying RSA signature..."
+
+  print "[*] Collecting package files"
+  for (i = 1; i <= count; i++) print pkgs[i] ": collecting files..."
+
+  print "[*] Unpacking packages"
+  for (i = 1; i <= count; i++) printf("(%3d/%d) %s: unpacking ...\n", i, count, pkgs[i])
+
+  print "[*] Configuring unpacked packages"
+  for (i = 1; i <= count; i++)
+  {
+    print pkgs[i] ": configuring ..."
+    print pkgs[i] ": installed successfully."
+  }
+
+  print ""
+  printf("%d downloaded, %d installed, 0 updated, %d configured, 0 removed.\n", count, count, count)
+}' > "$OUTDIR/xbps-install.txt"
@@ -0,0 +1,71 @@
+#-------------------------------------------------
+#
+# Benchmarks for the parsers and models of OctoXBPS
+# Run: ../bin/octoxbps-bench -platform offscreen
+#
+#-------------------------------------------------
+
+QT += core xml gui network widgets testlib
+
+CONFIG += qt console warn_on release
+QMAKE_CXXFLAGS += -std=c++11
+INCLUDEPATH += ../..
+TARGET = octoxbps-bench
+TEMPLATE = app
+DESTDIR += ../bin
+OBJECTS_DIR += ../build-octoxbps-bench
+MOC_DIR += ../build-octoxbps-bench
+UI_DIR += ../build-octoxbps-bench
+
+SOURCES += octoxbpsbench.cpp \
+    ../../src/terminal.cpp \
+    ../../src/unixcommand.cpp \
+    ../../src/unixcommand_query.cpp \
+    ../../src/privilegedhelperclient.cpp \
+    ../../src/queryrecorder.cpp \
+    ../../src/tracer.cpp \
+    ../../src/processaccounting.cpp \
+    ../../src/package.cpp \
+    ../../src/xbpsplist.cpp \
+    ../../src/dependencygraph.cpp \
+    ../../src/searchindex.cpp \
+    ../../src/packagecacheindex.cpp \
+    ../../src/packagerepository.cpp \
+    ../../src/model/packagemodel.cpp \
+    ../../src/wmhelper.cpp \
+    ../../src/systemcapabilities.cpp \
+    ../../src/pathresolver.cpp \
+    ../../src/settingsmanager.cpp \
+    ../../src/utils.cpp \
+    ../../src/argumentlist.cpp \
+    ../../src/xbpsexec.cpp \
+    ../../src/searchlineedit.cpp \
+    ../../src/searchbar.cpp
+
+HEADERS  += \
+    ../../src/uihelper.h \
+    ../../src/terminal.h \
+    ../../src/unixcommand.h \
+    ../../src/privilegedhelperclient.h \
+    ../../src/queryrecorder.h \
+    ../../src/tracer.h \
+    ../../src/processaccounting.h \
+    ../../src/wmhelper.h \
+    ../../src/systemcapabilities.h \
+    ../../src/pathresolver.h \
+    ../../src/strconstants.h \
+    ../../src/package.h \
+    ../../src/xbpsplist.h \
+    ../../src/dependencygraph.h \
+    ../../src/searchindex.h \
+    ../../src/packagecacheindex.h \
+    ../../src/packagerepository.h \
+    ../../src/model/packagemodel.h \
+    ../../src/utils.h \
+    ../../src/argumentlist.h \
+    ../../src/xbpsexec.h \
+    ../../src/searchlineedit.h \
+    ../../src/searchbar.h
+
+RESOURCES += \
+    ../../resources.qrc
@@ -0,0 +1,342 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+/*
+ * QBENCHMARK suites for the parsers and models used while (re)building the package list.
+ * They run on xbps-like output kept in "fixtures" (written by gen-fixtures.sh, not recorded from
+ * a real system), which is replicated "scale" times (with renamed packages) to see how each
+ * one grows with the size of the repositories.
+ */
+
+#include "src/package.h"
+#include "src/packagerepository.h"
+#include "src/model/packagemodel.h"
+#include "src/xbpsexec.h"
+
+#include <QtTest>
+#include <QFile>
+
+class OctoXBPSBench : public QObject
+{
+  Q_OBJECT
+
+private:
+  static QString readFixture(const QString &fileName);
+  static QString replicatePackageList(const QString &pkgList, int scale);
+  static QStringList replicateFileList(const QStringList &fileList, int scale);
+  static void addScaleColumn();
+
+private slots:
+  void parsePackageList_data();
+  void parsePackageList();
+  void parsePackageTuple_data();
+  void parsePackageTuple();
+  void addDirectoriesToFileList_data();
+  void addDirectoriesToFileList();
+  void rpmvercmp();
+  void repositorySetData_data();
+  void repositorySetData();
+  void modelApplyFilter_data();
+  void modelApplyFilter();
+  void modelSort_data();
+  void modelSort();
+  void splitOutputStrings();
+};
+
+/*
+ * Returns the contents of the given file from the fixtures directory
+ */
+QString OctoXBPSBench::readFixture(const QString &fileName)
+{
+  QFile file(QFINDTESTDATA("fixtures/" + fileName));
+
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    qWarning() << "Could not open fixture" << fileName;
+    return "";
+  }
+
+  return QString::fromUtf8(file.readAll());
+}
+
+/*
+ * Repeats the "xbps-query -Rs" output "scale" times, giving each copy its own package names
+ */
+QString OctoXBPSBench::replicatePackageList(const QString &pkgList, int scale)
+{
+  QStringList lines = pkgList.split("\n", QString::SkipEmptyParts);
+  QStringList res;
+
+  for (int c=0; c<scale; c++)
+  {
+    foreach(QString line, lines)
+    {
+      QStringList parts = line.split(' ');
+      if (c > 0 && parts.count() > 1)
+      {
+        int dash = parts[1].lastIndexOf("-");
+        parts[1].insert(dash, "-" + QString::number(c));
+      }
+
+      res.append(parts.join(" "));
+    }
+  }
+
+  return res.join("\n");
+}
+
+/*
+ * Repeats the file list "scale" times, each copy living in its own prefix
+ */
+QStringList OctoXBPSBench::replicateFileList(const QStringList &fileList, int scale)
+{
+  QStringList res = fileList;
+
+  for (int c=1; c<scale; c++)
+  {
+    foreach(QString file, fileList)
+    {
+      res.append("/opt/copy" + QString::number(c) + file);
+    }
+  }
+
+  return res;
+}
+
+void OctoXBPSBench::addScaleColumn()
+{
+  QTest::addColumn<int>("scale");
+
+  QTest::newRow("x1") << 1;
+  QTest::newRow("x10") << 10;
+  QTest::newRow("x25") << 25;
+}
+
+void OctoXBPSBench::parsePackageList_data()
+{
+  addScaleColumn();
+}
+
+void OctoXBPSBench::parsePackageList()
+{
+  QFETCH(int, scale);
+  QString pkgList = replicatePackageList(readFixture("xbps-query-Rs.txt"), scale);
+
+  QBENCHMARK
+  {
+    QList<PackageListData> *list = Package::parsePackageList(pkgList);
+    delete list;
+  }
+}
+
+void OctoXBPSBench::parsePackageTuple_data()
+{
+  addScaleColumn();
+}
+
+void OctoXBPSBench::parsePackageTuple()
+{
+  QFETCH(int, scale);
+  QStringList packageTuples =
+      replicatePackageList(readFixture("xbps-query-Rs.txt"), scale).split("\n", QString::SkipEmptyParts);
+  QStringList packageCache;
+
+  QBENCHMARK
+  {
+    QList<PackageListData> *list = Package::parsePackageTuple(packageTuples, packageCache);
+    delete list;
+  }
+}
+
+void OctoXBPSBench::addDirectoriesToFileList_data()
+{
+  QTest::addColumn<int>("scale");
+
+  QTest::newRow("x1") << 1;
+  QTest::newRow("x5") << 5;
+}
+
+void OctoXBPSBench::addDirectoriesToFileList()
+{
+  QFETCH(int, scale);
+  QStringList fileList =
+      replicateFileList(readFixture("xbps-query-f.txt").split("\n", QString::SkipEmptyParts), scale);
+
+  QBENCHMARK
+  {
+    QStringList res = Package::addDirectoriesToFileList(fileList);
+    Q_UNUSED(res)
+  }
+}
+
+void OctoXBPSBench::rpmvercmp()
+{
+  QList<PackageListData> *list = Package::parsePackageList(readFixture("xbps-query-Rs.txt"));
+  QList<QByteArray> versions;
+
+  foreach(PackageListData pld, *list)
+  {
+    versions.append(pld.version.toLatin1());
+  }
+  delete list;
+
+  QVERIFY(versions.count() > 1);
+
+  QBENCHMARK
+  {
+    for (int c=1; c<versions.count(); c++)
+    {
+      Package::rpmvercmp(versions.at(c-1).constData(), versions.at(c).constData());
+    }
+  }
+}
+
+void OctoXBPSBench::repositorySetData_data()
+{
+  QTest::addColumn<int>("scale");
+  QTest::addColumn<int>("changes");
+
+  QTest::newRow("x1 full") << 1 << -1;
+  QTest::newRow("x25 full") << 25 << -1;
+  QTest::newRow("x25 unchanged") << 25 << 0;
+  QTest::newRow("x25 10 changes") << 25 << 10;
+}
+
+/*
+ * Each iteration swaps between two lists: "changes" packages are updated, removed and
+ * added between them (-1 changes every package, so the repository is reset)
+ */
+void OctoXBPSBench::repositorySetData()
+{
+  QFETCH(int, scale);
+  QFETCH(int, changes);
+  QList<PackageListData> *list =
+      Package::parsePackageList(replicatePackageList(readFixture("xbps-query-Rs.txt"), scale));
+  QList<PackageListData> *otherList = new QList<PackageListData>(*list);
+  QSet<QString> unrequiredPackages;
+
+  for (int c=0; c<list->count(); c+=3)
+  {
+    unrequiredPackages.insert(list->at(c).name);
+  }
+
+  int count = (changes == -1 ? otherList->count() : qMin(changes, otherList->count() / 3));
+  for (int c=0; c<count; c++)
+  {
+    (*otherList)[c].version += "_1";
+  }
+  for (int c=0; c<count && changes != -1; c++)
+  {
+    PackageListData pld = otherList->takeLast();
+    pld.name += "-bench";
+    otherList->prepend(pld);
+  }
+
+  PackageRepository repo;
+  PackageModel model(repo);
+  repo.registerDependency(model);
+  repo.setData(list, unrequiredPackages);
+
+  QBENCHMARK
+  {
+    repo.setData(otherList, unrequiredPackages);
+    repo.setData(list, unrequiredPackages);
+  }
+
+  delete otherList;
+  delete list;
+}
+
+void OctoXBPSBench::modelApplyFilter_data()
+{
+  QTest::addColumn<int>("scale");
+  QTest::addColumn<QString>("filterExp");
+
+  QTest::newRow("x1 name") << 1 << "lib";
+  QTest::newRow("x25 name") << 25 << "lib";
+  QTest::newRow("x25 regexp") << 25 << "^qt5.*devel";
+  QTest::newRow("x25 none") << 25 << "";
+}
+
+void OctoXBPSBench::modelApplyFilter()
+{
+  QFETCH(int, scale);
+  QFETCH(QString, filterExp);
+  QList<PackageListData> *list =
+      Package::parsePackageList(replicatePackageList(readFixture("xbps-query-Rs.txt"), scale));
+
+  PackageRepository repo;
+  PackageModel model(repo);
+  repo.registerDependency(model);
+  repo.setData(list, QSet<QString>());
+  delete list;
+
+  QBENCHMARK
+  {
+    model.applyFilter(filterExp);
+  }
+}
+
+void OctoXBPSBench::modelSort_data()
+{
+  QTest::addColumn<int>("column");
+
+  QTest::newRow("name") << PackageModel::ctn_PACKAGE_NAME_COLUMN;
+  QTest::newRow("version") << PackageModel::ctn_PACKAGE_VERSION_COLUMN;
+  QTest::newRow("icon") << PackageModel::ctn_PACKAGE_ICON_COLUMN;
+}
+
+/*
+ * PackageModel::sort() does nothing when column and order don't change,
+ * so each iteration sorts the column in both orders
+ */
+void OctoXBPSBench::modelSort()
+{
+  QFETCH(int, column);
+  QList<PackageListData> *list =
+      Package::parsePackageList(replicatePackageList(readFixture("xbps-query-Rs.txt"), 25));
+
+  PackageRepository repo;
+  PackageModel model(repo);
+  repo.registerDependency(model);
+  repo.setData(list, QSet<QString>());
+  delete list;
+
+  QBENCHMARK
+  {
+    model.sort(column, Qt::DescendingOrder);
+    model.sort(column, Qt::AscendingOrder);
+  }
+}
+
+void OctoXBPSBench::splitOutputStrings()
+{
+  QString output = readFixture("xbps-install.txt");
+  XBPSExec xbpsExec;
+
+  QBENCHMARK
+  {
+    xbpsExec.splitOutputStrings(output);
+  }
+}
+
+QTEST_MAIN(OctoXBPSBench)
+
+#include "octoxbpsbench.moc"
@@ -0,0 +1,142 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+/*
+ * Loads the package list the same way OctoXBPS does at startup, shows it in a treeview and
+ * then times a few filters, sorts and a file list. Every measure goes to stdout as
+ * "<metric> <value> <unit>", which is what benchmark/synthetic/run-scaling.sh collects.
+ * It's meant to run against the fake xbps tools written by gen-synthetic-repo.sh.
+ */
+
+#include "src/package.h"
+#include "src/packagerepository.h"
+#include "src/model/packagemodel.h"
+
+#include <iostream>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTreeView>
+
+/*
+ * Returns the given field ("VmRSS", "VmHWM"...) of "/proc/self/status" in KB
+ */
+static qlonglong getMemoryUsage(const QString &field)
+{
+  QFile status("/proc/self/status");
+  if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) return -1;
+
+  QStringList lines = QString::fromLatin1(status.readAll()).split("\n", QString::SkipEmptyParts);
+
+  foreach(QString line, lines)
+  {
+    if (line.startsWith(field + ":"))
+    {
+      QStringList parts = line.mid(field.length()+1).split(" ", QString::SkipEmptyParts);
+      if (parts.count() > 0) return parts.at(0).toLongLong();
+    }
+  }
+
+  return -1;
+}
+
+static void report(const QString &metric, qlonglong value, const QString &unit)
+{
+  std::cout << metric.toLatin1().data() << " " << value << " " << unit.toLatin1().data() << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  QApplication app(argc, argv);
+  QElapsedTimer timer;
+  QString bigPackage = "synth-lib1";
+
+  if (app.arguments().count() > 1) bigPackage = app.arguments().at(1);
+
+  //Startup: the three lists OctoXBPS asks xbps for, then the treeview showing them
+  timer.start();
+  QMap<QString, OutdatedPackageInfo> *outdatedList = Package::getOutdatedStringList();
+  report("outdated_list", timer.elapsed(), "ms");
+
+  QSet<QString> *unrequiredList = Package::getUnrequiredPackageList();
+  report("unrequired_list", timer.elapsed(), "ms");
+
+  QList<PackageListData> *list = Package::getPackageList();
+  report("package_list", timer.elapsed(), "ms");
+
+  PackageRepository repo;
+  PackageModel model(repo);
+  repo.registerDependency(model);
+  repo.setData(list, *unrequiredList);
+  report("repository_set_data", timer.elapsed(), "ms");
+
+  QTreeView view;
+  view.setModel(&model);
+  view.resize(800, 600);
+  view.show();
+  app.processEvents();
+  report("startup_to_usable", timer.elapsed(), "ms");
+
+  report("packages", model.getPackageCount(), "count");
+  report("outdated_packages", outdatedList->count(), "count");
+  report("memory_after_load", getMemoryUsage("VmRSS"), "KB");
+
+  //Filters typed in the search line edit
+  QStringList filters;
+  filters << "synth-lib1" << "synth-lib12345" << "scaling" << "^synth-lib9.*7$" << "";
+
+  foreach(QString filter, filters)
+  {
+    timer.restart();
+    model.applyFilter(filter);
+    app.processEvents();
+    report("filter[" + filter + "]", timer.elapsed(), "ms");
+  }
+
+  //Clicks on the treeview header
+  timer.restart();
+  model.sort(PackageModel::ctn_PACKAGE_NAME_COLUMN, Qt::DescendingOrder);
+  app.processEvents();
+  report("sort[name,desc]", timer.elapsed(), "ms");
+
+  timer.restart();
+  model.sort(PackageModel::ctn_PACKAGE_VERSION_COLUMN, Qt::AscendingOrder);
+  app.processEvents();
+  report("sort[version,asc]", timer.elapsed(), "ms");
+
+  timer.restart();
+  model.sort(PackageModel::ctn_PACKAGE_NAME_COLUMN, Qt::AscendingOrder);
+  app.processEvents();
+  report("sort[name,asc]", timer.elapsed(), "ms");
+
+  //The "Files" tab of the biggest package
+  timer.restart();
+  QStringList contents = Package::getContents(bigPackage, true);
+  report("contents[" + bigPackage + "]", timer.elapsed(), "ms");
+  report("contents_entries", contents.count(), "count");
+
+  report("memory_peak", getMemoryUsage("VmHWM"), "KB");
+
+  delete list;
+  delete unrequiredList;
+  delete outdatedList;
+
+  return 0;
+}
@@ -0,0 +1,47 @@
+#!/bin/sh
+# Writes a synthetic XBPS "repository": fake xbps-query, xbps-install and xbps-remove
+# executables answering for N packages. Put "<outdir>/bin" first in PATH to use them.
+#
+# Usage: gen-synthetic-repo.sh -n <packages> [-f <files per package>] [-b <files of the big package>] -o <outdir>
+
+PACKAGES=1000
+FILES=20
+BIG_FILES=200000
+OUTDIR=""
+
+while getopts "n:f:b:o:" opt
+do
+  case "$opt" in
+    n) PACKAGES="$OPTARG" ;;
+    f) FILES="$OPTARG" ;;
+    b) BIG_FILES="$OPTARG" ;;
+    o) OUTDIR="$OPTARG" ;;
+    *) echo "Usage: $0 -n <packages> [-f <files per package>] [-b <files of the big package>] -o <outdir>"; exit 1 ;;
+  esac
+done
+
+if [ -z "$OUTDIR" ]
+then
+  echo "Usage: $0 -n <packages> [-f <files per package>] [-b <files of the big package>] -o <outdir>"
+  exit 1
+fi
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+
+mkdir -p "$OUTDIR/bin" || exit 1
+
+cat > "$OUTDIR/synthetic.conf" << CONF
+SYNTH_PACKAGES=$PACKAGES
+SYNTH_FILES=$FILES
+SYNTH_BIG_FILES=$BIG_FILES
+CONF
+
+cp "$HERE/xbps-synthetic.sh" "$OUTDIR/bin/xbps-synthetic"
+chmod +x "$OUTDIR/bin/xbps-synthetic"
+
+for tool in xbps-query xbps-install xbps-remove
+do
+  ln -sf xbps-synthetic "$OUTDIR/bin/$tool"
+done
+
+echo "Synthetic repository with $PACKAGES packages written to $OUTDIR"
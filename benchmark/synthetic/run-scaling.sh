@@ -0,0 +1,77 @@
+#!/bin/sh
+# Runs octoxbps-scale against synthetic repositories of growing size and writes a report
+# with one row per metric and one column per scale.
+#
+# Usage: run-scaling.sh [-s "<scales>"] [-f <files per package>] [-b <files of the big package>] [-r <report>]
+# Build benchmark/octoxbps-scale first.
+
+SCALES="1000 10000 50000 100000"
+FILES=20
+BIG_FILES=200000
+REPORT="scaling-report.txt"
+
+while getopts "s:f:b:r:" opt
+do
+  case "$opt" in
+    s) SCALES="$OPTARG" ;;
+    f) FILES="$OPTARG" ;;
+    b) BIG_FILES="$OPTARG" ;;
+    r) REPORT="$OPTARG" ;;
+    *) echo "Usage: $0 [-s \"<scales>\"] [-f <files per package>] [-b <files of the big package>] [-r <report>]"; exit 1 ;;
+  esac
+done
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+DRIVER="$HERE/../bin/octoxbps-scale"
+WORKDIR=$(mktemp -d /tmp/octoxbps-scaling.XXXXXX)
+
+if [ ! -x "$DRIVER" ]
+then
+  echo "$DRIVER not found: build benchmark/octoxbps-scale first"
+  exit 1
+fi
+
+for scale in $SCALES
+do
+  "$HERE/gen-synthetic-repo.sh" -n "$scale" -f "$FILES" -b "$BIG_FILES" -o "$WORKDIR/repo-$scale" > /dev/null || exit 1
+
+  echo "Running with $scale packages..."
+  PATH="$WORKDIR/repo-$scale/bin:$PATH" QT_QPA_PLATFORM=offscreen "$DRIVER" > "$WORKDIR/result-$scale.txt"
+done
+
+(
+  echo "OctoXBPS scaling report - $(date)"
+  echo "Files per package: $FILES, files of the big package: $BIG_FILES"
+  echo
+
+  cd "$WORKDIR"
+  awk -v scales="$SCALES" '
+    BEGIN {
+      n = split(scales, scale, " ")
+      for (k = 1; k <= n; k++)
+      {
+        file = "result-" scale[k] ".txt"
+        while ((getline line < file) > 0)
+        {
+          split(line, f, " ")
+          if (!(f[1] in seen)) { seen[f[1]] = 1; order[++metrics] = f[1]; unit[f[1]] = f[3] }
+          value[f[1], k] = f[2]
+        }
+        close(file)
+      }
+
+      printf "%-28s %-6s", "metric", "unit"
+      for (k = 1; k <= n; k++) printf " %12s", scale[k]
+      printf "\n"
+
+      for (m = 1; m <= metrics; m++)
+      {
+        printf "%-28s %-6s", order[m], unit[order[m]]
+        for (k = 1; k <= n; k++) printf " %12s", ((order[m], k) in value) ? value[order[m], k] : "-"
+        printf "\n"
+      }
+    }'
+) > "$REPORT.tmp" && mv "$REPORT.tmp" "$REPORT"
+
+rm -rf "$WORKDIR"
+cat "$REPORT"
@@ -0,0 +1,144 @@
+#!/bin/sh
+# Stand-in for xbps-query, xbps-install and xbps-remove used by the scaling harness.
+# It's installed (by gen-synthetic-repo.sh) as those three names and emits consistent
+# listings, info, dependency, file list and transaction output for SYNTH_PACKAGES
+# synthetic packages. Everything is derived from the package number, so nothing is stored.
+#
+# Package "synth-lib<i>" (1 <= i <= SYNTH_PACKAGES):
+#   version      1.<i%10>.<i%7>_1 (an update "_2" is available when i%120 == 0)
+#   installed    when i%3 == 0
+#   orphan       when installed and i%9 == 0
+#   depends on   synth-lib<i/2> and synth-lib<i/3> (when > 0)
+#   files        SYNTH_FILES files, or SYNTH_BIG_FILES for synth-lib1
+
+SYNTH_DIR=$(cd "$(dirname "$0")/.." && pwd)
+. "$SYNTH_DIR/synthetic.conf"
+
+TOOL=$(basename "$0")
+FIELD=""
+REMOTE=0
+MODE=""
+TARGETS=""
+
+while [ $# -gt 0 ]
+do
+  case "$1" in
+    -p) FIELD="$2"; [ -z "$MODE" ] && MODE="field"; shift ;;
+    -R) REMOTE=1 ;;
+    -Rs|-s) REMOTE=1; [ -z "$MODE" ] && MODE="search" ;;
+    -Rx|-x) MODE="deps" ;;
+    -f) [ "$TOOL" = "xbps-query" ] && MODE="files" ;;
+    -o) MODE="owner" ;;
+    -m) MODE="orphans" ;;
+    -l) MODE="list" ;;
+    -V) MODE="version" ;;
+    -un|-nu) MODE="outdated" ;;
+    -n) MODE="dryrun" ;;
+    -R*|-S*|-y|-u|-O) [ "$1" = "-u" ] && MODE="upgrade" ;;
+    -*) ;;
+    *) TARGETS="$TARGETS $1" ;;
+  esac
+  shift
+done
+
+#The awk program shared by every query: it knows how to describe package number i
+synth() {
+  awk -v n="$SYNTH_PACKAGES" -v files="$SYNTH_FILES" -v bigfiles="$SYNTH_BIG_FILES" \
+      -v mode="$1" -v field="$FIELD" -v targets="$TARGETS" -v tool="$TOOL" '
+    function ver(i)      { return "1." (i % 10) "." (i % 7) "_1" }
+    function newver(i)   { return "1." (i % 10) "." (i % 7) "_2" }
+    function name(i)     { return "synth-lib" i }
+    function pkgver(i)   { return name(i) "-" ver(i) }
+    function inst(i)     { return i % 3 == 0 }
+    function outdated(i) { return i % 120 == 0 }
+    function isize(i)    { return 1024 * (16 + i % 512) }
+    function dsize(i)    { return 512 * (16 + i % 512) }
+    function desc(i)     { return "Synthetic package " i " for scaling tests" }
+    function num(s)      { sub(/^synth-lib/, "", s); sub(/-[^-]*$/, "", s); sub(/[<>=].*$/, "", s); return s + 0 }
+    function nfiles(i)   { return i == 1 ? bigfiles : files }
+    function path(i, f)  { return "/usr/share/synth-lib" i "/d" int(f / 100) "/file" f }
+    function deps(i)     { if (int(i / 2) > 0) print name(int(i / 2)) ">=0"
+                           if (int(i / 3) > 0) print name(int(i / 3)) ">=0" }
+    function txrow(i, op) { print (op == "remove" ? pkgver(i) : (outdated(i) ? name(i) "-" newver(i) : pkgver(i))) \
+                                  " " op " x86_64 https://synthetic/current " isize(i) " " dsize(i) }
+    BEGIN {
+      t = split(targets, tgt, " ")
+      if (mode == "search") {
+        pat = (t == 0 || tgt[1] == "-") ? "" : tgt[1]
+        for (i = 1; i <= n; i++)
+          if (pat == "" || index(name(i) " " desc(i), pat) > 0)
+            print (inst(i) ? "[*] " : "[-] ") pkgver(i) " " desc(i)
+      }
+      else if (mode == "list") {
+        for (i = 3; i <= n; i += 3) print "ii " pkgver(i) " " desc(i)
+      }
+      else if (mode == "orphans") {
+        for (i = 9; i <= n; i += 9) print pkgver(i)
+      }
+      else if (mode == "outdated") {
+        for (i = 120; i <= n; i += 120) txrow(i, "update")
+      }
+      else if (mode == "upgrade") {
+        for (i = 120; i <= n; i += 120) print name(i) "-" newver(i) ": updated successfully."
+      }
+      else if (mode == "version") {
+        print "XBPS: 0.59 (synthetic)"
+      }
+      else {
+        for (k = 1; k <= t; k++) {
+          if (tgt[k] ~ /^\//) { i = 0; s = tgt[k]; sub(/^\/usr\/share\/synth-lib/, "", s)
+                                if (s != tgt[k]) i = s + 0 }
+          else i = num(tgt[k])
+          if (i < 1 || i > n) continue
+
+          if (mode == "deps") deps(i)
+          else if (mode == "files") { for (f = 0; f < nfiles(i); f++) print path(i, f) }
+          else if (mode == "owner") print pkgver(i) ": " tgt[k] " (regular file)"
+          else if (mode == "field") {
+            if (field == "pkgver") print pkgver(i)
+            else if (field == "version") print ver(i)
+            else if (field == "short_desc") print desc(i)
+            else if (field == "installed_size") print isize(i) "B"
+            else if (field == "filename-size") print dsize(i)
+            else if (field == "homepage") print "https://synthetic/" name(i)
+            else if (field == "maintainer") print "Synthetic <synth@localhost>"
+          }
+          else if (mode == "dryrun") {
+            if (tool == "xbps-remove") txrow(i, "remove")
+            else { if (int(i / 3) > 0 && !inst(int(i / 3))) txrow(int(i / 3), "install")
+                   txrow(i, inst(i) ? "update" : "install") }
+          }
+          else if (tool == "xbps-query") {
+            print "architecture: x86_64"
+            print "filename-size: " dsize(i)
+            print "homepage: https://synthetic/" name(i)
+            print "installed_size: " isize(i) "B"
+            print "license: BSD-2-Clause"
+            print "maintainer: Synthetic <synth@localhost>"
+            print "pkgver: " pkgver(i)
+            print "repository: https://synthetic/current"
+            print "run_depends:"
+            if (int(i / 2) > 0) print "\t" name(int(i / 2)) ">=0"
+            if (int(i / 3) > 0) print "\t" name(int(i / 3)) ">=0"
+            print "short_desc: " desc(i)
+          }
+          else {
+            op = (tool == "xbps-remove") ? "removed" : "installed"
+            print pkgver(i) ": " (op == "removed" ? "removing" : "unpacking") " ..."
+            print pkgver(i) ": " op " successfully."
+          }
+        }
+      }
+    }'
+}
+
+if [ -z "$MODE" ]
+then
+  case "$TOOL" in
+    xbps-query) MODE="info" ;;
+    *) MODE="transaction" ;;
+  esac
+fi
+
+synth "$MODE"
+exit 0
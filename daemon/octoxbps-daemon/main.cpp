@@ -0,0 +1,67 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "../../src/argumentlist.h"
+#include "../../src/daemonclient.h"
+#include "../../src/strconstants.h"
+#include "octoxbpsdaemon.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDebug>
+
+int main(int argc, char *argv[])
+{
+  bool debugInfo = false;
+
+  ArgumentList *argList = new ArgumentList(argc, argv);
+  if (argList->getSwitch("-d"))
+  {
+    //If user chooses to switch debug info on...
+    debugInfo = true;
+  }
+
+  if (debugInfo)
+    qDebug() << QString("OctoXBPS Daemon - " + StrConstants::getApplicationVersion() +
+                  " (" + StrConstants::getQtVersion() + ")");
+
+  QCoreApplication a(argc, argv);
+  QDBusConnection bus = QDBusConnection::sessionBus();
+
+  if (!bus.isConnected())
+  {
+    qDebug() << "Aborting daemon as the DBus session bus is not available!";
+    return (-1);
+  }
+
+  OctoXBPSDaemon daemon;
+  if (debugInfo) daemon.turnDebugInfoOn();
+
+  bus.registerObject(ctn_OCTOXBPS_DAEMON_PATH, &daemon,
+                     QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals);
+
+  if (!bus.registerService(ctn_OCTOXBPS_DAEMON_SERVICE))
+  {
+    qDebug() << "Aborting daemon as another instance is already running!";
+    return (-2);
+  }
+
+  return a.exec();
+}
@@ -0,0 +1,57 @@
+#-------------------------------------------------
+#
+# Session bus service answering OctoXBPS package queries
+# Install org.octoxbps.daemon.service in /usr/share/dbus-1/services for D-Bus activation
+#
+#-------------------------------------------------
+
+QT += core dbus concurrent network
+QT -= gui
+
+CONFIG += qt console warn_on release
+QMAKE_CXXFLAGS += -std=c++11
+TARGET = octoxbps-daemon
+TEMPLATE = app
+DESTDIR += ../bin
+OBJECTS_DIR += ../build-octoxbps-daemon
+MOC_DIR += ../build-octoxbps-daemon
+UI_DIR += ../build-octoxbps-daemon
+
+#Only the query side of UnixCommand (unixcommand_query.cpp) is linked: the service has no GUI
+SOURCES += main.cpp \
+    octoxbpsdaemon.cpp \
+    ../../src/daemonclient.cpp \
+    ../../src/packagestatecache.cpp \
+    ../../src/QtSolutions/qtlocalpeer.cpp \
+    ../../src/unixcommand_query.cpp \
+    ../../src/queryrecorder.cpp \
+    ../../src/tracer.cpp \
+    ../../src/processaccounting.cpp \
+    ../../src/package.cpp \
+    ../../src/xbpsplist.cpp \
+    ../../src/dependencygraph.cpp \
+    ../../src/fileownerindex.cpp \
+    ../../src/searchindex.cpp \
+    ../../src/packagecacheindex.cpp \
+    ../../src/pathresolver.cpp \
+    ../../src/systemcapabilities.cpp \
+    ../../src/argumentlist.cpp
+
+HEADERS  += octoxbpsdaemon.h \
+    ../../src/daemonclient.h \
+    ../../src/packagestatecache.h \
+    ../../src/QtSolutions/qtlockedfile.h \
+    ../../src/QtSolutions/qtlocalpeer.h \
+    ../../src/queryrecorder.h \
+    ../../src/tracer.h \
+    ../../src/processaccounting.h \
+    ../../src/pathresolver.h \
+    ../../src/systemcapabilities.h \
+    ../../src/strconstants.h \
+    ../../src/package.h \
+    ../../src/xbpsplist.h \
+    ../../src/dependencygraph.h \
+    ../../src/fileownerindex.h \
+    ../../src/searchindex.h \
+    ../../src/packagecacheindex.h \
+    ../../src/argumentlist.h
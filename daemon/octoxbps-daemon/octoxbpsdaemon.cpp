@@ -0,0 +1,308 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "octoxbpsdaemon.h"
+#include "../../src/constants.h"
+#include "../../src/daemonclient.h"
+#include "../../src/dependencygraph.h"
+#include "../../src/fileownerindex.h"
+#include "../../src/packagestatecache.h"
+#include "../../src/tracer.h"
+
+#include <QDBusConnection>
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QFuture>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <iostream>
+
+OctoXBPSDaemon::OctoXBPSDaemon(QObject *parent): QObject(parent)
+{
+  m_debugInfo = false;
+  m_packages = NULL;
+  m_outdatedPackages = NULL;
+  m_unrequiredPackages = NULL;
+
+  m_stateWatcher = new QFutureWatcher<DaemonState>(this);
+  connect(m_stateWatcher, SIGNAL(finished()), this, SLOT(onStateLoaded()));
+
+  m_refreshTimer = new QTimer(this);
+  m_refreshTimer->setSingleShot(true);
+  m_refreshTimer->setInterval(ctn_PACKAGE_DATABASE_WATCHER_DELAY);
+  connect(m_refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+
+  m_pkgdbWatcher = new QFileSystemWatcher(this);
+  connect(m_pkgdbWatcher, SIGNAL(directoryChanged(QString)), this, SLOT(onPackageDatabaseChanged()));
+  watchDatabase();
+
+  //Warms everything up as soon as the event loop runs
+  QTimer::singleShot(0, this, SLOT(refresh()));
+}
+
+OctoXBPSDaemon::~OctoXBPSDaemon()
+{
+  clear();
+}
+
+void OctoXBPSDaemon::turnDebugInfoOn()
+{
+  m_debugInfo = true;
+}
+
+void OctoXBPSDaemon::clear()
+{
+  delete m_packages;
+  delete m_outdatedPackages;
+  delete m_unrequiredPackages;
+
+  m_packages = NULL;
+  m_outdatedPackages = NULL;
+  m_unrequiredPackages = NULL;
+  m_packageListSnapshot.clear();
+  m_stamp.clear();
+}
+
+/*
+ * Watches the XBPS database dir (pkgdb) and every repository dir inside it (repodata, after a sync)
+ */
+void OctoXBPSDaemon::watchDatabase()
+{
+  QStringList paths;
+  paths << ctn_XBPS_DATABASE_DIR;
+
+  foreach(QString repodata, DependencyGraph::getRepodataFiles())
+  {
+    QString dir = QFileInfo(repodata).absolutePath();
+    if (!paths.contains(dir)) paths.append(dir);
+  }
+
+  QStringList watched = m_pkgdbWatcher->directories();
+  foreach(QString path, paths)
+  {
+    if (!watched.contains(path) && QDir(path).exists())
+      m_pkgdbWatcher->addPath(path);
+  }
+}
+
+/*
+ * XBPS touches the database many times during a transaction, so we wait for it to settle
+ */
+void OctoXBPSDaemon::onPackageDatabaseChanged()
+{
+  m_refreshTimer->start();
+}
+
+/*
+ * Rebuilds the lists if the XBPS database has changed
+ */
+void OctoXBPSDaemon::refresh()
+{
+  //A sync may have brought new repositories
+  watchDatabase();
+
+  if (!isUpToDate()) startRefresh();
+}
+
+/*
+ * Runs in a worker thread: reads the lists and warms the dependency graph and the file index
+ */
+DaemonState OctoXBPSDaemon::loadState()
+{
+  TraceSpan span("OctoXBPSDaemon::loadState");
+  DaemonState res;
+  res.stamp = PackageStateCache::getStamp();
+
+  QFuture<QMap<QString, OutdatedPackageInfo> *> outdated = QtConcurrent::run(PackageStateCache::getOutdatedPackages);
+  res.packages = PackageStateCache::getPackageList();
+  res.unrequiredPackages = Package::getUnrequiredPackageList();
+  FileOwnerIndex::instance()->isAvailable();
+  res.outdatedPackages = outdated.result();
+
+  res.packageListSnapshot = DaemonClient::encodePackageListSnapshot(*res.packages, *res.outdatedPackages, *res.unrequiredPackages);
+
+  return res;
+}
+
+/*
+ * True if the lists were built from the pkgdb and repodata we have now. Checking the stamp on
+ * every call keeps answers right even if the watcher missed an event
+ */
+bool OctoXBPSDaemon::isUpToDate()
+{
+  return (m_packages != NULL && PackageStateCache::getStamp() == m_stamp);
+}
+
+/*
+ * Starts rebuilding the lists, unless that's already being done
+ */
+void OctoXBPSDaemon::startRefresh()
+{
+  if (m_stateWatcher->isRunning()) return;
+
+  QFuture<DaemonState> f = QtConcurrent::run(loadState);
+  m_stateWatcher->setFuture(f);
+}
+
+/*
+ * When the lists are out of date, the current call is answered later (see onStateLoaded())
+ */
+bool OctoXBPSDaemon::delayReplyUntilUpToDate()
+{
+  if (isUpToDate()) return false;
+
+  setDelayedReply(true);
+  m_pendingReplies.append(message());
+  startRefresh();
+
+  return true;
+}
+
+/*
+ * Takes the lists the worker thread has built, answers the delayed calls and tells every client
+ * the XBPS database has changed
+ */
+void OctoXBPSDaemon::onStateLoaded()
+{
+  DaemonState state = m_stateWatcher->result();
+  QString oldStamp = m_stamp;
+
+  clear();
+  m_stamp = state.stamp;
+  m_packages = state.packages;
+  m_outdatedPackages = state.outdatedPackages;
+  m_unrequiredPackages = state.unrequiredPackages;
+  m_packageListSnapshot = state.packageListSnapshot;
+
+  if (m_debugInfo)
+    std::cout << "octoxbps-daemon: " << m_packages->count() << " packages, " << m_outdatedPackages->count()
+              << " outdated, " << m_unrequiredPackages->count() << " unrequired" << std::endl;
+
+  QList<QDBusMessage> pendingReplies = m_pendingReplies;
+  m_pendingReplies.clear();
+
+  foreach(QDBusMessage message, pendingReplies)
+  {
+    QDBusConnection::sessionBus().send(message.createReply(getAnswer(message)));
+  }
+
+  if (!oldStamp.isEmpty() && oldStamp != m_stamp)
+  {
+    if (m_debugInfo)
+      std::cout << "octoxbps-daemon: XBPS database has changed" << std::endl;
+
+    emit packageDatabaseChanged();
+  }
+
+  //XBPS may have changed the database again while we were reading it
+  if (!isUpToDate()) m_refreshTimer->start();
+}
+
+/*
+ * Answer to a delayed call, given its method name and arguments
+ */
+QVariant OctoXBPSDaemon::getAnswer(const QDBusMessage &message)
+{
+  QString method = message.member();
+  QString arg = (message.arguments().isEmpty() ? QString() : message.arguments().first().toString());
+
+  if (method == "getPackageListSnapshot")
+    return m_packageListSnapshot;
+  else if (method == "getOutdatedPackages")
+    return getOutdatedPackageLines();
+  else if (method == "getUnrequiredPackages")
+    return getUnrequiredPackageNames();
+  else if (method == "getDependsOn")
+    return DependencyGraph::instance()->getDependsOn(arg);
+  else if (method == "getRequiredBy")
+    return DependencyGraph::instance()->getRequiredBy(arg);
+  else if (method == "getOwner")
+    return FileOwnerIndex::instance()->getOwner(arg);
+
+  return QVariant();
+}
+
+QStringList OctoXBPSDaemon::getOutdatedPackageLines()
+{
+  QStringList res;
+
+  for (QMap<QString, OutdatedPackageInfo>::const_iterator it = m_outdatedPackages->constBegin();
+       it != m_outdatedPackages->constEnd(); ++it)
+  {
+    res.append(it.key() + " " + it.value().oldVersion + " " + it.value().newVersion);
+  }
+
+  return res;
+}
+
+QStringList OctoXBPSDaemon::getUnrequiredPackageNames()
+{
+  QStringList res = m_unrequiredPackages->toList();
+  res.sort();
+
+  return res;
+}
+
+/*
+ * Everything OctoXBPS needs to show its package list, in a single round trip
+ */
+QByteArray OctoXBPSDaemon::getPackageListSnapshot()
+{
+  if (delayReplyUntilUpToDate()) return QByteArray();
+  return m_packageListSnapshot;
+}
+
+/*
+ * Outdated packages as "name oldVersion newVersion" lines
+ */
+QStringList OctoXBPSDaemon::getOutdatedPackages()
+{
+  if (delayReplyUntilUpToDate()) return QStringList();
+  return getOutdatedPackageLines();
+}
+
+QStringList OctoXBPSDaemon::getUnrequiredPackages()
+{
+  if (delayReplyUntilUpToDate()) return QStringList();
+  return getUnrequiredPackageNames();
+}
+
+QStringList OctoXBPSDaemon::getDependsOn(const QString &pkgName)
+{
+  if (delayReplyUntilUpToDate()) return QStringList();
+  return DependencyGraph::instance()->getDependsOn(pkgName);
+}
+
+QStringList OctoXBPSDaemon::getRequiredBy(const QString &pkgName)
+{
+  if (delayReplyUntilUpToDate()) return QStringList();
+  return DependencyGraph::instance()->getRequiredBy(pkgName);
+}
+
+/*
+ * Name of the installed package which owns the given file, or an empty string
+ */
+QString OctoXBPSDaemon::getOwner(const QString &filePath)
+{
+  if (delayReplyUntilUpToDate()) return QString();
+  return FileOwnerIndex::instance()->getOwner(filePath);
+}
@@ -0,0 +1,121 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef OCTOXBPSDAEMON_H
+#define OCTOXBPSDAEMON_H
+
+#include "../../src/package.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QDBusContext>
+#include <QDBusMessage>
+#include <QFutureWatcher>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+class QFileSystemWatcher;
+class QTimer;
+
+/*
+ * Everything the daemon keeps in memory, as loaded by a worker thread
+ */
+struct DaemonState
+{
+  QString stamp;
+  QList<PackageListData> *packages;
+  QMap<QString, OutdatedPackageInfo> *outdatedPackages;
+  QSet<QString> *unrequiredPackages;
+  QByteArray packageListSnapshot;
+
+  DaemonState(): packages(NULL), outdatedPackages(NULL), unrequiredPackages(NULL){}
+};
+
+/*
+ * Resident service which keeps the package list, the outdated and unrequired packages, the
+ * dependency graph and the file ownership index warm, so OctoXBPS, its notifier and scripts get
+ * their answers from memory instead of spawning xbps-query or parsing pkgdb themselves.
+ *
+ * It's exported on the session bus as "org.octoxbps.daemon" and it is the only one watching the
+ * XBPS database: whenever pkgdb or a repodata changes, the lists are rebuilt and
+ * packageDatabaseChanged() is emitted.
+ *
+ * The lists are (re)built in a worker thread, so the bus is never blocked: calls which arrive
+ * while they are out of date get a delayed reply, sent as soon as the new lists are ready.
+ */
+
+class OctoXBPSDaemon : public QObject, protected QDBusContext
+{
+  Q_OBJECT
+  Q_CLASSINFO("D-Bus Interface", "org.octoxbps.daemon")
+
+private:
+  QFileSystemWatcher *m_pkgdbWatcher;
+  QTimer *m_refreshTimer;
+  bool m_debugInfo;
+
+  QString m_stamp;
+  QList<PackageListData> *m_packages;
+  QMap<QString, OutdatedPackageInfo> *m_outdatedPackages;
+  QSet<QString> *m_unrequiredPackages;
+  QByteArray m_packageListSnapshot;
+
+  QFutureWatcher<DaemonState> *m_stateWatcher;
+  QList<QDBusMessage> m_pendingReplies;
+
+  static DaemonState loadState();
+
+  void clear();
+  bool isUpToDate();
+  bool delayReplyUntilUpToDate();
+  void startRefresh();
+  void watchDatabase();
+  QVariant getAnswer(const QDBusMessage &message);
+  QStringList getOutdatedPackageLines();
+  QStringList getUnrequiredPackageNames();
+
+public:
+  explicit OctoXBPSDaemon(QObject *parent = 0);
+  virtual ~OctoXBPSDaemon();
+
+  void turnDebugInfoOn();
+
+signals:
+  void packageDatabaseChanged();
+
+public slots:
+  QByteArray getPackageListSnapshot();
+  QStringList getOutdatedPackages();
+  QStringList getUnrequiredPackages();
+  QStringList getDependsOn(const QString &pkgName);
+  QStringList getRequiredBy(const QString &pkgName);
+  QString getOwner(const QString &filePath);
+
+private slots:
+  void onPackageDatabaseChanged();
+  void onStateLoaded();
+  void refresh();
+};
+
+#endif // OCTOXBPSDAEMON_H
@@ -0,0 +1,69 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "privilegedhelper.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFileInfo>
+
+#include <unistd.h>
+
+/*
+ * Started by OctoXBPS through the SU front-end as: octoxbps-helper <socket path> <uid>
+ */
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+
+  if (geteuid() != 0)
+  {
+    qDebug() << "Aborting helper as it's not running as root!";
+    return (-1);
+  }
+
+  bool ok = false;
+  uint uid = (args.count() == 3 ? args.at(2).toUInt(&ok) : 0);
+
+  if (!ok)
+  {
+    qDebug() << "Usage: octoxbps-helper <socket path> <uid>";
+    return (-2);
+  }
+
+  //The socket must be created where only that user can reach it
+  QFileInfo socketDir(QFileInfo(args.at(1)).absolutePath());
+  if (!socketDir.isDir() || socketDir.ownerId() != uid ||
+      (socketDir.permissions() & (QFile::WriteGroup | QFile::WriteOther)))
+  {
+    qDebug() << "Aborting helper as" << socketDir.absoluteFilePath() << "isn't a private dir of user" << uid;
+    return (-3);
+  }
+
+  PrivilegedHelper helper(args.at(1), uid);
+  if (!helper.listen())
+  {
+    qDebug() << "Aborting helper as it could not listen on" << args.at(1);
+    return (-4);
+  }
+
+  return a.exec();
+}
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Privileged helper which runs the XBPS transactions of a session
+#
+#-------------------------------------------------
+
+QT += core network
+QT -= gui
+
+CONFIG += qt console warn_on release
+QMAKE_CXXFLAGS += -std=c++11
+TARGET = octoxbps-helper
+TEMPLATE = app
+DESTDIR += ../bin
+OBJECTS_DIR += ../build-octoxbps-helper
+MOC_DIR += ../build-octoxbps-helper
+
+SOURCES += main.cpp \
+    privilegedhelper.cpp
+
+HEADERS += privilegedhelper.h \
+    ../../src/constants.h
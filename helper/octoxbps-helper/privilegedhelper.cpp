@@ -0,0 +1,353 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "privilegedhelper.h"
+#include "../../src/constants.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QFile>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QProcessEnvironment>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+PrivilegedHelper::PrivilegedHelper(const QString &socketPath, uint uid, QObject *parent):
+  QObject(parent), m_socketPath(socketPath), m_uid(uid)
+{
+  m_runningClient = NULL;
+
+  m_server = new QLocalServer(this);
+  connect(m_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+
+  m_process = new QProcess(this);
+  connect(m_process, SIGNAL(readyReadStandardOutput()), this, SLOT(onReadyReadStandardOutput()));
+  connect(m_process, SIGNAL(readyReadStandardError()), this, SLOT(onReadyReadStandardError()));
+  connect(m_process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(onFinished(int,QProcess::ExitStatus)));
+  connect(m_process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(onError(QProcess::ProcessError)));
+
+  m_idleTimer = new QTimer(this);
+  m_idleTimer->setSingleShot(true);
+  m_idleTimer->setInterval(ctn_OCTOXBPS_HELPER_IDLE_TIMEOUT);
+  connect(m_idleTimer, SIGNAL(timeout()), this, SLOT(onIdleTimeout()));
+}
+
+PrivilegedHelper::~PrivilegedHelper()
+{
+  m_server->close();
+  QFile::remove(m_socketPath);
+}
+
+/*
+ * Creates the socket and hands it to the user who started us. Nobody else can even reach it,
+ * as it lives inside that user's runtime dir
+ */
+bool PrivilegedHelper::listen()
+{
+  QFile::remove(m_socketPath);
+
+  //The socket node is born 0600 and root's, so there's no window in which anyone else can use it
+  mode_t oldMask = ::umask(S_IRWXG | S_IRWXO);
+  bool listening = m_server->listen(m_socketPath);
+  ::umask(oldMask);
+
+  if (!listening) return false;
+
+  if (!handOverSocket())
+  {
+    m_server->close();
+    QFile::remove(m_socketPath);
+    return false;
+  }
+
+  m_idleTimer->start();
+  return true;
+}
+
+/*
+ * Gives the socket just bound to the user. As the runtime dir is the user's, its entry can be
+ * swapped by a link at any moment, so the node is opened without following links, checked to be
+ * the socket we've just created (root's and with a single link) and chowned through that very fd
+ */
+bool PrivilegedHelper::handOverSocket()
+{
+  int fd = ::open(QFile::encodeName(m_socketPath).constData(), O_PATH | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0) return false;
+
+  struct stat st;
+  bool res = (::fstat(fd, &st) == 0 && S_ISSOCK(st.st_mode) && st.st_uid == 0 && st.st_nlink == 1 &&
+              ::fchownat(fd, "", m_uid, (gid_t)-1, AT_EMPTY_PATH) == 0);
+
+  ::close(fd);
+  return res;
+}
+
+/*
+ * Asks the kernel who is on the other side of the socket
+ */
+bool PrivilegedHelper::isPeerAllowed(QLocalSocket *client)
+{
+  struct ucred cred;
+  socklen_t len = sizeof(cred);
+
+  if (getsockopt(client->socketDescriptor(), SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) return false;
+
+  return (cred.uid == m_uid || cred.uid == 0);
+}
+
+/*
+ * Only the exact command lines XBPSExec builds are accepted. Package names are the only free part
+ * of them, so no option (like -R, -C, -r or -c) and no path can sneak in as a target
+ */
+bool PrivilegedHelper::isCommandAllowed(const QStringList &command)
+{
+  static const QStringList exactCommands = QStringList()
+      << "xbps-remove -O" << "xbps-install -u -y" << "xbps-install -Sy" << "xbps-install -Syy";
+  //Longer prefixes first, as "xbps-install -f" is also a prefix of "xbps-install -f -y"
+  static const QStringList targetCommands = QStringList()
+      << "xbps-remove -R -f -y" << "xbps-install -f -y" << "xbps-install -f";
+  static const QRegularExpression packageName("^[A-Za-z0-9][A-Za-z0-9+_.-]*$");
+
+  if (command.isEmpty()) return false;
+
+  foreach(QString exact, exactCommands)
+  {
+    if (command == exact.split(" ")) return true;
+  }
+
+  foreach(QString prefix, targetCommands)
+  {
+    QStringList args = prefix.split(" ");
+    if (command.count() <= args.count() || command.mid(0, args.count()) != args) continue;
+
+    foreach(QString target, command.mid(args.count()))
+    {
+      if (!packageName.match(target).hasMatch()) return false;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+/*
+ * Every message is a size prefixed (type, code, data) block
+ */
+void PrivilegedHelper::sendMessage(QLocalSocket *client, int type, int code, const QByteArray &data)
+{
+  if (client == NULL) return;
+
+  QByteArray block;
+  QDataStream out(&block, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_5_0);
+  out << quint32(0) << qint32(type) << qint32(code) << data;
+  out.device()->seek(0);
+  out << quint32(block.size() - sizeof(quint32));
+
+  client->write(block);
+  client->flush();
+}
+
+void PrivilegedHelper::onNewConnection()
+{
+  while (m_server->hasPendingConnections())
+  {
+    QLocalSocket *client = m_server->nextPendingConnection();
+
+    if (!isPeerAllowed(client))
+    {
+      client->abort();
+      client->deleteLater();
+      continue;
+    }
+
+    m_blockSizes.insert(client, 0);
+    connect(client, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+    connect(client, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+  }
+}
+
+/*
+ * Queues the (lang, commands) requests sent by a client
+ */
+void PrivilegedHelper::onReadyRead()
+{
+  QLocalSocket *client = qobject_cast<QLocalSocket *>(sender());
+  if (client == NULL) return;
+
+  QDataStream in(client);
+  in.setVersion(QDataStream::Qt_5_0);
+
+  forever
+  {
+    quint32 &blockSize = m_blockSizes[client];
+
+    if (blockSize == 0)
+    {
+      if (client->bytesAvailable() < (int)sizeof(quint32)) return;
+      in >> blockSize;
+    }
+
+    if (client->bytesAvailable() < blockSize) return;
+
+    Request request;
+    request.client = client;
+    in >> request.lang >> request.commands;
+    blockSize = 0;
+
+    bool valid = (in.status() == QDataStream::Ok && !request.commands.isEmpty() &&
+                  request.lang.contains(QRegularExpression("^[A-Za-z0-9_.@-]+$")));
+
+    foreach(QStringList command, request.commands)
+    {
+      if (!isCommandAllowed(command)) valid = false;
+    }
+
+    if (!valid)
+    {
+      sendMessage(client, ectn_HELPER_STANDARD_ERROR, 0, "octoxbps-helper: request refused\n");
+      sendMessage(client, ectn_HELPER_FINISHED, 1, QByteArray::number(int(QProcess::NormalExit)));
+      continue;
+    }
+
+    m_queue.append(request);
+    if (m_queue.count() == 1 && m_process->state() == QProcess::NotRunning)
+      startNextCommand();
+  }
+}
+
+/*
+ * A transaction already started goes on till the end. Only the ones still queued are dropped
+ */
+void PrivilegedHelper::onDisconnected()
+{
+  QLocalSocket *client = qobject_cast<QLocalSocket *>(sender());
+  if (client == NULL) return;
+
+  bool running = (m_process->state() != QProcess::NotRunning);
+
+  for (int i = m_queue.count() - 1; i >= 0; --i)
+  {
+    if (m_queue.at(i).client != client) continue;
+
+    //It finishes without anyone listening
+    if (i == 0 && running)
+      m_queue[0].client = NULL;
+    else
+      m_queue.removeAt(i);
+  }
+
+  if (m_runningClient == client) m_runningClient = NULL;
+
+  m_blockSizes.remove(client);
+  client->deleteLater();
+}
+
+/*
+ * Runs the next command of the first request in the queue, moving on to the next request when
+ * its last command finishes
+ */
+void PrivilegedHelper::startNextCommand()
+{
+  if (m_queue.isEmpty())
+  {
+    m_runningClient = NULL;
+    m_idleTimer->start();
+    return;
+  }
+
+  m_idleTimer->stop();
+
+  Request &request = m_queue.first();
+  m_runningClient = request.client;
+
+  QStringList command = request.commands.takeFirst();
+  QString program = QStandardPaths::findExecutable(command.takeFirst(),
+                                                   QStringList() << "/usr/bin" << "/usr/sbin" << "/bin" << "/sbin");
+
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.insert("LANG", request.lang);
+  env.insert("LC_MESSAGES", request.lang);
+  m_process->setProcessEnvironment(env);
+
+  if (program.isEmpty())
+  {
+    onFinished(127, QProcess::NormalExit);
+    return;
+  }
+
+  m_process->start(program, command);
+  m_process->closeWriteChannel();
+}
+
+void PrivilegedHelper::onReadyReadStandardOutput()
+{
+  sendMessage(m_runningClient, ectn_HELPER_STANDARD_OUTPUT, 0, m_process->readAllStandardOutput());
+}
+
+void PrivilegedHelper::onReadyReadStandardError()
+{
+  sendMessage(m_runningClient, ectn_HELPER_STANDARD_ERROR, 0, m_process->readAllStandardError());
+}
+
+/*
+ * Commands of a request run like they were separated by ";" in a shell: the request's exit code
+ * is the one of its last command
+ */
+void PrivilegedHelper::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+  if (m_queue.isEmpty()) return;
+
+  if (!m_queue.first().commands.isEmpty())
+  {
+    startNextCommand();
+    return;
+  }
+
+  sendMessage(m_runningClient, ectn_HELPER_FINISHED, exitCode, QByteArray::number(int(exitStatus)));
+  m_queue.removeFirst();
+  m_runningClient = NULL;
+
+  startNextCommand();
+}
+
+void PrivilegedHelper::onError(QProcess::ProcessError error)
+{
+  if (error == QProcess::FailedToStart)
+    onFinished(127, QProcess::NormalExit);
+}
+
+/*
+ * Nobody asked for anything in a while, so we stop running as root
+ */
+void PrivilegedHelper::onIdleTimeout()
+{
+  if (m_process->state() != QProcess::NotRunning || !m_queue.isEmpty()) return;
+
+  qApp->quit();
+}
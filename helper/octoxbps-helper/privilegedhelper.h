@@ -0,0 +1,89 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef PRIVILEGEDHELPER_H
+#define PRIVILEGEDHELPER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+class QTimer;
+
+/*
+ * Runs as root for a whole session, so successive transactions don't pay for the SU front-end.
+ *
+ * It listens on a socket inside the runtime dir of the user who started it, accepts only that
+ * user (and root) as peers, and runs their requests one at a time, in the order they arrived.
+ * A request is a list of XBPS commands run in sequence, without any shell in between; their
+ * output streams back to the client which queued it.
+ */
+
+class PrivilegedHelper : public QObject
+{
+  Q_OBJECT
+
+private:
+  struct Request
+  {
+    QLocalSocket *client;
+    QString lang;
+    QList<QStringList> commands;
+  };
+
+  QLocalServer *m_server;
+  QString m_socketPath;
+  uint m_uid;
+  QProcess *m_process;
+  QTimer *m_idleTimer;
+  QList<Request> m_queue;
+  QLocalSocket *m_runningClient;
+  QHash<QLocalSocket *, quint32> m_blockSizes;
+
+  bool handOverSocket();
+  bool isPeerAllowed(QLocalSocket *client);
+  bool isCommandAllowed(const QStringList &command);
+  void sendMessage(QLocalSocket *client, int type, int code, const QByteArray &data);
+  void startNextCommand();
+
+private slots:
+  void onNewConnection();
+  void onReadyRead();
+  void onDisconnected();
+  void onReadyReadStandardOutput();
+  void onReadyReadStandardError();
+  void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+  void onError(QProcess::ProcessError error);
+  void onIdleTimeout();
+
+public:
+  PrivilegedHelper(const QString &socketPath, uint uid, QObject *parent = 0);
+  virtual ~PrivilegedHelper();
+
+  bool listen();
+};
+
+#endif // PRIVILEGEDHELPER_H
@@ -25,6 +25,10 @@
 #include "../../src/strconstants.h"
 #include "../../src/uihelper.h"
 #include "../../src/package.h"
+#include "../../src/packagestatecache.h"
+#include "../../src/daemonclient.h"
+#include "../../src/privilegedhelperclient.h"
+#include "../../src/QtSolutions/qtlocalpeer.h"
 #include "../../src/transactiondialog.h"
 
 #include <QTimer>
@@ -289,6 +293,16 @@ bool MainWindow::_isSUAvailable()
     return true;
 }
 
+/*
+ * Hands the upgrade plan we've just computed to a running OctoXBPS, which then
+ * opens its upgrade dialog without running another dry run
+ */
+bool MainWindow::sendUpgradePlan(const TransactionInfo &ti)
+{
+  QtLocalPeer peer(this, StrConstants::getApplicationName());
+  return peer.sendMessageToServer(PackageStateCache::encodeUpgradePlan(ti), 5000);
+}
+
 /*
  * Calls only the OctoXBPS system upgrade window
  */
@@ -317,6 +331,12 @@ void MainWindow::doSystemUpgrade()
     return;
   }
 
+  //OctoXBPS is open, so it does the upgrade (two transactions at once would just fight for the lock)
+  if (UnixCommand::isAppRunning("octoxbps", true) && sendUpgradePlan(ti))
+  {
+    return;
+  }
+
   QString list;
 
   foreach(QString target, *targets)
@@ -579,6 +599,16 @@ void MainWindow::sendNotification(const QString &msg)
 
 void MainWindow::startPkexec()
 {
+  //If OctoXBPS has already started octoxbps-helper, the sync doesn't ask for a password again
+  if (PrivilegedHelperClient::isAvailable() && PrivilegedHelperClient::instance()->isRunning())
+  {
+    UnixCommand *helper = new UnixCommand(this);
+    connect(helper, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(finishedPkexec(int)));
+    connect(helper, SIGNAL(finished(int,QProcess::ExitStatus)), helper, SLOT(deleteLater()));
+    helper->executeCommand("xbps-install -Syy");
+    return;
+  }
+
   QProcess *xbps = new QProcess();
   connect(xbps, SIGNAL(finished(int)), this, SLOT(finishedPkexec(int)));
   xbps->start("pkexec xbps-install -Syy");
@@ -597,7 +627,10 @@ void MainWindow::refreshAppIcon()
   if (m_debugInfo)
     qDebug() << "At refreshAppIcon()...";
 
-  m_outdatedStringList = Package::getOutdatedStringList();
+  //octoxbps-daemon already has them in memory
+  m_outdatedStringList = DaemonClient::getOutdatedPackages();
+  if (m_outdatedStringList == NULL)
+    m_outdatedStringList = PackageStateCache::getOutdatedPackages();
   m_numberOfOutdatedPackages = m_outdatedStringList->count();
   m_numberOfOutdatedAURPackages = 0;
 
@@ -108,6 +108,7 @@ private:
   //PacmanHelperClient *m_pacmanHelperClient;
 
   bool _isSUAvailable();
+  bool sendUpgradePlan(const TransactionInfo &ti);
   void initSystemTrayIcon();
   void sendNotification(const QString &msg);
 
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT += core xml gui network #dbus
+QT += core xml gui network dbus
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -23,8 +23,22 @@ SOURCES += main.cpp \
     outputdialog.cpp \
     ../../src/terminal.cpp \
     ../../src/unixcommand.cpp \
+    ../../src/unixcommand_query.cpp \
+    ../../src/privilegedhelperclient.cpp \
+    ../../src/queryrecorder.cpp \
+    ../../src/tracer.cpp \
+    ../../src/processaccounting.cpp \
     ../../src/package.cpp \
+    ../../src/xbpsplist.cpp \
+    ../../src/dependencygraph.cpp \
+    ../../src/searchindex.cpp \
+    ../../src/packagecacheindex.cpp \
+    ../../src/packagestatecache.cpp \
+    ../../src/daemonclient.cpp \
+    ../../src/QtSolutions/qtlocalpeer.cpp \
     ../../src/wmhelper.cpp \
+    ../../src/systemcapabilities.cpp \
+    ../../src/pathresolver.cpp \
     ../../src/settingsmanager.cpp \
     #../pacmanhelper/pacmanhelperclient.cpp \
     ../../src/utils.cpp \
@@ -41,9 +55,23 @@ HEADERS  += \
     ../../src/uihelper.h \
     ../../src/terminal.h \
     ../../src/unixcommand.h \
+    ../../src/privilegedhelperclient.h \
+    ../../src/queryrecorder.h \
+    ../../src/tracer.h \
+    ../../src/processaccounting.h \
     ../../src/wmhelper.h \
+    ../../src/systemcapabilities.h \
+    ../../src/pathresolver.h \
     ../../src/strconstants.h \
     ../../src/package.h \
+    ../../src/xbpsplist.h \
+    ../../src/dependencygraph.h \
+    ../../src/searchindex.h \
+    ../../src/packagecacheindex.h \
+    ../../src/packagestatecache.h \
+    ../../src/daemonclient.h \
+    ../../src/QtSolutions/qtlockedfile.h \
+    ../../src/QtSolutions/qtlocalpeer.h \
     #../pacmanhelper/pacmanhelperclient.h \
     ../../src/utils.h \
     ../../src/transactiondialog.h \
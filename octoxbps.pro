@@ -23,13 +23,28 @@ HEADERS += src/QtSolutions/qtsingleapplication.h \
         src/settingsmanager.h \
         src/uihelper.h \
         src/package.h \
+        src/xbpsplist.h \
+        src/dependencygraph.h \
+        src/searchindex.h \
+        src/fileownerindex.h \
+        src/packagecacheindex.h \
+        src/packagestatecache.h \
+        src/daemonclient.h \
         src/unixcommand.h \
+        src/privilegedhelperclient.h \
+        src/queryrecorder.h \
+        src/tracer.h \
+        src/processaccounting.h \
+        src/stallwatchdog.h \
         src/wmhelper.h \
+        src/systemcapabilities.h \
+        src/pathresolver.h \
         src/treeviewpackagesitemdelegate.h \
         src/searchbar.h \
         src/transactiondialog.h \
         src/globals.h \
         src/multiselectiondialog.h \
+        src/diagnosticsdialog.h \
         src/packagerepository.h \
         src/model/packagemodel.h \
         src/ui/octopitabinfo.h \
@@ -47,8 +62,23 @@ SOURCES += src/QtSolutions/qtsingleapplication.cpp \
         src/argumentlist.cpp \
         src/settingsmanager.cpp \
         src/package.cpp \
+        src/xbpsplist.cpp \
+        src/dependencygraph.cpp \
+        src/searchindex.cpp \
+        src/fileownerindex.cpp \
+        src/packagecacheindex.cpp \
+        src/packagestatecache.cpp \
+        src/daemonclient.cpp \
         src/unixcommand.cpp \
+        src/unixcommand_query.cpp \
+        src/privilegedhelperclient.cpp \
+        src/queryrecorder.cpp \
+        src/tracer.cpp \
+        src/processaccounting.cpp \
+        src/stallwatchdog.cpp \
         src/wmhelper.cpp \
+        src/systemcapabilities.cpp \
+        src/pathresolver.cpp \
         src/treeviewpackagesitemdelegate.cpp \
         src/mainwindow_init.cpp \
         src/mainwindow_transaction.cpp \
@@ -61,6 +91,7 @@ SOURCES += src/QtSolutions/qtsingleapplication.cpp \
         src/mainwindow_refresh.cpp \
         src/globals.cpp \
         src/multiselectiondialog.cpp \
+        src/diagnosticsdialog.cpp \
         src/packagerepository.cpp \
         src/model/packagemodel.cpp \
         src/ui/octopitabinfo.cpp \
@@ -137,6 +137,13 @@ bool QtLocalPeer::sendMessage(const QString &message, int timeout)
     if (!isClient())
         return false;
 
+    return sendMessageToServer(message, timeout);
+}
+
+
+// Sends the message to the running instance (if any) without ever becoming it
+bool QtLocalPeer::sendMessageToServer(const QString &message, int timeout)
+{
     QLocalSocket socket;
     bool connOk = false;
     for(int i = 0; i < 2; i++) {
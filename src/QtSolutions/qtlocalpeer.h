@@ -54,6 +54,7 @@ public:
     QtLocalPeer(QObject *parent = 0, const QString &appId = QString());
     bool isClient();
     bool sendMessage(const QString &message, int timeout);
+    bool sendMessageToServer(const QString &message, int timeout);
     QString applicationId() const
         { return id; }
 
@@ -39,6 +39,7 @@
 
 #ifdef OCTOXBPS_EXTENSIONS
   #include "../mainwindow.h"
+  #include "../packagestatecache.h"
 #endif
 
 #include "qtsingleapplication.h"
@@ -366,6 +367,35 @@ void QtSingleApplication::activateWindow(const QString &message)
       }
     }
   }
+  else if (actWin && PackageStateCache::isUpgradePlanMessage(message)) {
+    actWin->setWindowState(actWin->windowState() & ~Qt::WindowMinimized);
+    actWin->raise();
+    if (actWin->isHidden())
+      actWin->show();
+    else
+      actWin->activateWindow();
+
+    MainWindow *mw = qobject_cast<MainWindow *>(actWin);
+
+    if (mw)
+    {
+      mw->setUpgradePlan(message);
+
+      //While it's starting or busy, the upgrade runs as soon as it's done (the plan is checked again then)
+      if (!mw->isInitializationCompleted())
+      {
+        mw->setCallSystemUpgrade();
+      }
+      else if (mw->isExecutingCommand())
+      {
+        mw->setCallSystemUpgradeAfterTransaction();
+      }
+      else
+      {
+        mw->doPreSystemUpgrade();
+      }
+    }
+  }
   else if (actWin && message == "CLOSE") {
     if (!actWin->close())
     {
@@ -83,8 +83,15 @@ const QString ctn_KEEP_NUM_UNINSTALLED("Keep_Num_Uninstalled");
 //Package related
 const QString ctn_TEMP_ACTIONS_FILE ( QDir::tempPath() + QDir::separator() + ".qt_temp_" );
 const QString ctn_XBPS_DATABASE_DIR = "/var/db/xbps";
+const QString ctn_XBPS_CACHE_DIR = "/var/cache/xbps";
+const QString ctn_XBPS_CONF_DIR = "/etc/xbps.d";
+const QString ctn_XBPS_SYSTEM_CONF_DIR = "/usr/share/xbps.d";
+const QString ctn_OCTOXBPS_CACHE_DIR ( QDir::homePath() + QDir::separator() + ".cache/octoxbps" );
 const QString ctn_PACMAN_CORE_DB_FILE = "/var/lib/pacman/sync/core.db";
 
+//Milliseconds to wait for pkgdb to settle down before acting on the packages changed by a transaction
+const int ctn_PACKAGE_DATABASE_WATCHER_DELAY(1000);
+
 enum PackageStatus { ectn_INSTALLED, ectn_NON_INSTALLED, ectn_OUTDATED, ectn_NEWER,
                      ectn_FOREIGN, ectn_FOREIGN_OUTDATED };
 
@@ -172,4 +179,17 @@ const QString ctn_DBUS_PACMANHELPER_SERVICE = "/usr/share/dbus-1/system-services
 enum ExecOpt { ectn_NORMAL_EXEC_OPT, ectn_SYSUPGRADE_EXEC_OPT,
                ectn_SYSUPGRADE_NOCONFIRM_EXEC_OPT };
 
+//OctoXBPS-helper related  ---------------------------------------------------------------------------------
+
+const QString ctn_OCTOXBPS_HELPER_BINARY = "/usr/bin/octoxbps-helper";
+const QString ctn_OCTOXBPS_HELPER_SOCKET_NAME = "octoxbps-helper";
+
+//The only programs the helper runs on behalf of its clients
+const QString ctn_OCTOXBPS_HELPER_COMMANDS = "xbps-install xbps-remove";
+
+//Milliseconds without any transaction after which the helper exits
+const int ctn_OCTOXBPS_HELPER_IDLE_TIMEOUT(10 * 60 * 1000);
+
+enum PrivilegedHelperMessage { ectn_HELPER_STANDARD_OUTPUT, ectn_HELPER_STANDARD_ERROR, ectn_HELPER_FINISHED };
+
 #endif // CONSTANTS
@@ -0,0 +1,163 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "daemonclient.h"
+#include "packagestatecache.h"
+#include "tracer.h"
+
+#include <QDataStream>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMessage>
+#include <QDBusReply>
+#include <QDBusServiceWatcher>
+
+/*
+ * Synchronously calls the given daemon method. The first call may start the daemon through
+ * D-Bus activation, so it can take as long as the queries themselves
+ */
+bool DaemonClient::call(const QString &method, const QList<QVariant> &args, QVariant &result)
+{
+  QDBusConnection bus = QDBusConnection::sessionBus();
+  if (!bus.isConnected()) return false;
+
+  QDBusMessage msg = QDBusMessage::createMethodCall(ctn_OCTOXBPS_DAEMON_SERVICE, ctn_OCTOXBPS_DAEMON_PATH,
+                                                    ctn_OCTOXBPS_DAEMON_INTERFACE, method);
+  msg.setArguments(args);
+
+  QDBusMessage reply = bus.call(msg, QDBus::Block, ctn_OCTOXBPS_DAEMON_TIMEOUT);
+  if (reply.type() != QDBusMessage::ReplyMessage || reply.arguments().isEmpty()) return false;
+
+  result = reply.arguments().first();
+  return true;
+}
+
+/*
+ * Returns true if the daemon is running or D-Bus can start it
+ */
+bool DaemonClient::isAvailable()
+{
+  QDBusConnection bus = QDBusConnection::sessionBus();
+  if (!bus.isConnected() || bus.interface() == NULL) return false;
+
+  if (bus.interface()->isServiceRegistered(ctn_OCTOXBPS_DAEMON_SERVICE)) return true;
+
+  QDBusReply<QStringList> activatable = bus.interface()->call("ListActivatableNames");
+  return (activatable.isValid() && activatable.value().contains(ctn_OCTOXBPS_DAEMON_SERVICE));
+}
+
+/*
+ * Calls the given slot of receiver whenever the daemon sees the XBPS database change
+ */
+bool DaemonClient::connectToPackageDatabaseChanged(QObject *receiver, const char *slot)
+{
+  return QDBusConnection::sessionBus().connect(ctn_OCTOXBPS_DAEMON_SERVICE, ctn_OCTOXBPS_DAEMON_PATH,
+                                               ctn_OCTOXBPS_DAEMON_INTERFACE, "packageDatabaseChanged",
+                                               receiver, slot);
+}
+
+/*
+ * Calls the given slot of receiver if the daemon leaves the bus
+ */
+void DaemonClient::watchForUnregistration(QObject *receiver, const char *slot)
+{
+  QDBusServiceWatcher *watcher = new QDBusServiceWatcher(ctn_OCTOXBPS_DAEMON_SERVICE, QDBusConnection::sessionBus(),
+                                                         QDBusServiceWatcher::WatchForUnregistration, receiver);
+  QObject::connect(watcher, SIGNAL(serviceUnregistered(QString)), receiver, slot);
+}
+
+/*
+ * Packs everything OctoXBPS needs to show its package list in a single blob
+ */
+QByteArray DaemonClient::encodePackageListSnapshot(const QList<PackageListData> &packages,
+                                                   const QMap<QString, OutdatedPackageInfo> &outdatedPackages,
+                                                   const QSet<QString> &unrequiredPackages)
+{
+  QByteArray data;
+  QDataStream out(&data, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_5_0);
+
+  out << PackageStateCache::encodePackageList(packages)
+      << PackageStateCache::encodeOutdatedPackages(outdatedPackages)
+      << unrequiredPackages.toList();
+
+  return data;
+}
+
+bool DaemonClient::decodePackageListSnapshot(const QByteArray &data,
+                                             QList<PackageListData> *&packages,
+                                             QMap<QString, OutdatedPackageInfo> *&outdatedPackages,
+                                             QSet<QString> *&unrequiredPackages)
+{
+  QDataStream in(data);
+  in.setVersion(QDataStream::Qt_5_0);
+
+  QByteArray packageData, outdatedData;
+  QStringList unrequired;
+  in >> packageData >> outdatedData >> unrequired;
+
+  if (in.status() != QDataStream::Ok) return false;
+
+  packages = PackageStateCache::decodePackageList(packageData);
+  outdatedPackages = PackageStateCache::decodeOutdatedPackages(outdatedData);
+  unrequiredPackages = new QSet<QString>(unrequired.toSet());
+  return true;
+}
+
+/*
+ * Retrieves the package list, the outdated and the unrequired packages in one round trip
+ */
+bool DaemonClient::getPackageListSnapshot(QList<PackageListData> *&packages,
+                                          QMap<QString, OutdatedPackageInfo> *&outdatedPackages,
+                                          QSet<QString> *&unrequiredPackages)
+{
+  TraceSpan span("DaemonClient::getPackageListSnapshot");
+  QVariant result;
+
+  if (!call("getPackageListSnapshot", QList<QVariant>(), result)) return false;
+
+  return decodePackageListSnapshot(result.toByteArray(), packages, outdatedPackages, unrequiredPackages);
+}
+
+/*
+ * Retrieves the outdated packages, which the daemon answers as "name oldVersion newVersion" lines
+ */
+QMap<QString, OutdatedPackageInfo>* DaemonClient::getOutdatedPackages()
+{
+  TraceSpan span("DaemonClient::getOutdatedPackages");
+  QVariant result;
+
+  if (!call("getOutdatedPackages", QList<QVariant>(), result)) return NULL;
+
+  QMap<QString, OutdatedPackageInfo> *res = new QMap<QString, OutdatedPackageInfo>();
+
+  foreach(QString line, result.toStringList())
+  {
+    QStringList parts = line.split(" ", QString::SkipEmptyParts);
+    if (parts.count() != 3) continue;
+
+    OutdatedPackageInfo opi;
+    opi.oldVersion = parts.at(1);
+    opi.newVersion = parts.at(2);
+    res->insert(parts.at(0), opi);
+  }
+
+  return res;
+}
@@ -0,0 +1,72 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef DAEMONCLIENT_H
+#define DAEMONCLIENT_H
+
+#include "package.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+const QString ctn_OCTOXBPS_DAEMON_SERVICE("org.octoxbps.daemon");
+const QString ctn_OCTOXBPS_DAEMON_PATH("/");
+const QString ctn_OCTOXBPS_DAEMON_INTERFACE("org.octoxbps.daemon");
+const int ctn_OCTOXBPS_DAEMON_TIMEOUT = 60000;
+
+/*
+ * Talks to octoxbps-daemon, the session bus service which keeps the package list, the outdated
+ * and unrequired packages, the dependency graph and the file ownership index in memory.
+ *
+ * Every method returns NULL (or false) when the daemon is neither running nor activatable, so
+ * callers simply fall back to their own queries.
+ */
+
+class DaemonClient
+{
+private:
+  static bool call(const QString &method, const QList<QVariant> &args, QVariant &result);
+
+public:
+  static bool isAvailable();
+  static bool connectToPackageDatabaseChanged(QObject *receiver, const char *slot);
+  static void watchForUnregistration(QObject *receiver, const char *slot);
+
+  static QByteArray encodePackageListSnapshot(const QList<PackageListData> &packages,
+                                              const QMap<QString, OutdatedPackageInfo> &outdatedPackages,
+                                              const QSet<QString> &unrequiredPackages);
+  static bool decodePackageListSnapshot(const QByteArray &data,
+                                        QList<PackageListData> *&packages,
+                                        QMap<QString, OutdatedPackageInfo> *&outdatedPackages,
+                                        QSet<QString> *&unrequiredPackages);
+
+  static bool getPackageListSnapshot(QList<PackageListData> *&packages,
+                                     QMap<QString, OutdatedPackageInfo> *&outdatedPackages,
+                                     QSet<QString> *&unrequiredPackages);
+  static QMap<QString, OutdatedPackageInfo>* getOutdatedPackages();
+};
+
+#endif // DAEMONCLIENT_H
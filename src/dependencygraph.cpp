@@ -0,0 +1,725 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "dependencygraph.h"
+#include "xbpsplist.h"
+#include "constants.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutexLocker>
+#include <QRegularExpression>
+
+/*
+ * The graph starts empty: pkgdb and repository indexes are read on demand
+ */
+DependencyGraph::DependencyGraph()
+{
+  m_hasPkgdb = false;
+  m_hasRepoIndex = false;
+  m_loadingRepositories = false;
+}
+
+/*
+ * Returns the one and only dependency graph
+ */
+DependencyGraph* DependencyGraph::instance()
+{
+  static DependencyGraph graph;
+  return &graph;
+}
+
+/*
+ * Extracts the package name from a dependency pattern such as "glibc>=2.29_1" or "foo-1.0_1"
+ */
+QString DependencyGraph::getNameFromPattern(const QString &pattern)
+{
+  int op = pattern.indexOf(QRegularExpression("[<>=]"));
+  if (op > 0) return pattern.left(op);
+
+  int dash = pattern.lastIndexOf("-");
+  if (dash > 0)
+  {
+    QString version = pattern.mid(dash+1);
+    if (version.contains("_") || version.isEmpty() ||
+        version.at(0).isDigit() || version.at(0) == '[' || version.at(0) == '*')
+      return pattern.left(dash);
+  }
+
+  return pattern;
+}
+
+/*
+ * Returns the id of the given package, creating its node if needed
+ */
+int DependencyGraph::nodeId(const QString &pkgName)
+{
+  QHash<QString, int>::const_iterator it = m_ids.constFind(pkgName);
+  if (it != m_ids.constEnd()) return it.value();
+
+  int id = m_nodes.count();
+  m_nodes.append(Node());
+  m_nodes[id].name = pkgName;
+  m_ids.insert(pkgName, id);
+
+  return id;
+}
+
+/*
+ * Finds the installed package (real or virtual provider) which satisfies the given pattern
+ */
+int DependencyGraph::resolveInstalled(const QString &pattern) const
+{
+  QString name = getNameFromPattern(pattern);
+  int id = m_ids.value(name, -1);
+
+  if (id != -1 && m_nodes.at(id).installed) return id;
+  return m_installedProviders.value(name, -1);
+}
+
+/*
+ * Finds the repository package (real or virtual provider) which satisfies the given pattern.
+ * If no repository has it, an installed package may still do the job
+ */
+int DependencyGraph::resolveRepository(const QString &pattern) const
+{
+  QString name = getNameFromPattern(pattern);
+  int id = m_ids.value(name, -1);
+
+  if (id != -1 && m_nodes.at(id).inRepository) return id;
+
+  id = m_repoProviders.value(name, -1);
+  if (id != -1) return id;
+
+  return resolveInstalled(pattern);
+}
+
+/*
+ * Creates forward and reverse edges for the given installed package
+ */
+void DependencyGraph::linkInstalled(int id)
+{
+  foreach(QString pattern, m_nodes.at(id).dependsPatterns)
+  {
+    int dep = resolveInstalled(pattern);
+    if (dep == -1 || dep == id || m_nodes.at(id).depends.contains(dep)) continue;
+
+    m_nodes[id].depends.append(dep);
+    m_nodes[dep].requiredBy.append(id);
+  }
+}
+
+/*
+ * Drops the forward edges of the given package (and their reverse counterparts)
+ */
+void DependencyGraph::unlinkInstalled(int id)
+{
+  foreach(int dep, m_nodes.at(id).depends)
+  {
+    m_nodes[dep].requiredBy.removeAll(id);
+  }
+
+  m_nodes[id].depends.clear();
+}
+
+/*
+ * Converts a plist array of strings into a QStringList
+ */
+QStringList DependencyGraph::toStringList(const QVariant &value)
+{
+  QStringList res;
+
+  foreach(QVariant v, value.toList())
+  {
+    res.append(v.toString());
+  }
+
+  return res;
+}
+
+/*
+ * Merges a freshly read pkgdb into the graph.
+ * Only packages that were installed, removed or changed their pkgver get their edges rebuilt
+ */
+void DependencyGraph::loadPkgdb(const QVariantMap &pkgdb)
+{
+  QSet<int> seen;
+  QList<int> changed;
+  QHash<QString, int> providers;
+
+  for (QVariantMap::const_iterator it = pkgdb.constBegin(); it != pkgdb.constEnd(); ++it)
+  {
+    if (it.key().startsWith("_")) continue; //_XBPS_ALTERNATIVES_ and friends
+
+    QVariantMap pkg = it.value().toMap();
+    QString pkgver = pkg.value("pkgver").toString();
+    int id = nodeId(it.key());
+    seen.insert(id);
+
+    foreach(QString provides, toStringList(pkg.value("provides")))
+    {
+      providers.insert(getNameFromPattern(provides), id);
+    }
+
+    Node &node = m_nodes[id];
+    node.automatic = pkg.value("automatic-install").toBool();
+    node.installedSize = pkg.value("installed_size").toLongLong();
+    node.shortDesc = pkg.value("short_desc").toString();
+
+    if (!node.installed || node.pkgver != pkgver)
+    {
+      node.installed = true;
+      node.pkgver = pkgver;
+      node.dependsPatterns = toStringList(pkg.value("run_depends"));
+      changed.append(id);
+    }
+  }
+
+  //Packages which are gone from pkgdb
+  for (int id = 0; id < m_nodes.count(); ++id)
+  {
+    if (!m_nodes.at(id).installed || seen.contains(id)) continue;
+
+    unlinkInstalled(id);
+
+    foreach(int dependent, m_nodes.at(id).requiredBy)
+    {
+      m_nodes[dependent].depends.removeAll(id);
+      changed.append(dependent);
+    }
+
+    Node &node = m_nodes[id];
+    node.installed = false;
+    node.automatic = false;
+    node.pkgver.clear();
+    node.shortDesc.clear();
+    node.installedSize = 0;
+    node.dependsPatterns.clear();
+    node.requiredBy.clear();
+  }
+
+  //A different set of virtual packages may change any edge, so everything is relinked
+  if (providers != m_installedProviders || !m_hasPkgdb)
+  {
+    m_installedProviders = providers;
+
+    for (int id = 0; id < m_nodes.count(); ++id)
+    {
+      m_nodes[id].depends.clear();
+      m_nodes[id].requiredBy.clear();
+    }
+
+    for (int id = 0; id < m_nodes.count(); ++id)
+    {
+      if (m_nodes.at(id).installed) linkInstalled(id);
+    }
+  }
+  else
+  {
+    foreach(int id, changed)
+    {
+      if (!m_nodes.at(id).installed) continue;
+
+      unlinkInstalled(id);
+      linkInstalled(id);
+    }
+  }
+}
+
+/*
+ * Adds the packages of one repository index to the graph. Indexes come in the order the repositories
+ * are configured, so when more than one has the same package, the first one wins (like XBPS does)
+ */
+void DependencyGraph::loadRepositoryIndex(const QVariantMap &index)
+{
+  for (QVariantMap::const_iterator it = index.constBegin(); it != index.constEnd(); ++it)
+  {
+    int id = nodeId(it.key());
+    if (m_nodes.at(id).inRepository) continue;
+
+    QVariantMap pkg = it.value().toMap();
+
+    foreach(QString provides, toStringList(pkg.value("provides")))
+    {
+      QString virtualName = getNameFromPattern(provides);
+      if (!m_repoProviders.contains(virtualName))
+        m_repoProviders.insert(virtualName, id);
+    }
+
+    Node &node = m_nodes[id];
+    node.inRepository = true;
+    node.repoPkgver = pkg.value("pkgver").toString();
+    node.repoInstalledSize = pkg.value("installed_size").toLongLong();
+    node.repoDownloadSize = pkg.value("filename-size").toLongLong();
+    node.repoDependsPatterns = toStringList(pkg.value("run_depends"));
+  }
+}
+
+/*
+ * Re-reads pkgdb if it changed on disk since the last time we looked at it
+ */
+void DependencyGraph::ensureInstalledUpToDate()
+{
+  if (m_pkgdbFile.isEmpty())
+  {
+    QDir dbDir(ctn_XBPS_DATABASE_DIR);
+    QStringList pkgdbs = dbDir.entryList(QStringList() << "pkgdb-*.plist", QDir::Files, QDir::Name);
+    if (pkgdbs.isEmpty()) return;
+
+    m_pkgdbFile = dbDir.absoluteFilePath(pkgdbs.last());
+  }
+
+  QFileInfo fi(m_pkgdbFile);
+  if (!fi.exists())
+  {
+    m_pkgdbFile.clear();
+    m_hasPkgdb = false;
+    return;
+  }
+
+  if (m_hasPkgdb && fi.lastModified() == m_pkgdbModified) return;
+
+  QVariantMap pkgdb = XBPSPlist::parseFile(m_pkgdbFile).toMap();
+  if (pkgdb.isEmpty()) return;
+
+  loadPkgdb(pkgdb);
+  m_pkgdbModified = fi.lastModified();
+  m_hasPkgdb = true;
+}
+
+/*
+ * Returns the repositories configured in xbps.d, in the order XBPS queries them: conf files are read
+ * in alphabetical order, and one in /etc/xbps.d replaces the one with the same name in /usr/share/xbps.d
+ */
+QStringList DependencyGraph::getConfiguredRepositories()
+{
+  QMap<QString, QString> confFiles; //file name -> path
+
+  foreach(QString confDir, QStringList() << ctn_XBPS_SYSTEM_CONF_DIR << ctn_XBPS_CONF_DIR)
+  {
+    QDir dir(confDir);
+
+    foreach(QString confFile, dir.entryList(QStringList() << "*.conf", QDir::Files, QDir::Name))
+    {
+      confFiles.insert(confFile, dir.absoluteFilePath(confFile));
+    }
+  }
+
+  QStringList res;
+
+  foreach(QString confFile, confFiles)
+  {
+    QFile file(confFile);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) continue;
+
+    while (!file.atEnd())
+    {
+      QString line = QString::fromUtf8(file.readLine()).trimmed();
+      int equal = line.indexOf('=');
+      if (equal == -1 || line.left(equal).trimmed() != "repository") continue;
+
+      QString repository = line.mid(equal + 1).trimmed();
+      if (!repository.isEmpty() && !res.contains(repository)) res.append(repository);
+    }
+  }
+
+  return res;
+}
+
+/*
+ * Returns the repodata files of every repository XBPS has synced, in the order the repositories
+ * are configured. Synced ones which are not configured (anymore) come last, in alphabetical order
+ */
+QStringList DependencyGraph::getRepodataFiles()
+{
+  QStringList res;
+  QDir dbDir(ctn_XBPS_DATABASE_DIR);
+  QStringList repoDirs = dbDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+  QStringList orderedRepoDirs;
+
+  //XBPS keeps each remote repository in a dir named after its URL, with '.', ':' and '/' as '_'
+  foreach(QString repository, getConfiguredRepositories())
+  {
+    QString repoDir = QString(repository).replace(QRegularExpression("[.:/]"), "_");
+    if (repoDirs.removeOne(repoDir)) orderedRepoDirs.append(repoDir);
+  }
+
+  orderedRepoDirs.append(repoDirs);
+
+  foreach(QString repoDir, orderedRepoDirs)
+  {
+    QDir dir(dbDir.absoluteFilePath(repoDir));
+
+    foreach(QString repodata, dir.entryList(QStringList() << "*-repodata", QDir::Files, QDir::Name))
+    {
+      res.append(dir.absoluteFilePath(repodata));
+    }
+  }
+
+  return res;
+}
+
+/*
+ * Re-reads the repository indexes if any of them changed since the last time (a sync happened).
+ * The caller's locker is released while the archives are being extracted, and callers arriving
+ * meanwhile just see the previous (maybe empty) repository data
+ */
+void DependencyGraph::ensureRepositoriesUpToDate(QMutexLocker &locker)
+{
+  if (m_loadingRepositories) return;
+
+  QHash<QString, QDateTime> modified;
+  QStringList repodataFiles = getRepodataFiles();
+
+  foreach(QString repodata, repodataFiles)
+  {
+    modified.insert(repodata, QFileInfo(repodata).lastModified());
+  }
+
+  //The same files that failed to load last time would fail again, so they are not read twice
+  if (modified.isEmpty() || modified == m_repodataModified) return;
+
+  m_loadingRepositories = true;
+  locker.unlock();
+
+  QList<QVariantMap> indexes;
+
+  foreach(QString repodata, repodataFiles)
+  {
+    QVariantMap index = XBPSPlist::parse(XBPSPlist::extractFromArchive(repodata, "index.plist")).toMap();
+    if (!index.isEmpty()) indexes.append(index);
+  }
+
+  locker.relock();
+  m_loadingRepositories = false;
+  m_repodataModified = modified;
+
+  if (indexes.isEmpty()) return;
+
+  m_repoProviders.clear();
+  for (int id = 0; id < m_nodes.count(); ++id)
+  {
+    Node &node = m_nodes[id];
+    node.inRepository = false;
+    node.repoPkgver.clear();
+    node.repoInstalledSize = 0;
+    node.repoDownloadSize = 0;
+    node.repoDependsPatterns.clear();
+    node.repoDepends.clear();
+  }
+
+  foreach(QVariantMap index, indexes)
+  {
+    loadRepositoryIndex(index);
+  }
+
+  for (int id = 0; id < m_nodes.count(); ++id)
+  {
+    foreach(QString pattern, m_nodes.at(id).repoDependsPatterns)
+    {
+      int dep = resolveRepository(pattern);
+      if (dep != -1 && dep != id && !m_nodes.at(id).repoDepends.contains(dep))
+        m_nodes[id].repoDepends.append(dep);
+    }
+  }
+
+  m_hasRepoIndex = true;
+}
+
+/*
+ * Returns true if the installed package database could be read
+ */
+bool DependencyGraph::hasPackageDatabase()
+{
+  QMutexLocker locker(&m_mutex);
+  ensureInstalledUpToDate();
+
+  return m_hasPkgdb;
+}
+
+/*
+ * Returns true if at least one repository index could be read
+ */
+bool DependencyGraph::hasRepositoryIndex()
+{
+  QMutexLocker locker(&m_mutex);
+  ensureRepositoriesUpToDate(locker);
+
+  return m_hasRepoIndex;
+}
+
+/*
+ * Returns true if the given package is in the installed package database
+ */
+bool DependencyGraph::isInstalled(const QString &pkgName)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureInstalledUpToDate();
+
+  int id = m_ids.value(pkgName, -1);
+  return (id != -1 && m_nodes.at(id).installed);
+}
+
+/*
+ * Returns the last time pkgdb changed on disk (an invalid date when there's no pkgdb)
+ */
+QDateTime DependencyGraph::getPackageDatabaseModified()
+{
+  QMutexLocker locker(&m_mutex);
+  ensureInstalledUpToDate();
+
+  return m_hasPkgdb ? m_pkgdbModified : QDateTime();
+}
+
+/*
+ * Returns the pkgver of every installed package, keyed by package name
+ */
+QHash<QString, QString> DependencyGraph::getInstalledPackageVersions()
+{
+  QMutexLocker locker(&m_mutex);
+  ensureInstalledUpToDate();
+
+  QHash<QString, QString> res;
+
+  for (int id = 0; id < m_nodes.count(); ++id)
+  {
+    if (m_nodes.at(id).installed)
+      res.insert(m_nodes.at(id).name, m_nodes.at(id).pkgver);
+  }
+
+  return res;
+}
+
+/*
+ * Returns the short description of the given installed package, as pkgdb has it
+ */
+QString DependencyGraph::getShortDescription(const QString &pkgName)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureInstalledUpToDate();
+
+  int id = m_ids.value(pkgName, -1);
+  if (id == -1) return QString();
+
+  return m_nodes.at(id).shortDesc;
+}
+
+/*
+ * Returns the installed size (in bytes) of the given package, or 0 if it's not installed
+ */
+qlonglong DependencyGraph::getInstalledSize(const QString &pkgName)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureInstalledUpToDate();
+
+  int id = m_ids.value(pkgName, -1);
+  if (id == -1 || !m_nodes.at(id).installed) return 0;
+
+  return m_nodes.at(id).installedSize;
+}
+
+/*
+ * Returns the dependency patterns of the given installed package (like "xbps-query -x")
+ */
+QStringList DependencyGraph::getDependsOn(const QString &pkgName)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureInstalledUpToDate();
+
+  int id = m_ids.value(pkgName, -1);
+  if (id == -1 || !m_nodes.at(id).installed) return QStringList();
+
+  return m_nodes.at(id).dependsPatterns;
+}
+
+/*
+ * Returns the dependency patterns of the given repository package (like "xbps-query -Rx")
+ */
+QStringList DependencyGraph::getRemoteDependsOn(const QString &pkgName)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureRepositoriesUpToDate(locker);
+
+  int id = m_ids.value(pkgName, -1);
+  if (id == -1 || !m_nodes.at(id).inRepository) return QStringList();
+
+  return m_nodes.at(id).repoDependsPatterns;
+}
+
+/*
+ * Returns the sorted names of the installed packages which depend on pkgName (like "xbps-query -X")
+ */
+QStringList DependencyGraph::getRequiredBy(const QString &pkgName)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureInstalledUpToDate();
+
+  QStringList res;
+  int id = m_ids.value(pkgName, -1);
+  if (id == -1) return res;
+
+  foreach(int dependent, m_nodes.at(id).requiredBy)
+  {
+    res.append(m_nodes.at(dependent).name);
+  }
+
+  res.sort();
+  return res;
+}
+
+/*
+ * Returns the set of packages the user installed explicitly, the same list "xbps-query -m" prints
+ */
+QSet<QString>* DependencyGraph::getUnrequiredPackageList()
+{
+  QMutexLocker locker(&m_mutex);
+  ensureInstalledUpToDate();
+
+  QSet<QString>* res = new QSet<QString>();
+
+  for (int id = 0; id < m_nodes.count(); ++id)
+  {
+    if (m_nodes.at(id).installed && !m_nodes.at(id).automatic)
+      res->insert(m_nodes.at(id).name);
+  }
+
+  return res;
+}
+
+/*
+ * Returns the sorted list of packages "xbps-remove -R" would remove for the given targets:
+ * the targets themselves plus every automatically installed dependency which would be left
+ * with no dependent outside of that list
+ */
+QStringList DependencyGraph::getRemovalClosure(const QStringList &targets)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureInstalledUpToDate();
+
+  QSet<int> closure;
+  QList<int> pending;
+
+  foreach(QString target, targets)
+  {
+    int id = m_ids.value(target, -1);
+    if (id != -1 && m_nodes.at(id).installed && !closure.contains(id))
+    {
+      closure.insert(id);
+      pending.append(id);
+    }
+  }
+
+  //A dependency rejected now may become an orphan when another one joins the closure later
+  bool grew = true;
+  while (grew)
+  {
+    grew = false;
+
+    for (int i = 0; i < pending.count(); ++i)
+    {
+      foreach(int dep, m_nodes.at(pending.at(i)).depends)
+      {
+        if (closure.contains(dep) || !m_nodes.at(dep).automatic) continue;
+
+        bool orphan = true;
+        foreach(int dependent, m_nodes.at(dep).requiredBy)
+        {
+          if (!closure.contains(dependent))
+          {
+            orphan = false;
+            break;
+          }
+        }
+
+        if (orphan)
+        {
+          closure.insert(dep);
+          pending.append(dep);
+          grew = true;
+        }
+      }
+    }
+  }
+
+  QStringList res;
+  foreach(int id, closure)
+  {
+    res.append(m_nodes.at(id).name);
+  }
+
+  res.sort();
+  return res;
+}
+
+/*
+ * Returns what "xbps-install -f" would bring for the given targets: the targets themselves plus
+ * every repository dependency not yet installed, with their total download and installed sizes
+ */
+DependencyGraph::InstallClosure DependencyGraph::getInstallClosure(const QStringList &targets)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureInstalledUpToDate();
+  ensureRepositoriesUpToDate(locker);
+
+  InstallClosure res;
+  QSet<int> closure;
+  QList<int> pending;
+  res.complete = true;
+
+  foreach(QString target, targets)
+  {
+    int id = m_ids.value(target, -1);
+    if (id == -1 || !m_nodes.at(id).inRepository)
+    {
+      res.complete = false;
+      continue;
+    }
+
+    if (!closure.contains(id))
+    {
+      closure.insert(id);
+      pending.append(id);
+    }
+  }
+
+  for (int i = 0; i < pending.count(); ++i)
+  {
+    foreach(int dep, m_nodes.at(pending.at(i)).repoDepends)
+    {
+      if (closure.contains(dep) || m_nodes.at(dep).installed) continue;
+
+      closure.insert(dep);
+      pending.append(dep);
+    }
+  }
+
+  foreach(int id, closure)
+  {
+    const Node &node = m_nodes.at(id);
+    res.packages.append(node.name);
+    res.downloadSize += node.repoDownloadSize;
+    res.installedSizeDelta += node.repoInstalledSize - (node.installed ? node.installedSize : 0);
+  }
+
+  res.packages.sort();
+  return res;
+}
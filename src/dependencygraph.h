@@ -0,0 +1,129 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef DEPENDENCYGRAPH_H
+#define DEPENDENCYGRAPH_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+/*
+ * Forward and reverse dependency graph of XBPS packages.
+ *
+ * It is built from the installed package database (pkgdb) and from the repository indexes,
+ * without spawning any xbps-query. Every package gets an integer id and its edges are kept
+ * in adjacency arrays of ids. The installed part is updated incrementally whenever pkgdb
+ * changes on disk (after a transaction), touching only packages whose pkgver changed.
+ */
+
+class DependencyGraph
+{
+public:
+  struct InstallClosure
+  {
+    InstallClosure(): complete(false), downloadSize(0), installedSizeDelta(0) {}
+
+    bool complete;                //false when some target isn't in any repository index
+    QStringList packages;         //targets plus the dependencies which are not installed
+    qlonglong downloadSize;       //in bytes
+    qlonglong installedSizeDelta; //in bytes, may be negative
+  };
+
+private:
+  struct Node
+  {
+    Node(): installed(false), automatic(false), inRepository(false),
+      installedSize(0), repoInstalledSize(0), repoDownloadSize(0) {}
+
+    QString name;
+    bool installed;
+    bool automatic;
+    bool inRepository;
+    QString pkgver;
+    QString shortDesc;               //short_desc of the installed package
+    QString repoPkgver;
+    qlonglong installedSize;
+    qlonglong repoInstalledSize;
+    qlonglong repoDownloadSize;
+    QStringList dependsPatterns;     //run_depends of the installed package
+    QStringList repoDependsPatterns; //run_depends of the repository package
+    QVector<int> depends;            //installed package -> what it needs
+    QVector<int> requiredBy;         //installed package <- who needs it
+    QVector<int> repoDepends;        //repository package -> what it needs
+  };
+
+  QVector<Node> m_nodes;
+  QHash<QString, int> m_ids;
+  QHash<QString, int> m_installedProviders; //virtual package name -> installed provider
+  QHash<QString, int> m_repoProviders;      //virtual package name -> repository provider
+
+  QString m_pkgdbFile;
+  QDateTime m_pkgdbModified;
+  bool m_hasPkgdb;
+  QHash<QString, QDateTime> m_repodataModified;
+  bool m_hasRepoIndex;
+  bool m_loadingRepositories;
+
+  mutable QMutex m_mutex;
+
+  DependencyGraph();
+
+  int nodeId(const QString &pkgName);
+  int resolveInstalled(const QString &pattern) const;
+  int resolveRepository(const QString &pattern) const;
+  void linkInstalled(int id);
+  void unlinkInstalled(int id);
+
+  void ensureInstalledUpToDate();
+  void ensureRepositoriesUpToDate(QMutexLocker &locker);
+  void loadPkgdb(const QVariantMap &pkgdb);
+  void loadRepositoryIndex(const QVariantMap &index);
+
+  static QStringList toStringList(const QVariant &value);
+  static QStringList getConfiguredRepositories();
+
+public:
+  static DependencyGraph* instance();
+  static QString getNameFromPattern(const QString &pattern);
+  static QStringList getRepodataFiles();
+
+  bool hasPackageDatabase();
+  bool hasRepositoryIndex();
+  bool isInstalled(const QString &pkgName);
+  QDateTime getPackageDatabaseModified();
+  QHash<QString, QString> getInstalledPackageVersions();
+  QString getShortDescription(const QString &pkgName);
+  qlonglong getInstalledSize(const QString &pkgName);
+
+  QStringList getDependsOn(const QString &pkgName);
+  QStringList getRemoteDependsOn(const QString &pkgName);
+  QStringList getRequiredBy(const QString &pkgName);
+  QSet<QString>* getUnrequiredPackageList();
+  QStringList getRemovalClosure(const QStringList &targets);
+  InstallClosure getInstallClosure(const QStringList &targets);
+};
+
+#endif // DEPENDENCYGRAPH_H
@@ -0,0 +1,154 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "diagnosticsdialog.h"
+#include "processaccounting.h"
+#include "stallwatchdog.h"
+#include "strconstants.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+DiagnosticsDialog::DiagnosticsDialog(QWidget *parent) :
+  QDialog(parent)
+{
+  QStringList hhl;
+  hhl << StrConstants::getCommand() << StrConstants::getCount() << StrConstants::getTotalTime()
+      << StrConstants::getAverageTime() << StrConstants::getMaxTime() << StrConstants::getFailures()
+      << StrConstants::getBytesRead();
+
+  m_lblSummary = new QLabel(this);
+  m_twStatistics = new QTableWidget(0, hhl.count(), this);
+  m_twStatistics->setHorizontalHeaderLabels(hhl);
+  m_twStatistics->horizontalHeader()->setDefaultAlignment(Qt::AlignLeft);
+  m_twStatistics->horizontalHeader()->setStretchLastSection(true);
+  m_twStatistics->verticalHeader()->hide();
+  m_twStatistics->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_twStatistics->setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_twStatistics->setColumnWidth(0, 300); //Command
+  m_twStatistics->horizontalHeader()->setSortIndicator(2, Qt::DescendingOrder); //Total time
+
+  QStringList shl;
+  shl << StrConstants::getOperation() << StrConstants::getStalls() << StrConstants::getTotalTime()
+      << StrConstants::getMaxTime();
+
+  m_lblStalls = new QLabel(this);
+  m_twStalls = new QTableWidget(0, shl.count(), this);
+  m_twStalls->setHorizontalHeaderLabels(shl);
+  m_twStalls->horizontalHeader()->setDefaultAlignment(Qt::AlignLeft);
+  m_twStalls->horizontalHeader()->setStretchLastSection(true);
+  m_twStalls->verticalHeader()->hide();
+  m_twStalls->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_twStalls->setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_twStalls->setColumnWidth(0, 300); //Operation
+
+  QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+  QPushButton *refreshButton = buttonBox->addButton(QDialogButtonBox::Retry);
+  refreshButton->setText(StrConstants::getRefresh());
+  connect(refreshButton, SIGNAL(clicked()), this, SLOT(refresh()));
+  connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addWidget(m_lblSummary);
+  layout->addWidget(m_twStatistics, 2);
+  layout->addWidget(m_lblStalls);
+  layout->addWidget(m_twStalls, 1);
+  layout->addWidget(buttonBox);
+
+  setWindowTitle(StrConstants::getHelpDiagnostics());
+  resize(850, 600);
+  refresh();
+}
+
+/*
+ * Reloads the table with the current totals of ProcessAccounting
+ */
+void DiagnosticsDialog::refresh()
+{
+  QList<ProcessStatistics> statistics = ProcessAccounting::getStatistics();
+
+  m_lblSummary->setText(StrConstants::getDiagnosticsSummary(ProcessAccounting::getProcessCount(),
+                                                             ProcessAccounting::getTotalTime()));
+  m_twStatistics->setSortingEnabled(false);
+  m_twStatistics->setRowCount(statistics.count());
+
+  for(int row=0; row < statistics.count(); row++)
+  {
+    const ProcessStatistics &stats = statistics.at(row);
+    QList<qlonglong> values;
+    values << stats.count << stats.totalTime << (stats.totalTime / stats.count) << stats.maxTime
+           << stats.failures << stats.bytesRead;
+
+    m_twStatistics->setItem(row, 0, new QTableWidgetItem(stats.command));
+
+    for(int col=0; col < values.count(); col++)
+    {
+      //Numbers go in as data, so sorting by these columns is numeric
+      QTableWidgetItem *item = new QTableWidgetItem();
+      item->setData(Qt::DisplayRole, values.at(col));
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      m_twStatistics->setItem(row, col+1, item);
+    }
+  }
+
+  m_twStatistics->setSortingEnabled(true);
+  refreshStalls();
+}
+
+/*
+ * Reloads the GUI stalls seen by StallWatchdog, the worst operations first
+ */
+void DiagnosticsDialog::refreshStalls()
+{
+  QList<OperationStalls> operations = StallWatchdog::getOperationStatistics();
+
+  if (StallWatchdog::isWatching())
+  {
+    StallStatistics stats = StallWatchdog::getStatistics();
+    m_lblStalls->setText(StrConstants::getStallSummary(stats.count, stats.p50, stats.p99, stats.maxTime));
+  }
+  else
+  {
+    m_lblStalls->setText(StrConstants::getStallWatchdogOff());
+  }
+
+  m_twStalls->setRowCount(operations.count());
+
+  for(int row=0; row < operations.count(); row++)
+  {
+    const OperationStalls &stalls = operations.at(row);
+    QList<qlonglong> values;
+    values << stalls.count << stalls.totalTime << stalls.maxTime;
+
+    m_twStalls->setItem(row, 0, new QTableWidgetItem(stalls.operation));
+
+    for(int col=0; col < values.count(); col++)
+    {
+      QTableWidgetItem *item = new QTableWidgetItem();
+      item->setData(Qt::DisplayRole, values.at(col));
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      m_twStalls->setItem(row, col+1, item);
+    }
+  }
+}
@@ -0,0 +1,51 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+
+class QLabel;
+class QTableWidget;
+
+/*
+ * Dialog which shows the commands we spawned, the most expensive ones first, and the GUI stalls
+ */
+class DiagnosticsDialog : public QDialog
+{
+  Q_OBJECT
+
+private:
+  QLabel *m_lblSummary;
+  QTableWidget *m_twStatistics;
+  QLabel *m_lblStalls;
+  QTableWidget *m_twStalls;
+
+  void refreshStalls();
+
+private slots:
+  void refresh();
+
+public:
+  explicit DiagnosticsDialog(QWidget *parent = 0);
+};
+
+#endif // DIAGNOSTICSDIALOG_H
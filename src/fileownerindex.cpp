@@ -0,0 +1,388 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "fileownerindex.h"
+#include "constants.h"
+#include "dependencygraph.h"
+#include "xbpsplist.h"
+
+#include <QDir>
+#include <QMutexLocker>
+#include <QPair>
+#include <QSaveFile>
+#include <QSet>
+#include <QVector>
+
+#include <algorithm>
+#include <cstring>
+
+const quint32 ctn_FILE_OWNER_INDEX_MAGIC = 0x4f58464f; //"OXFO"
+const quint32 ctn_FILE_OWNER_INDEX_VERSION = 1;
+
+/*
+ * The index is mapped at the first lookup
+ */
+FileOwnerIndex::FileOwnerIndex()
+{
+  m_data = 0;
+  m_size = 0;
+}
+
+FileOwnerIndex::~FileOwnerIndex()
+{
+  unmap();
+}
+
+/*
+ * Returns the single index instance
+ */
+FileOwnerIndex* FileOwnerIndex::instance()
+{
+  static FileOwnerIndex index;
+  return &index;
+}
+
+/*
+ * Path of the file in which the index is saved
+ */
+QString FileOwnerIndex::getIndexFileName()
+{
+  return ctn_OCTOXBPS_CACHE_DIR + QDir::separator() + "file-owners.idx";
+}
+
+const FileOwnerIndex::Header* FileOwnerIndex::header() const
+{
+  return reinterpret_cast<const Header *>(m_data);
+}
+
+const FileOwnerIndex::PackageRecord* FileOwnerIndex::packages() const
+{
+  return reinterpret_cast<const PackageRecord *>(m_data + header()->packagesOffset);
+}
+
+const FileOwnerIndex::EntryRecord* FileOwnerIndex::entries() const
+{
+  return reinterpret_cast<const EntryRecord *>(m_data + header()->entriesOffset);
+}
+
+QByteArray FileOwnerIndex::getString(quint32 offset, quint32 length) const
+{
+  return QByteArray(reinterpret_cast<const char *>(m_data + header()->stringsOffset + offset), length);
+}
+
+/*
+ * Compares the path of the given entry with "path", byte by byte (the order the table is sorted)
+ */
+int FileOwnerIndex::compare(const EntryRecord &entry, const QByteArray &path) const
+{
+  const char *entryPath = reinterpret_cast<const char *>(m_data + header()->stringsOffset + entry.pathOffset);
+  int res = memcmp(entryPath, path.constData(), qMin(entry.pathLength, quint32(path.size())));
+
+  if (res != 0) return res;
+  return int(entry.pathLength) - path.size();
+}
+
+/*
+ * Returns the position of the first entry whose path is not less than "path"
+ */
+int FileOwnerIndex::lowerBound(const QByteArray &path) const
+{
+  int first = 0;
+  int count = header()->entryCount;
+
+  while (count > 0)
+  {
+    int step = count / 2;
+    if (compare(entries()[first + step], path) < 0)
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else count = step;
+  }
+
+  return first;
+}
+
+/*
+ * Returns true if the string at the given offset and length lies inside the strings table
+ */
+bool FileOwnerIndex::isStringInside(quint32 offset, quint32 length) const
+{
+  return qint64(offset) + qint64(length) <= qint64(header()->stringsSize);
+}
+
+/*
+ * Checks the mapped tables fit inside the file and every string and package they refer to
+ * is really there, so a truncated or stale index is never read past its end
+ */
+bool FileOwnerIndex::isValid() const
+{
+  const Header *h = header();
+
+  if (h->magic != ctn_FILE_OWNER_INDEX_MAGIC || h->version != ctn_FILE_OWNER_INDEX_VERSION ||
+      qint64(h->packagesOffset) + qint64(h->packageCount) * sizeof(PackageRecord) > m_size ||
+      qint64(h->entriesOffset) + qint64(h->entryCount) * sizeof(EntryRecord) > m_size ||
+      qint64(h->stringsOffset) + qint64(h->stringsSize) > m_size)
+    return false;
+
+  for (quint32 i = 0; i < h->packageCount; ++i)
+  {
+    const PackageRecord &pkg = packages()[i];
+
+    if (!isStringInside(pkg.nameOffset, pkg.nameLength) || !isStringInside(pkg.pkgverOffset, pkg.pkgverLength))
+      return false;
+  }
+
+  for (quint32 i = 0; i < h->entryCount; ++i)
+  {
+    const EntryRecord &entry = entries()[i];
+
+    if (!isStringInside(entry.pathOffset, entry.pathLength) || entry.package >= h->packageCount)
+      return false;
+  }
+
+  return true;
+}
+
+/*
+ * Maps the saved index. An invalid one is left unmapped, so ensureUpToDate() builds it again
+ */
+bool FileOwnerIndex::map()
+{
+  m_file.setFileName(getIndexFileName());
+  if (!m_file.open(QIODevice::ReadOnly)) return false;
+
+  m_size = m_file.size();
+  if (m_size >= qint64(sizeof(Header)))
+    m_data = m_file.map(0, m_size);
+
+  if (m_data != 0 && isValid()) return true;
+
+  unmap();
+  return false;
+}
+
+void FileOwnerIndex::unmap()
+{
+  if (m_data != 0)
+    m_file.unmap(const_cast<uchar *>(m_data));
+
+  m_file.close();
+  m_data = 0;
+  m_size = 0;
+}
+
+/*
+ * Reads the files, links and configuration files the given installed package owns
+ */
+QList<QByteArray> FileOwnerIndex::readFileList(const QString &pkgName)
+{
+  QList<QByteArray> res;
+  QVariant filesPlist = XBPSPlist::parseFile(
+        ctn_XBPS_DATABASE_DIR + QDir::separator() + "." + pkgName + "-files.plist");
+
+  foreach(QString path, XBPSPlist::getFileList(filesPlist))
+  {
+    res.append(path.toUtf8());
+  }
+
+  return res;
+}
+
+/*
+ * Writes a new index for the given installed packages. Paths of packages whose pkgver didn't change
+ * are taken from the current index, so only the changed ones have their "files.plist" read
+ */
+void FileOwnerIndex::rebuild(const QDateTime &pkgdbModified, const QHash<QString, QString> &installed)
+{
+  QHash<QString, QList<QByteArray> > filesOf;
+  QSet<QString> kept;
+
+  if (m_data != 0)
+  {
+    QVector<QString> oldNames(header()->packageCount);
+
+    for (quint32 i = 0; i < header()->packageCount; ++i)
+    {
+      const PackageRecord &pkg = packages()[i];
+      QString name = QString::fromUtf8(getString(pkg.nameOffset, pkg.nameLength));
+      QString pkgver = QString::fromUtf8(getString(pkg.pkgverOffset, pkg.pkgverLength));
+
+      if (installed.value(name) == pkgver)
+      {
+        oldNames[i] = name;
+        kept.insert(name);
+        filesOf.insert(name, QList<QByteArray>());
+      }
+    }
+
+    for (quint32 i = 0; i < header()->entryCount; ++i)
+    {
+      const EntryRecord &entry = entries()[i];
+      if (oldNames.at(entry.package).isEmpty()) continue;
+
+      filesOf[oldNames.at(entry.package)].append(getString(entry.pathOffset, entry.pathLength));
+    }
+  }
+
+  QStringList names = installed.keys();
+  names.sort();
+
+  foreach(QString name, names)
+  {
+    if (!kept.contains(name))
+      filesOf.insert(name, readFileList(name));
+  }
+
+  //Now we have all we need, let's lay the tables out
+  QByteArray strings;
+  QVector<PackageRecord> packageTable;
+  QVector<QPair<QByteArray, quint32> > paths;
+
+  for (int i = 0; i < names.count(); ++i)
+  {
+    QByteArray name = names.at(i).toUtf8();
+    QByteArray pkgver = installed.value(names.at(i)).toUtf8();
+
+    PackageRecord pkg;
+    pkg.nameOffset = strings.size();
+    pkg.nameLength = name.size();
+    strings.append(name);
+    pkg.pkgverOffset = strings.size();
+    pkg.pkgverLength = pkgver.size();
+    strings.append(pkgver);
+    packageTable.append(pkg);
+
+    foreach(QByteArray path, filesOf.value(names.at(i)))
+    {
+      paths.append(qMakePair(path, quint32(i)));
+    }
+  }
+
+  std::sort(paths.begin(), paths.end());
+
+  QVector<EntryRecord> entryTable;
+  entryTable.reserve(paths.count());
+
+  for (int i = 0; i < paths.count(); ++i)
+  {
+    EntryRecord entry;
+    entry.pathOffset = strings.size();
+    entry.pathLength = paths.at(i).first.size();
+    entry.package = paths.at(i).second;
+    strings.append(paths.at(i).first);
+    entryTable.append(entry);
+  }
+
+  Header h;
+  h.magic = ctn_FILE_OWNER_INDEX_MAGIC;
+  h.version = ctn_FILE_OWNER_INDEX_VERSION;
+  h.packageCount = packageTable.count();
+  h.entryCount = entryTable.count();
+  h.pkgdbModified = pkgdbModified.toMSecsSinceEpoch();
+  h.packagesOffset = sizeof(Header);
+  h.entriesOffset = h.packagesOffset + packageTable.count() * sizeof(PackageRecord);
+  h.stringsOffset = h.entriesOffset + entryTable.count() * sizeof(EntryRecord);
+  h.stringsSize = strings.size();
+
+  unmap();
+  QDir().mkpath(ctn_OCTOXBPS_CACHE_DIR);
+
+  //QSaveFile only replaces the old index when the new one is completely written
+  QSaveFile file(getIndexFileName());
+  if (!file.open(QIODevice::WriteOnly)) return;
+
+  file.write(reinterpret_cast<const char *>(&h), sizeof(Header));
+  file.write(reinterpret_cast<const char *>(packageTable.constData()), packageTable.count() * sizeof(PackageRecord));
+  file.write(reinterpret_cast<const char *>(entryTable.constData()), entryTable.count() * sizeof(EntryRecord));
+  file.write(strings);
+
+  if (file.commit()) map();
+}
+
+/*
+ * Rebuilds the index whenever pkgdb changed since it was written (a transaction happened)
+ */
+void FileOwnerIndex::ensureUpToDate()
+{
+  DependencyGraph *graph = DependencyGraph::instance();
+  QDateTime pkgdbModified = graph->getPackageDatabaseModified();
+  if (!pkgdbModified.isValid()) return;
+
+  if (m_data == 0) map();
+  if (m_data != 0 && header()->pkgdbModified == pkgdbModified.toMSecsSinceEpoch()) return;
+
+  rebuild(pkgdbModified, graph->getInstalledPackageVersions());
+}
+
+/*
+ * Returns true if the index could be mapped (or built)
+ */
+bool FileOwnerIndex::isAvailable()
+{
+  QMutexLocker locker(&m_mutex);
+  ensureUpToDate();
+
+  return m_data != 0;
+}
+
+/*
+ * Returns the name of the installed package which owns the given absolute path, or an empty string
+ */
+QString FileOwnerIndex::getOwner(const QString &filePath)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureUpToDate();
+
+  if (m_data == 0) return "";
+
+  QByteArray path = filePath.toUtf8();
+  int pos = lowerBound(path);
+
+  if (pos >= int(header()->entryCount) || compare(entries()[pos], path) != 0) return "";
+
+  const PackageRecord &pkg = packages()[entries()[pos].package];
+  return QString::fromUtf8(getString(pkg.nameOffset, pkg.nameLength));
+}
+
+/*
+ * Returns up to maxCount installed paths which start with the given prefix, in alphabetical order
+ */
+QStringList FileOwnerIndex::getPathsStartingWith(const QString &prefix, int maxCount)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureUpToDate();
+
+  QStringList res;
+  if (m_data == 0 || prefix.isEmpty()) return res;
+
+  QByteArray path = prefix.toUtf8();
+
+  for (int pos = lowerBound(path); pos < int(header()->entryCount) && res.count() < maxCount; ++pos)
+  {
+    QByteArray candidate = getString(entries()[pos].pathOffset, entries()[pos].pathLength);
+    if (!candidate.startsWith(path)) break;
+
+    res.append(QString::fromUtf8(candidate));
+  }
+
+  return res;
+}
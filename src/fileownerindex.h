@@ -0,0 +1,104 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef FILEOWNERINDEX_H
+#define FILEOWNERINDEX_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+/*
+ * Index of every file installed by XBPS and the package which owns it (what "xbps-query -o" answers).
+ *
+ * It's built from the "files.plist" metadata of the installed packages and saved in
+ * ctn_OCTOXBPS_CACHE_DIR as a path-sorted table, which is memory mapped and binary searched.
+ * When pkgdb changes, only the file lists of packages whose pkgver changed are read again.
+ */
+
+class FileOwnerIndex
+{
+private:
+  struct Header
+  {
+    quint32 magic;
+    quint32 version;
+    quint32 packageCount;
+    quint32 entryCount;
+    qint64 pkgdbModified;   //msecs since epoch
+    quint32 packagesOffset; //PackageRecord[packageCount]
+    quint32 entriesOffset;  //EntryRecord[entryCount], sorted by path
+    quint32 stringsOffset;
+    quint32 stringsSize;
+  };
+
+  struct PackageRecord
+  {
+    quint32 nameOffset;
+    quint32 nameLength;
+    quint32 pkgverOffset;
+    quint32 pkgverLength;
+  };
+
+  struct EntryRecord
+  {
+    quint32 pathOffset;
+    quint32 pathLength;
+    quint32 package;
+  };
+
+  QFile m_file;
+  const uchar *m_data;
+  qint64 m_size;
+  QMutex m_mutex;
+
+  FileOwnerIndex();
+  ~FileOwnerIndex();
+
+  const Header* header() const;
+  const PackageRecord* packages() const;
+  const EntryRecord* entries() const;
+  QByteArray getString(quint32 offset, quint32 length) const;
+  int compare(const EntryRecord &entry, const QByteArray &path) const;
+  int lowerBound(const QByteArray &path) const;
+  bool isStringInside(quint32 offset, quint32 length) const;
+  bool isValid() const;
+
+  void ensureUpToDate();
+  bool map();
+  void unmap();
+  void rebuild(const QDateTime &pkgdbModified, const QHash<QString, QString> &installed);
+
+  static QString getIndexFileName();
+  static QList<QByteArray> readFileList(const QString &pkgName);
+
+public:
+  static FileOwnerIndex* instance();
+
+  bool isAvailable();
+  QString getOwner(const QString &filePath);
+  QStringList getPathsStartingWith(const QString &prefix, int maxCount);
+};
+
+#endif // FILEOWNERINDEX_H
@@ -20,9 +20,25 @@
 
 #include "globals.h"
 #include "mainwindow.h"
+#include "daemonclient.h"
+#include "dependencygraph.h"
+#include "fileownerindex.h"
+#include "packagecacheindex.h"
+#include "packagestatecache.h"
+#include "searchindex.h"
+#include "tracer.h"
 
+#include <QCoreApplication>
+#include <QFileInfo>
 #include <QFutureWatcher>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QThreadPool>
 #include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
 
 /*
  * Global functions related to OctoPkg's multithread code
@@ -30,7 +46,7 @@
 
 QFutureWatcher<QString> g_fwToolTip;
 QFutureWatcher<QString> g_fwToolTipInfo;
-QFutureWatcher<QList<PackageListData> *> g_fwPacman;
+QFutureWatcher<PackageListSnapshot> g_fwPackageListSnapshot;
 QFutureWatcher<QList<PackageListData> *> g_fwForeignPacman;
 QFutureWatcher<GroupMemberPair>          g_fwPacmanGroup;
 QFutureWatcher<QList<PackageListData> *> g_fwRemote;
@@ -38,16 +54,29 @@ QFutureWatcher<QList<PackageListData> *> g_fwRemoteMeta;
 QFutureWatcher<AUROutdatedPackages *> g_fwOutdatedAURPackages;
 QFutureWatcher<QString> g_fwDistroNews;
 QFutureWatcher<QString> g_fwPackageOwnsFile;
-QFutureWatcher<QMap<QString, OutdatedPackageInfo> *> g_fwOutdatedList;
 QFutureWatcher<QList<PackageListData> *> g_fwMarkForeignPackages;
-QFutureWatcher<QSet<QString> *> g_fwUnrequiredPacman;
 QFutureWatcher<TransactionInfo> g_fwTargetUpgradeList;
+QFutureWatcher<RemovalClosure> g_fwRemovalClosure;
+QFutureWatcher<RemovalClosure> g_fwRemovalVerification;
+QFutureWatcher<InstallClosureInfo> g_fwInstallClosure;
+QFutureWatcher<InstallClosureInfo> g_fwInstallVerification;
+QFutureWatcher<QStringList> g_fwFilePathSuggestions;
+QFutureWatcher<InstalledPackagesState> g_fwInstalledPackages;
+QAtomicInt g_filePathSuggestionsGeneration;
+
+static QHash<QString, QString> s_packageInfoCache;
+static QMutex s_packageInfoCacheMutex;
 
 /*
  * Given a packageName, returns its description
  */
 QString showPackageInfo(QString pkgName)
 {
+  QString desc;
+
+  if (findCachedPackageInfo(pkgName, desc))
+    return desc;
+
   MainWindow *mw = MainWindow::returnMainWindow();
   const PackageRepository::PackageData*const package = mw->getFirstPackageFromRepo(pkgName);
 
@@ -57,30 +86,63 @@ QString showPackageInfo(QString pkgName)
 
   QString description = package->comment.trimmed();
 
-  if (description.isEmpty())
+  if (!description.isEmpty())
   {
-    return "";
-  }
+    int space = description.indexOf(" ");
+    desc = description.mid(space+1).trimmed();
+    int size = desc.size();
 
-  int space = description.indexOf(" ");
-  QString desc = description.mid(space+1).trimmed();
-  int size = desc.size();
-
-  if (desc.size() > 120)
-  {
-    desc.chop(size - 120);
-    desc = desc + " ...";
+    if (desc.size() > 120)
+    {
+      desc.chop(size - 120);
+      desc = desc + " ...";
+    }
   }
 
+  QMutexLocker locker(&s_packageInfoCacheMutex);
+  s_packageInfoCache.insert(pkgName, desc);
+
   return desc;
 }
 
+/*
+ * Returns true (and the description in "info") if showPackageInfo() already formatted it
+ */
+bool findCachedPackageInfo(const QString &pkgName, QString &info)
+{
+  QMutexLocker locker(&s_packageInfoCacheMutex);
+
+  QHash<QString, QString>::const_iterator it = s_packageInfoCache.constFind(pkgName);
+  if (it == s_packageInfoCache.constEnd()) return false;
+
+  info = it.value();
+  return true;
+}
+
+/*
+ * Forgets every formatted description. Called whenever the package list is rebuilt
+ */
+void clearPackageInfoCache()
+{
+  QMutexLocker locker(&s_packageInfoCacheMutex);
+  s_packageInfoCache.clear();
+}
+
+/*
+ * Forgets the formatted description of the given package, which changed on disk
+ */
+void clearPackageInfoCache(const QString &pkgName)
+{
+  QMutexLocker locker(&s_packageInfoCacheMutex);
+  s_packageInfoCache.remove(pkgName);
+}
+
 /*
  * Starts the non blocking search for Pacman packages...
  */
 QList<PackageListData> * searchPkgPackages()
 {
-  return Package::getPackageList("");
+  return PackageStateCache::getPackageList();
 }
 
 /*
@@ -99,6 +161,189 @@ QSet<QString> *searchUnrequiredPacmanPackages()
   return Package::getUnrequiredPackageList();
 }
 
+/*
+ * Fetches the installed packages and, if "refreshAll", the unrequired and outdated ones too.
+ * Those queries don't depend on each other, so they all run at the same time and the snapshot
+ * is ready as soon as the slowest of them ends
+ */
+PackageListSnapshot loadPackageListSnapshot(bool refreshAll)
+{
+  TraceSpan span("loadPackageListSnapshot");
+  PackageListSnapshot res;
+
+  //When octoxbps-daemon is around, everything comes from its memory in a single round trip
+  if (DaemonClient::getPackageListSnapshot(res.packages, res.outdatedPackages, res.unrequiredPackages))
+  {
+    if (!refreshAll)
+    {
+      delete res.outdatedPackages;
+      delete res.unrequiredPackages;
+      res.outdatedPackages = NULL;
+      res.unrequiredPackages = NULL;
+    }
+
+    return res;
+  }
+
+  QFuture<QMap<QString, OutdatedPackageInfo> *> outdated;
+  QFuture<QSet<QString> *> unrequired;
+
+  if (refreshAll)
+  {
+    outdated = QtConcurrent::run(getOutdatedList);
+    unrequired = QtConcurrent::run(searchUnrequiredPacmanPackages);
+  }
+
+  //This thread takes the biggest query
+  res.packages = searchPkgPackages();
+
+  if (refreshAll)
+  {
+    res.outdatedPackages = outdated.result();
+    res.unrequiredPackages = unrequired.result();
+  }
+
+  return res;
+}
+
+/*
+ * Reads pkgdb (and the unrequired packages it implies) for refreshInstalledPackages(), along with
+ * the descriptions of the packages whose pkgver isn't the one in "knownVersions"
+ */
+InstalledPackagesState loadInstalledPackages(const QHash<QString, QString> &knownVersions)
+{
+  TraceSpan span("loadInstalledPackages");
+  InstalledPackagesState res;
+  DependencyGraph *graph = DependencyGraph::instance();
+
+  res.knownVersions = knownVersions;
+  if (!graph->hasPackageDatabase()) return res;
+
+  res.available = true;
+  res.versions = graph->getInstalledPackageVersions();
+
+  for (QHash<QString, QString>::const_iterator it = res.versions.constBegin(); it != res.versions.constEnd(); ++it)
+  {
+    if (knownVersions.value(it.key()) != it.value())
+      res.descriptions.insert(it.key(), graph->getShortDescription(it.key()));
+  }
+
+  res.unrequiredPackages = graph->getUnrequiredPackageList();
+  return res;
+}
+
+/*
+ * Reads the repository indexes into the dependency graph, so remote queries don't wait for it...
+ */
+void loadRepositoryIndexes()
+{
+  DependencyGraph::instance()->hasRepositoryIndex();
+  SearchIndex::instance()->isAvailable();
+}
+
+/*
+ * Maps (or builds) the installed file index, so the first search by file doesn't wait for it...
+ */
+void loadFileOwnerIndex()
+{
+  FileOwnerIndex::instance()->isAvailable();
+}
+
+/*
+ * Reads the file lists of the packages downloaded to the XBPS cache...
+ */
+void loadPackageCacheIndex()
+{
+  PackageCacheIndex::instance()->update();
+}
+
+/*
+ * Warms the indexes above one after the other in a pool of their own, so they never take
+ * the global pool threads the package list snapshot and the searches run in. Only the first call counts
+ */
+void startIndexWarmers()
+{
+  static QThreadPool *pool = NULL;
+  if (pool != NULL) return;
+
+  //It goes away (waiting for the running warmer) along with the application
+  pool = new QThreadPool(QCoreApplication::instance());
+  pool->setMaxThreadCount(1);
+  QtConcurrent::run(pool, loadRepositoryIndexes);
+  QtConcurrent::run(pool, loadFileOwnerIndex);
+  QtConcurrent::run(pool, loadPackageCacheIndex);
+}
+
+/*
+ * Computes the recursive removal list of the given packages using the dependency graph...
+ */
+RemovalClosure getRemovalClosure(const QString &listOfTargets)
+{
+  QStringList targets = listOfTargets.split(" ", QString::SkipEmptyParts);
+
+  if (!DependencyGraph::instance()->hasPackageDatabase())
+    return verifyRemovalClosure(listOfTargets);
+
+  RemovalClosure res;
+  res.targets = listOfTargets;
+  res.packages = DependencyGraph::instance()->getRemovalClosure(targets);
+
+  return res;
+}
+
+/*
+ * Asks "xbps-remove -R -n" for the recursive removal list of the given packages...
+ */
+RemovalClosure verifyRemovalClosure(const QString &listOfTargets)
+{
+  QStringList *targets = Package::getTargetRemovalList(listOfTargets);
+  RemovalClosure res;
+  res.targets = listOfTargets;
+  res.packages = *targets;
+  delete targets;
+
+  return res;
+}
+
+/*
+ * Computes the install list and the download/installed sizes of the given packages using the
+ * dependency graph. When some target is not found in the repository indexes, we ask "xbps-install -n"
+ */
+InstallClosureInfo getInstallClosure(const QString &listOfTargets)
+{
+  QStringList targets = listOfTargets.split(" ", QString::SkipEmptyParts);
+  DependencyGraph::InstallClosure closure;
+
+  if (DependencyGraph::instance()->hasRepositoryIndex())
+    closure = DependencyGraph::instance()->getInstallClosure(targets);
+
+  if (!closure.complete)
+    return verifyInstallClosure(listOfTargets);
+
+  InstallClosureInfo res;
+  res.targets = listOfTargets;
+  res.info.packages = new QStringList(closure.packages);
+  res.info.downloadBytes = closure.downloadSize;
+  res.info.installedBytesDelta = closure.installedSizeDelta;
+  res.info.sizeToDownload = Package::bytesToSize(closure.downloadSize);
+  res.info.sizeToInstall = Package::bytesToSize(closure.installedSizeDelta);
+
+  return res;
+}
+
+/*
+ * Asks "xbps-install -n" for the install list and sizes of the given packages...
+ */
+InstallClosureInfo verifyInstallClosure(const QString &listOfTargets)
+{
+  InstallClosureInfo res;
+  res.targets = listOfTargets;
+  res.info = Package::getTargetUpgradeList(listOfTargets);
+  res.verified = true;
+
+  return res;
+}
+
 /*
  * Starts the non blocking search for a Pacman package that owns the given file...
  */
@@ -108,7 +353,25 @@ QString searchPacmanPackagesByFile(const QString &file)
 
   if (!file.isEmpty())
   {
-    result = UnixCommand::getPackageByFilePath(file);
+    //The file index knows exact paths; patterns and relative names are still left to "xbps-query -o"
+    if (file.startsWith("/") && !file.contains(QRegularExpression("[*?\\[]")) &&
+        FileOwnerIndex::instance()->isAvailable())
+    {
+      result = FileOwnerIndex::instance()->getOwner(file);
+
+      if (result.isEmpty())
+      {
+        QString canonicalFile = QFileInfo(file).canonicalFilePath();
+        if (!canonicalFile.isEmpty() && canonicalFile != file)
+          result = FileOwnerIndex::instance()->getOwner(canonicalFile);
+      }
+
+      //Not installed, but maybe some package in the XBPS cache ships it
+      if (result.isEmpty())
+        result = PackageCacheIndex::instance()->getOwner(file);
+    }
+    else
+      result = UnixCommand::getPackageByFilePath(file);
   }
   else
     result = "";
@@ -116,6 +379,46 @@ QString searchPacmanPackagesByFile(const QString &file)
   return result;
 }
 
+/*
+ * Orders path suggestions the way they're most useful: the ones closer to the typed prefix
+ * (fewer directory levels, then shorter) come first
+ */
+static bool isBetterPathSuggestion(const QString &path1, const QString &path2)
+{
+  int depth1 = path1.count('/');
+  int depth2 = path2.count('/');
+
+  if (depth1 != depth2) return depth1 < depth2;
+  if (path1.length() != path2.length()) return path1.length() < path2.length();
+  return path1 < path2;
+}
+
+/*
+ * Retrieves file path suggestions for the "search by file" completer.
+ * Absolute prefixes are looked up in the installed file index; "slocate" is only used when
+ * the index can't help. A newer request (generation) makes this one give up before spawning it
+ */
+QStringList getFilePathSuggestions(const QString &prefix, bool hasLocate, int generation)
+{
+  const int ctn_MAX_PATH_CANDIDATES = 1000;
+  const int ctn_MAX_PATH_SUGGESTIONS = 50;
+  QStringList res;
+
+  if (prefix.startsWith("/") && FileOwnerIndex::instance()->isAvailable())
+  {
+    res = FileOwnerIndex::instance()->getPathsStartingWith(prefix, ctn_MAX_PATH_CANDIDATES);
+    std::sort(res.begin(), res.end(), isBetterPathSuggestion);
+
+    if (res.count() > ctn_MAX_PATH_SUGGESTIONS)
+      res = res.mid(0, ctn_MAX_PATH_SUGGESTIONS);
+  }
+
+  if (res.isEmpty() && hasLocate && generation == g_filePathSuggestionsGeneration.load())
+    res = UnixCommand::getFilePathSuggestions(prefix);
+
+  return res;
+}
+
 /*
  * Starts the non blocking search for Pacman packages...
  */
@@ -145,7 +448,7 @@ QString getLatestDistroNews()
  */
 QMap<QString, OutdatedPackageInfo> *getOutdatedList()
 {
-  return Package::getOutdatedStringList();
+  return PackageStateCache::getOutdatedPackages();
 }
 
 /*
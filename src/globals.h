@@ -26,6 +26,7 @@
 
 #include <QStandardItem>
 #include <QFutureWatcher>
+#include <QAtomicInt>
 
 struct AUROutdatedPackages
 {
@@ -35,27 +36,96 @@ struct AUROutdatedPackages
 
 typedef std::pair<QString, QStringList*> GroupMemberPair;
 
+/*
+ * The three lists the package view is built from, fetched together by loadPackageListSnapshot()
+ */
+struct PackageListSnapshot
+{
+  QList<PackageListData> *packages;
+  QSet<QString> *unrequiredPackages; //NULL when they weren't refreshed
+  QMap<QString, OutdatedPackageInfo> *outdatedPackages; //NULL when they weren't refreshed
+
+  PackageListSnapshot(): packages(NULL), unrequiredPackages(NULL), outdatedPackages(NULL){
+  }
+};
+
+/*
+ * The recursive removal list of the packages in the Remove queue
+ */
+struct RemovalClosure
+{
+  QString targets; //The Remove queue this list was computed for
+  QStringList packages;
+};
+
+/*
+ * The install list and sizes of the packages in the Install queue
+ */
+struct InstallClosureInfo
+{
+  QString targets; //The Install queue this list was computed for
+  TransactionInfo info;
+  bool verified;   //It already came from "xbps-install -n"
+
+  InstallClosureInfo(): verified(false){
+  }
+};
+
+/*
+ * The installed packages as pkgdb has them now, diffed by refreshInstalledPackages()
+ */
+struct InstalledPackagesState
+{
+  bool available;                         //pkgdb could be read
+  QHash<QString, QString> knownVersions;  //The pkgver of every package when the read started
+  QHash<QString, QString> versions;       //package name -> pkgver
+  QHash<QString, QString> descriptions;   //Short description of the packages whose pkgver changed
+  QSet<QString> *unrequiredPackages;
+
+  InstalledPackagesState(): available(false), unrequiredPackages(NULL){
+  }
+};
+
 extern QFutureWatcher<QString> g_fwToolTip;
 extern QFutureWatcher<QString> g_fwToolTipInfo;
-extern QFutureWatcher<QList<PackageListData> *> g_fwPacman;
+extern QFutureWatcher<PackageListSnapshot> g_fwPackageListSnapshot;
 extern QFutureWatcher<QList<PackageListData> *> g_fwForeignPacman;
-extern QFutureWatcher<QSet<QString> *> g_fwUnrequiredPacman;
 extern QFutureWatcher<GroupMemberPair>          g_fwPacmanGroup;
 extern QFutureWatcher<QList<PackageListData> *> g_fwRemote;
 extern QFutureWatcher<QList<PackageListData> *> g_fwRemoteMeta;
 //extern QFutureWatcher<QList<PackageListData> *> g_fwMarkForeignPackages;
-extern QFutureWatcher<QMap<QString, OutdatedPackageInfo> *> g_fwOutdatedList;
 extern QFutureWatcher<QString> g_fwDistroNews;
 extern QFutureWatcher<QString> g_fwPackageOwnsFile;
 extern QFutureWatcher<TransactionInfo> g_fwTargetUpgradeList;
+extern QFutureWatcher<RemovalClosure> g_fwRemovalClosure;
+extern QFutureWatcher<RemovalClosure> g_fwRemovalVerification;
+extern QFutureWatcher<InstallClosureInfo> g_fwInstallClosure;
+extern QFutureWatcher<InstallClosureInfo> g_fwInstallVerification;
+extern QFutureWatcher<QStringList> g_fwFilePathSuggestions;
+extern QFutureWatcher<InstalledPackagesState> g_fwInstalledPackages;
+extern QAtomicInt g_filePathSuggestionsGeneration;
 
 QString showPackageInfo(QString pkgName);
+bool findCachedPackageInfo(const QString &pkgName, QString &info);
+void clearPackageInfoCache();
+void clearPackageInfoCache(const QString &pkgName);
 TransactionInfo getTargetUpgradeList(const QString &pkgName);
 QList<PackageListData> * searchPkgPackages();
 QSet<QString> * searchUnrequiredPacmanPackages();
+PackageListSnapshot loadPackageListSnapshot(bool refreshAll);
+InstalledPackagesState loadInstalledPackages(const QHash<QString, QString> &knownVersions);
+void loadRepositoryIndexes();
+void loadFileOwnerIndex();
+void loadPackageCacheIndex();
+void startIndexWarmers();
+RemovalClosure getRemovalClosure(const QString &listOfTargets);
+RemovalClosure verifyRemovalClosure(const QString &listOfTargets);
+InstallClosureInfo getInstallClosure(const QString &listOfTargets);
+InstallClosureInfo verifyInstallClosure(const QString &listOfTargets);
 QList<PackageListData> * searchForeignPackages();
 QList<PackageListData> * searchRemotePackages(QString searchString);
 QString searchPacmanPackagesByFile(const QString &file);
+QStringList getFilePathSuggestions(const QString &prefix, bool hasLocate, int generation);
 GroupMemberPair          searchPacmanPackagesFromGroup(QString groupName);
 QMap<QString, OutdatedPackageInfo> * getOutdatedList();
 QString getLatestDistroNews();
@@ -23,6 +23,10 @@
 #include "strconstants.h"
 #include "unixcommand.h"
 #include "wmhelper.h"
+#include "queryrecorder.h"
+#include "tracer.h"
+#include "processaccounting.h"
+#include "stallwatchdog.h"
 #include <iostream>
 
 #include "QtSolutions/qtsingleapplication.h"
@@ -83,6 +87,44 @@ int main(int argc, char *argv[])
     return(0);
   }
 
+  //Record every xbps query into a fixture dir or replay a recorded session from there
+  QString recordDir = argList->getSwitchArg("-record", "");
+  QString replayDir = argList->getSwitchArg("-replay", "");
+  QString replayLatency = argList->getSwitchArg("-replay-latency", "");
+
+  if (!replayDir.isEmpty())
+    QueryRecorder::setReplayDir(replayDir);
+  else if (!recordDir.isEmpty())
+    QueryRecorder::setRecordDir(recordDir);
+
+  if (!replayLatency.isEmpty())
+  {
+    int latency = -1; //"recorded"
+
+    if (replayLatency != "recorded")
+    {
+      bool ok;
+      latency = replayLatency.toInt(&ok);
+
+      if (!ok || latency < 0)
+      {
+        std::cerr << StrConstants::getErrorInvalidReplayLatency().toLatin1().data() << std::endl;
+        std::cout << StrConstants::getApplicationCliHelp().toLatin1().data() << std::endl;
+        return(-1);
+      }
+    }
+
+    QueryRecorder::setReplayLatency(latency);
+  }
+
+  //Write Chrome trace-event JSON with the timing of the main code paths
+  QString traceFile = argList->getSwitchArg("-trace", "");
+  if (!traceFile.isEmpty())
+    Tracer::start(traceFile);
+
+  //Log the instrumented operations which keep the GUI event loop busy for too long
+  QString watchdogThreshold = argList->getSwitchArg("-watchdog", "");
+
   if (UnixCommand::isRootRunning() && !WMHelper::isKDERunning()){
     QMessageBox::critical( 0, StrConstants::getApplicationName(), StrConstants::getErrorRunningWithRoot());
     return ( -2 );
@@ -101,7 +143,8 @@ int main(int argc, char *argv[])
     w.setCallSystemUpgrade();
   }
 
-  if (argList->getSwitch("-d"))
+  bool debugInfo = argList->getSwitch("-d");
+  if (debugInfo)
   {
     //If user chooses to switch debug info on...
     w.turnDebugInfoOn();
@@ -119,5 +162,18 @@ int main(int argc, char *argv[])
 
   QResource::registerResource("./resources.qrc");
 
-  return app.exec();
+  if (debugInfo || !watchdogThreshold.isEmpty())
+    StallWatchdog::startWatching(watchdogThreshold.toInt());
+
+  int res = app.exec();
+  StallWatchdog::stopWatching();
+  Tracer::stop();
+
+  if (debugInfo)
+  {
+    std::cout << ProcessAccounting::getReport().toLatin1().data() << std::endl;
+    std::cout << StallWatchdog::getReport().toLatin1().data() << std::endl;
+  }
+
+  return res;
 }
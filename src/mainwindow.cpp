@@ -29,6 +29,7 @@
 #include "searchbar.h"
 #include "utils.h"
 #include "globals.h"
+#include "tracer.h"
 #include <iostream>
 
 #include <QStandardItemModel>
@@ -57,6 +58,7 @@ MainWindow::MainWindow(QWidget *parent) :
   m_indFoundFilesInPkgFileList = 0;
   m_callSystemUpgrade = false;
   m_callSystemUpgradeNoConfirm = false;
+  m_callSystemUpgradeAfterTransaction = false;
   m_initializationCompleted=false;
   m_systemUpgradeDialog = false;
   m_refreshPackageLists = false;
@@ -68,14 +70,16 @@ MainWindow::MainWindow(QWidget *parent) :
   m_numberOfInstalledPackages = 0;
   m_debugInfo = false;
   m_time = new QTime();
+  m_outdatedList = new QMap<QString, OutdatedPackageInfo>();
   m_unrequiredPackageList = NULL;
   m_foreignPackageList = NULL;
+  m_installClosure.packages = NULL;
+  m_upgradePlan.packages = NULL;
+  m_transactionBatch = false;
 
   //Here we try to speed up first pkg list build!
   //m_time->start();
 
-  retrieveUnrequiredPackageList();
-
   ui->setupUi(this);
   switchToViewAllPackages();  
 }
@@ -103,7 +107,7 @@ void MainWindow::show()
     restoreGeometry(SettingsManager::getWindowSize());
     m_commandExecuting=ectn_NONE;
     m_commandQueued=ectn_NONE;
-    m_leFilterPackage = new SearchLineEdit(this, m_hasSLocate);
+    m_leFilterPackage = new SearchLineEdit(this);
 
     setWindowTitle(StrConstants::getApplicationName());
     setMinimumSize(QSize(820, 520));
@@ -123,6 +127,7 @@ void MainWindow::show()
     initToolButtonPacman();
     //initToolButtonAUR();
     initAppIcon();
+    initPackageDatabaseWatcher();
     initMenuBar();
     initToolBar();
     initTabWidgetPropertiesIndex();
@@ -471,6 +476,14 @@ void MainWindow::setCallSystemUpgradeNoConfirm()
   m_callSystemUpgradeNoConfirm = true;
 }
 
+/*
+ * Sets a flag to call the System Upgrade action as soon as the running transaction ends
+ */
+void MainWindow::setCallSystemUpgradeAfterTransaction()
+{
+  m_callSystemUpgradeAfterTransaction = true;
+}
+
 /*
  * Sets a flag that holds the remove command to be used in transactions
  */
@@ -1096,6 +1109,7 @@ void MainWindow::maximizePropertiesTabWidget(bool pSaveSettings)
  */
 void MainWindow::headerViewPackageListSortIndicatorClicked( int col, Qt::SortOrder order )
 {
+  TraceSpan span("MainWindow::headerViewPackageListSortIndicatorClicked");
   // prevent infinite loop
   disconnect(ui->tvPackages->header(), SIGNAL(sortIndicatorChanged(int,Qt::SortOrder)), this,
              SLOT(headerViewPackageListSortIndicatorClicked(int,Qt::SortOrder)));
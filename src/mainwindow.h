@@ -27,10 +27,12 @@
 
 #include <QApplication>
 #include <QItemSelection>
+#include <QStandardItemModel>
 #include <QSystemTrayIcon>
 #include <QMainWindow>
 #include <QToolButton>
 #include <QList>
+#include <QHash>
 #include <QUrl>
 
 class QTreeView;
@@ -62,6 +64,15 @@ const int ctn_TABINDEX_OUTPUT(3);
 const int ctn_TABINDEX_NEWS(4);
 const int ctn_TABINDEX_HELPUSAGE(5);
 
+//Milliseconds the Remove queue must stay untouched before "xbps-remove -n" verifies its removal list
+const int ctn_REMOVAL_VERIFICATION_DELAY(1500);
+
+//Milliseconds the Install queue must stay untouched before "xbps-install -n" verifies its install list
+const int ctn_INSTALL_VERIFICATION_DELAY(1500);
+
+//Data role of tvTransaction items holding the name of the package (parent items don't have it)
+const int ctn_PACKAGE_NAME_ROLE(Qt::UserRole + 1);
+
 //enum TreatURLLinks { ectn_TREAT_URL_LINK, ectn_DONT_TREAT_URL_LINK };
 //enum SystemUpgradeOptions { ectn_NO_OPT, ectn_SYNC_DATABASE_OPT, ectn_NOCONFIRM_OPT };
 
@@ -98,6 +109,10 @@ private:
   QList<QModelIndex> *m_foundFilesInPkgFileList;
   int m_indFoundFilesInPkgFileList;
   QFileSystemWatcher *m_pacmanDatabaseSystemWatcher;
+  QTimer *m_pkgdbChangedTimer;
+
+  //pkgver of every installed package, as it was when the package list was last built or updated
+  QHash<QString, QString> m_installedPackageVersions;
 
   // Package Data
   PackageRepository           m_packageRepo;
@@ -118,6 +133,9 @@ private:
   //Controls the calling of System Upgrade NO CONFIRM action
   bool m_callSystemUpgradeNoConfirm;
 
+  //Controls the calling of System Upgrade action when the running transaction ends
+  bool m_callSystemUpgradeAfterTransaction;
+
   //Controls if this Linux box has slocate utility
   bool m_hasSLocate;
 
@@ -207,6 +225,29 @@ private:
 
   QSet<QString> * m_unrequiredPackageList;
 
+  //These members hold the recursive removal list of the packages in the Remove queue
+  QString m_removalClosureTargets;
+  QString m_removalVerificationTargets;
+  QStringList m_removalClosure;
+  QTimer *m_removalVerificationTimer;
+
+  QString m_filePathSuggestionsPrefix;
+
+  //Package name -> item of the Remove and Install parents of tvTransaction
+  QHash<QString, QStandardItem *> m_removeQueue;
+  QHash<QString, QStandardItem *> m_installQueue;
+  bool m_transactionBatch;
+
+  //These members hold the install list and sizes of the packages in the Install queue
+  QString m_installClosureTargets;
+  QString m_installVerificationTargets;
+  TransactionInfo m_installClosure;
+  QTimer *m_installVerificationTimer;
+
+  //System upgrade plan sent by the notifier and the pkgdb/repodata stamp it was computed for
+  TransactionInfo m_upgradePlan;
+  QString m_upgradePlanStamp;
+
   QStringList m_listOfVisitedPackages;
   int m_indOfVisitedPackage;
 
@@ -264,11 +305,17 @@ private:
 
   void insertRemovePackageIntoTransaction(const QString &pkgName);
   void insertInstallPackageIntoTransaction(const QString &pkgName);
+  void insertRemovePackagesIntoTransaction(const QStringList &pkgNames);
+  void insertInstallPackagesIntoTransaction(const QStringList &pkgNames);
+  void insertPackagesIntoTransaction(const QStringList &pkgNames, bool toRemove);
   void removePackagesFromRemoveTransaction();
   void removePackagesFromInstallTransaction();
   int getNumberOfTobeRemovedPackages();
   QString getTobeRemovedPackages();
   QString getTobeInstalledPackages();
+  TransactionInfo getInstallTransactionInfo();
+  void refreshInstallTransactionText();
+  void setInstallClosure(const TransactionInfo &ti);
   void initTabTransaction();
 
   //Tab Output related methods
@@ -294,13 +341,16 @@ private:
   void showDistroNews(QString distroRSSXML, bool searchForLatestNews = true);
   void initTabNews();
   void initTabHelpUsage();
+  void initPackageDatabaseWatcher();
   void refreshToolBar();
   void refreshStatusBarToolButtons();
 
   void switchToViewAllPackages();
 
+  bool hasUpgradePlan();
+  bool takeUpgradePlan(TransactionInfo &ti);
+
   //void retrieveForeignPackageList();
-  void retrieveUnrequiredPackageList();
 
 private slots:
   void initToolButtonPacman();
@@ -326,12 +376,20 @@ private slots:
   void tvPackagesSelectionChanged(const QItemSelection&, const QItemSelection&);
   void tvTransactionSelectionChanged (const QItemSelection&, const QItemSelection&);
   void tvTransactionRowsInserted(const QModelIndex& parent, int, int);
+  void tvTransactionRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
   void tvTransactionRowsRemoved(const QModelIndex& parent, int, int);
+  void refreshRemovalClosure();
+  void onRemovalClosureComputed();
+  void startRemovalVerification();
+  void onRemovalClosureVerified();
+  void refreshInstallClosure();
+  void onInstallClosureComputed();
+  void startInstallVerification();
+  void onInstallClosureVerified();
 
   void buildPackagesFromGroupList(const QString group);
   void buildPackageList();
   void buildRemotePackageList();
-  void searchForPkgPackages();
   void prepareTargetUpgradeList(const QString &pkgName="", CommandExecuting type=ectn_SYSTEM_UPGRADE);
 
   void metaBuildPackageList();
@@ -342,9 +400,12 @@ private slots:
   void preBuildRemotePackageList();
   void preBuildRemotePackageListMeta();
   //void preBuildForeignPackageList();
-  void preBuildUnrequiredPackageList();
   void preBuildPackageList();
   void preBuildPackagesFromGroupList();
+  void watchPackageDatabase();
+  void onPackageDatabaseChanged();
+  void refreshInstalledPackages();
+  void onInstalledPackagesLoaded();
 
   void headerViewPackageListSortIndicatorClicked(int col, Qt::SortOrder order);
   void changePackageListModel(ViewOptions viewOptions, QString selectedRepo);
@@ -417,6 +478,7 @@ private slots:
   void postRefreshDistroNews();
 
   void onHelpUsage();
+  void onHelpDiagnostics();
   void onHelpAbout();
   void onPressDelete();
 
@@ -424,6 +486,8 @@ private slots:
   void changeTransactionActionsState();
   void clearTransactionTreeView();
   void positionInPkgListSearchByFile();
+  void refreshFilePathSuggestions();
+  void onFilePathSuggestionsReady();
   void positionInFirstMatch();
   void searchBarTextChangedInTextBrowser(const QString textToSearch);
   void searchBarFindNextInTextBrowser();
@@ -437,11 +501,11 @@ private slots:
   void positionInPackageList(const QString &pkgName);
   void outputTextBrowserAnchorClicked(const QUrl & link);
   void execToolTip();
-  void doPreSystemUpgrade();
 
   void testSpecialDependencies();
 
 public slots:
+  void doPreSystemUpgrade();
   void doSystemUpgrade(SystemUpgradeOptions sysUpgradeOption = ectn_NO_OPT);
 
 public:
@@ -462,14 +526,18 @@ public:
 
   const PackageRepository::PackageData* getFirstPackageFromRepo(const QString pkgName);
   bool isRemoteSearchSelected();
+  bool canRefreshInstalledPackages();
   bool isSearchByFileSelected();
   void turnDebugInfoOn();
   void setCallSystemUpgrade();
   void setCallSystemUpgradeNoConfirm();
+  void setCallSystemUpgradeAfterTransaction();
   void setRemoveCommand(const QString &removeCommand);
   void setPackagesToInstallList(QStringList pkgList){ m_packagesToInstallList = pkgList; }
   void doInstallLocalPackages();
   bool isExecutingCommand(){ return m_commandExecuting != ectn_NONE; }
+  bool isInitializationCompleted(){ return m_initializationCompleted; }
+  void setUpgradePlan(const QString &message);
 };
 
 #endif // MAINWINDOW_H
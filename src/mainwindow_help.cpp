@@ -27,6 +27,7 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "searchbar.h"
+#include "diagnosticsdialog.h"
 
 #include <QString>
 #include <QTextBrowser>
@@ -183,6 +184,15 @@ void MainWindow::onHelpUsage()
   changeTabWidgetPropertiesIndex(ctn_TABINDEX_HELPUSAGE);
 }
 
+/*
+ * Slot which opens the dialog with the statistics of the processes we spawned
+ */
+void MainWindow::onHelpDiagnostics()
+{
+  DiagnosticsDialog dialog(this);
+  dialog.exec();
+}
+
 /*
  * Slot which opens the About dialog
  */
@@ -30,6 +30,8 @@
 #include "searchlineedit.h"
 #include "treeviewpackagesitemdelegate.h"
 #include "searchbar.h"
+#include "globals.h"
+#include "daemonclient.h"
 #include <iostream>
 #include <cassert>
 
@@ -44,6 +46,8 @@
 #include <QProgressBar>
 #include <QSystemTrayIcon>
 #include <QToolButton>
+#include <QFileSystemWatcher>
+#include <QTimer>
 #include <QDebug>
 
 /*
@@ -146,20 +150,52 @@ void MainWindow::savePackageColumnWidths()
 }
 
 /*
- * If we have some outdated packages, let's put octoPkg in a red face/angry state ;-)
+ * Starts with the plain icon: outdated packages arrive with the first package list snapshot,
+ * and then buildPackageList() may put octoPkg in a red face/angry state ;-)
  */
 void MainWindow::initAppIcon()
 {
   m_outdatedStringList->clear();
-  m_outdatedList = Package::getOutdatedStringList();
+  m_numberOfOutdatedPackages = 0;
+  refreshAppIcon();
+}
 
-  foreach(QString k, m_outdatedList->keys())
+/*
+ * Keeps track of packages installed, updated or removed outside of OctoXBPS, so they show up in the list.
+ * octoxbps-daemon already watches the XBPS database, so when it's around we just listen to it.
+ * Bursts of events are coalesced
+ */
+void MainWindow::initPackageDatabaseWatcher()
+{
+  m_pkgdbChangedTimer = new QTimer(this);
+  m_pkgdbChangedTimer->setSingleShot(true);
+  m_pkgdbChangedTimer->setInterval(ctn_PACKAGE_DATABASE_WATCHER_DELAY);
+  connect(m_pkgdbChangedTimer, SIGNAL(timeout()), this, SLOT(refreshInstalledPackages()));
+  connect(&g_fwInstalledPackages, SIGNAL(finished()), this, SLOT(onInstalledPackagesLoaded()));
+
+  m_pacmanDatabaseSystemWatcher = NULL;
+
+  if (DaemonClient::isAvailable() &&
+      DaemonClient::connectToPackageDatabaseChanged(this, SLOT(onPackageDatabaseChanged())))
   {
-    m_outdatedStringList->append(k);
+    DaemonClient::watchForUnregistration(this, SLOT(watchPackageDatabase()));
+    return;
   }
 
-  m_numberOfOutdatedPackages = m_outdatedStringList->count();
-  refreshAppIcon();
+  watchPackageDatabase();
+}
+
+/*
+ * Watches the XBPS database directory ourselves (inotify, like the notifier does)
+ */
+void MainWindow::watchPackageDatabase()
+{
+  if (m_pacmanDatabaseSystemWatcher != NULL) return;
+
+  m_pacmanDatabaseSystemWatcher =
+      new QFileSystemWatcher(QStringList() << ctn_XBPS_DATABASE_DIR, this);
+  connect(m_pacmanDatabaseSystemWatcher,
+          SIGNAL(directoryChanged(QString)), this, SLOT(onPackageDatabaseChanged()));
 }
 
 /*
@@ -443,8 +479,25 @@ void MainWindow::initTabTransaction()
 
   connect(tvTransaction->model(), SIGNAL(rowsInserted ( const QModelIndex , int, int )),
           this, SLOT(tvTransactionRowsInserted(QModelIndex,int,int)));
+  connect(tvTransaction->model(), SIGNAL(rowsAboutToBeRemoved ( const QModelIndex , int, int )),
+          this, SLOT(tvTransactionRowsAboutToBeRemoved(QModelIndex,int,int)));
   connect(tvTransaction->model(), SIGNAL(rowsRemoved ( const QModelIndex , int, int )),
           this, SLOT(tvTransactionRowsRemoved(QModelIndex,int,int)));
+
+  m_removalVerificationTimer = new QTimer(this);
+  m_removalVerificationTimer->setSingleShot(true);
+  m_removalVerificationTimer->setInterval(ctn_REMOVAL_VERIFICATION_DELAY);
+  connect(m_removalVerificationTimer, SIGNAL(timeout()), this, SLOT(startRemovalVerification()));
+
+  m_installVerificationTimer = new QTimer(this);
+  m_installVerificationTimer->setSingleShot(true);
+  m_installVerificationTimer->setInterval(ctn_INSTALL_VERIFICATION_DELAY);
+  connect(m_installVerificationTimer, SIGNAL(timeout()), this, SLOT(startInstallVerification()));
+
+  connect(&g_fwRemovalClosure, SIGNAL(finished()), this, SLOT(onRemovalClosureComputed()));
+  connect(&g_fwRemovalVerification, SIGNAL(finished()), this, SLOT(onRemovalClosureVerified()));
+  connect(&g_fwInstallClosure, SIGNAL(finished()), this, SLOT(onInstallClosureComputed()));
+  connect(&g_fwInstallVerification, SIGNAL(finished()), this, SLOT(onInstallClosureVerified()));
 }
 
 /*
@@ -706,6 +759,7 @@ void MainWindow::initActions()
   connect(ui->actionGetNews, SIGNAL(triggered()), this, SLOT(refreshDistroNews()));
   connect(ui->twProperties, SIGNAL(currentChanged(int)), this, SLOT(changedTabIndex()));
   connect(ui->actionHelpUsage, SIGNAL(triggered()), this, SLOT(onHelpUsage()));
+  connect(ui->actionHelpDiagnostics, SIGNAL(triggered()), this, SLOT(onHelpDiagnostics()));
   connect(ui->actionHelpAbout, SIGNAL(triggered()), this, SLOT(onHelpAbout()));
 
   //Actions from tvPkgFileList context menu
@@ -28,6 +28,9 @@
 #include "strconstants.h"
 #include "uihelper.h"
 #include "globals.h"
+#include "searchindex.h"
+#include "dependencygraph.h"
+#include "tracer.h"
 #include <iostream>
 #include <cassert>
 #include "src/ui/octopitabinfo.h"
@@ -101,6 +104,7 @@ void MainWindow::refreshAppIcon()
  */
 void MainWindow::refreshGroupsWidget()
 {
+  TraceSpan span("MainWindow::refreshGroupsWidget");
   /*
   disconnect(ui->twGroups, SIGNAL(itemSelectionChanged()), this, SLOT(groupItemSelected()));
 
@@ -313,21 +317,6 @@ void MainWindow::buildPackagesFromGroupList(const QString group)
   assert(m_foreignPackageList != NULL);
 }*/
 
-/*
- * Executes QFuture to retrive Unrequired Pacman list of packages
- */
-void MainWindow::retrieveUnrequiredPackageList()
-{
-  QEventLoop el;
-  QFuture<QSet<QString> *> f;
-  f = QtConcurrent::run(searchUnrequiredPacmanPackages);
-  connect(&g_fwUnrequiredPacman, SIGNAL(finished()), this, SLOT(preBuildUnrequiredPackageList()));
-  connect(&g_fwUnrequiredPacman, SIGNAL(finished()), &el, SLOT(quit()));
-  g_fwUnrequiredPacman.setFuture(f);
-  el.exec();
-  assert(m_unrequiredPackageList != NULL);
-}
-
 /*
  * Helper method to assign QFuture for list of outdated packages
  */
@@ -339,31 +328,46 @@ void MainWindow::retrieveUnrequiredPackageList()
     std::cout << "Time elapsed obtaining Foreign pkgs from 'ALL group' list: " << m_time->elapsed() << " mili seconds." << std::endl << std::endl;
 }*/
 
-/*
- * Helper method to assign QFuture for Unrequired Pacman list of packages
- */
-void MainWindow::preBuildUnrequiredPackageList()
-{
-  m_unrequiredPackageList = g_fwUnrequiredPacman.result();
-
-  if(m_debugInfo)
-    std::cout << "Time elapsed obtaining Unrequired pkgs from 'ALL group' list: " << m_time->elapsed() << " mili seconds." << std::endl << std::endl;
-}
-
 /*
  * Helper method to deal with the QFutureWatcher result before calling
- * Pacman package list building method
+ * Pacman package list building method. The snapshot brings the outdated and
+ * unrequired lists too, unless only the package list was asked for
  */
 void MainWindow::preBuildPackageList()
 {
-  m_listOfPackages.reset(g_fwPacman.result());
+  TraceSpan span("MainWindow::preBuildPackageList");
+  PackageListSnapshot snapshot = g_fwPackageListSnapshot.result();
+  m_listOfPackages.reset(snapshot.packages);
+
+  if (snapshot.outdatedPackages != NULL)
+  {
+    delete m_outdatedList;
+    m_outdatedList = snapshot.outdatedPackages;
+
+    m_outdatedStringList->clear();
+    foreach(QString k, m_outdatedList->keys())
+    {
+      m_outdatedStringList->append(k);
+    }
+
+    m_numberOfOutdatedPackages = m_outdatedStringList->count();
+  }
+
+  if (snapshot.unrequiredPackages != NULL)
+  {
+    delete m_unrequiredPackageList;
+    m_unrequiredPackageList = snapshot.unrequiredPackages;
+  }
 
   if(m_debugInfo)
-    std::cout << "Time elapsed obtaining pkgs from 'ALL group' list: " << m_time->elapsed() << " mili seconds." << std::endl;
+    std::cout << "Time elapsed obtaining pkgs, outdated and unrequired pkgs from 'ALL group' list: " << m_time->elapsed() << " mili seconds." << std::endl;
 
   buildPackageList();
   toggleSystemActions(true);
 
+  //The package list comes first: only now the indexes are warmed for the remote and file searches
+  startIndexWarmers();
+
   /*if (!m_initializationCompleted)
   {
     remoteSearchClicked();
@@ -371,6 +375,165 @@ void MainWindow::preBuildPackageList()
   }*/
 }
 
+/*
+ * Called whenever something changes inside the XBPS database directory.
+ * A transaction writes it many times, so we wait for pkgdb to settle down
+ */
+void MainWindow::onPackageDatabaseChanged()
+{
+  m_pkgdbChangedTimer->start();
+}
+
+/*
+ * Returns true if the package list can take the packages changed outside of OctoXBPS right now
+ */
+bool MainWindow::canRefreshInstalledPackages()
+{
+  //Transactions and full list rebuilds refresh everything by themselves
+  return (m_initializationCompleted && m_commandExecuting == ectn_NONE && m_unrequiredPackageList != NULL &&
+          !g_fwPackageListSnapshot.isRunning() && !isRemoteSearchSelected());
+}
+
+/*
+ * Starts reading pkgdb in a worker thread, so packages installed, updated or removed outside
+ * of OctoXBPS can be merged into the package list by onInstalledPackagesLoaded()
+ */
+void MainWindow::refreshInstalledPackages()
+{
+  if (!canRefreshInstalledPackages()) return;
+
+  //The running read may have started before this change: try again when it's done
+  if (g_fwInstalledPackages.isRunning())
+  {
+    m_pkgdbChangedTimer->start();
+    return;
+  }
+
+  QFuture<InstalledPackagesState> f;
+  f = QtConcurrent::run(loadInstalledPackages, m_installedPackageVersions);
+  g_fwInstalledPackages.setFuture(f);
+}
+
+/*
+ * Merges into the package list the packages installed, updated or removed outside of OctoXBPS.
+ * Only the pkgdb entries whose pkgver changed are looked at, and the view is updated row by row
+ */
+void MainWindow::onInstalledPackagesLoaded()
+{
+  TraceSpan span("MainWindow::onInstalledPackagesLoaded");
+  InstalledPackagesState state = g_fwInstalledPackages.result();
+
+  //The package list may have been rebuilt (or be about to) while pkgdb was being read
+  if (!state.available || !canRefreshInstalledPackages() || state.knownVersions != m_installedPackageVersions)
+  {
+    delete state.unrequiredPackages;
+    return;
+  }
+
+  QHash<QString, QString> installedVersions = state.versions;
+  QList<PackageListData> installed;
+  QStringList removed;
+  QSet<QString> changedNames;
+
+  for (QHash<QString, QString>::const_iterator it = installedVersions.constBegin(); it != installedVersions.constEnd(); ++it)
+  {
+    if (m_installedPackageVersions.value(it.key()) == it.value()) continue;
+
+    QString pkgName = it.key();
+    QString version = it.value().mid(it.value().lastIndexOf("-") + 1);
+    const PackageRepository::PackageData *package = m_packageRepo.getFirstPackageByName(pkgName);
+    PackageListData pld(pkgName, "", version, pkgName + " " + state.descriptions.value(pkgName), ectn_INSTALLED, 0, 0);
+
+    if (package != NULL)
+    {
+      pld.origin = package->origin;
+      pld.comment = package->comment;
+#ifdef UNIFIED_SEARCH
+      //"xbps-query -Rs" shows the version available in the repositories
+      pld.version = package->version;
+#endif
+    }
+
+    if (m_outdatedList->contains(pkgName))
+    {
+      OutdatedPackageInfo opi = m_outdatedList->value(pkgName);
+
+      if (Package::rpmvercmp(version.toLatin1().data(), opi.newVersion.toLatin1().data()) >= 0)
+      {
+        m_outdatedList->remove(pkgName);
+      }
+      else
+      {
+        opi.oldVersion = version;
+        m_outdatedList->insert(pkgName, opi);
+        pld.status = ectn_OUTDATED;
+        pld.outatedVersion = version;
+      }
+    }
+
+    installed.append(pld);
+    changedNames.insert(pkgName);
+  }
+
+  foreach(QString pkgName, m_installedPackageVersions.keys())
+  {
+    if (installedVersions.contains(pkgName)) continue;
+
+    m_outdatedList->remove(pkgName);
+    changedNames.insert(pkgName);
+
+#ifdef UNIFIED_SEARCH
+    //The package is still available in the repositories
+    const PackageRepository::PackageData *package = m_packageRepo.getFirstPackageByName(pkgName);
+    if (package != NULL)
+    {
+      installed.append(PackageListData(pkgName, package->origin, package->version, package->comment, ectn_NON_INSTALLED, 0, 0));
+      continue;
+    }
+#endif
+
+    removed.append(pkgName);
+  }
+
+  delete m_unrequiredPackageList;
+  m_unrequiredPackageList = state.unrequiredPackages;
+
+  if (!m_packageRepo.updateInstalledPackages(installed, removed, *m_unrequiredPackageList))
+  {
+    //Too much has changed: let's rebuild everything
+    metaBuildPackageList();
+    return;
+  }
+
+  m_installedPackageVersions = installedVersions;
+  if (changedNames.isEmpty()) return;
+
+  if(m_debugInfo)
+    std::cout << "Packages changed outside of OctoXBPS: " << changedNames.count() << std::endl;
+
+  m_outdatedStringList->clear();
+  foreach(QString k, m_outdatedList->keys())
+  {
+    m_outdatedStringList->append(k);
+  }
+
+  m_numberOfOutdatedPackages = m_outdatedStringList->count();
+
+  foreach(QString pkgName, changedNames)
+  {
+    clearPackageInfoCache(pkgName);
+  }
+
+  //The selected package may be one of them
+  m_cachedPackageInInfo = "";
+  m_cachedPackageInFiles = "";
+  refreshTabInfo();
+  refreshTabFiles();
+  refreshStatusBar();
+  refreshAppIcon();
+  refreshStatusBarToolButtons();
+}
+
 /*
  * Helper method to deal with the QFutureWatcher result before calling
  * Pacman packages from group list building method
@@ -386,23 +549,14 @@ void MainWindow::preBuildPackagesFromGroupList()
   emit buildPackagesFromGroupListDone();
 }
 
-/*
- * Slot to fire the search for all installed packages
- */
-void MainWindow::searchForPkgPackages()
-{
-  QFuture<QList<PackageListData> *> f;
-  f = QtConcurrent::run(searchPkgPackages);
-  disconnect(&g_fwPacman, SIGNAL(finished()), this, SLOT(preBuildPackageList()));
-  connect(&g_fwPacman, SIGNAL(finished()), this, SLOT(preBuildPackageList()));
-  g_fwPacman.setFuture(f);
-}
-
 /*
  * Decides which SLOT to call: buildPackageList, buildAURPackageList or buildPackagesFromGroupList
  */
 void MainWindow::metaBuildPackageList()
 {
+  TraceSpan span("MainWindow::metaBuildPackageList");
+  traceAsyncBegin("Build package list", m_packageModel);
+
   m_time->start();
 
   if (isSearchByFileSelected())
@@ -451,20 +605,15 @@ void MainWindow::metaBuildPackageList()
     disconnect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
     connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
     //reapplyPackageFilter();
-    disconnect(&g_fwPacman, SIGNAL(finished()), this, SLOT(preBuildPackageList()));
+    disconnect(&g_fwPackageListSnapshot, SIGNAL(finished()), this, SLOT(preBuildPackageList()));
 
-    if (m_refreshPackageLists)
-    {
-      QFuture<QMap<QString, OutdatedPackageInfo> *> f;
-      f = QtConcurrent::run(getOutdatedList);
-      disconnect(&g_fwOutdatedList, SIGNAL(finished()), this, SLOT(searchForPkgPackages()));
-      connect(&g_fwOutdatedList, SIGNAL(finished()), this, SLOT(searchForPkgPackages()));
-      g_fwOutdatedList.setFuture(f);
-    }
-    else
-    {
-      searchForPkgPackages();
-    }
+    //After a transaction every list may have changed. At startup we don't have them yet
+    bool refreshAll = m_refreshPackageLists || m_unrequiredPackageList == NULL;
+
+    QFuture<PackageListSnapshot> f;
+    f = QtConcurrent::run(loadPackageListSnapshot, refreshAll);
+    connect(&g_fwPackageListSnapshot, SIGNAL(finished()), this, SLOT(preBuildPackageList()));
+    g_fwPackageListSnapshot.setFuture(f);
 
     if(m_debugInfo)
       std::cout << m_packageModel->getPackageCount() << " pkgs => " <<
@@ -577,10 +726,14 @@ void MainWindow::preBuildRemotePackageList()
  */
 void MainWindow::buildRemotePackageList()
 {
+  TraceSpan span("MainWindow::buildRemotePackageList");
   //ui->actionSearchByDescription->setChecked(true);
   m_progressWidget->show();
 
-  const QSet<QString>*const unrequiredPackageList = Package::getUnrequiredPackageList();
+  //The unrequired list came with the last package list snapshot
+  QSet<QString> noUnrequiredPackages;
+  const QSet<QString> &unrequiredPackageList =
+      (m_unrequiredPackageList != NULL ? *m_unrequiredPackageList : noUnrequiredPackages);
   QList<PackageListData> *list = m_listOfRemotePackages;
 
   m_progressWidget->setRange(0, list->count());
@@ -599,7 +752,8 @@ void MainWindow::buildRemotePackageList()
     ++it;
   }
 
-  m_packageRepo.setAURData(list, *unrequiredPackageList);
+  m_packageRepo.setAURData(list, unrequiredPackageList);
+  clearPackageInfoCache();
   m_packageModel->applyFilter(PackageModel::ctn_PACKAGE_DESCRIPTION_FILTER_NO_COLUMN);
   m_packageModel->applyFilter(ectn_ALL_PKGS, "", "NONE");
 
@@ -657,7 +811,9 @@ void MainWindow::buildRemotePackageList()
   refreshStatusBarToolButtons();
 
   //If we found no packages, let's make another search, this time 'by name'...
+  //(the local search index already looks at package names, so it's only needed with "xbps-query -Rs")
   if (!m_leFilterPackage->text().isEmpty() &&
+      !SearchIndex::instance()->isLoaded() &&
       (!m_leFilterPackage->text().contains(QRegularExpression("\\s"))) &&
       m_packageModel->getPackageCount() == 0 &&
       ui->actionSearchByDescription->isChecked())
@@ -672,6 +828,7 @@ void MainWindow::buildRemotePackageList()
     metaBuildPackageList();
   }
 
+  traceAsyncEnd("Build package list", m_packageModel);
   emit buildPackageListDone();
 }
 
@@ -710,37 +867,10 @@ void MainWindow::showPackagesWithNoDescription()
  */
 void MainWindow::buildPackageList()
 {
+  TraceSpan span("MainWindow::buildPackageList");
   CPUIntensiveComputing cic;
   static bool firstTime = true;
 
-  if(m_refreshPackageLists) //If it's not the starting of the app...
-  {
-    //Let's get outdatedPackages list again!
-    m_outdatedStringList->clear();
-    m_outdatedList = g_fwOutdatedList.result(); //Package::getOutdatedStringList();
-
-    if(m_debugInfo)
-      std::cout << "Time elapsed retrieving outdated pkgs from 'ALL group' list: " << m_time->elapsed() << " mili seconds." << std::endl;
-
-    foreach(QString k, m_outdatedList->keys())
-    {
-      m_outdatedStringList->append(k);
-    }
-
-    if(m_debugInfo)
-      std::cout << "Time elapsed refreshing outdated pkgs from 'ALL group' list: " << m_time->elapsed() << " mili seconds." << std::endl;
-
-    m_numberOfOutdatedPackages = m_outdatedStringList->count();
-
-    delete m_unrequiredPackageList;
-    m_unrequiredPackageList = NULL;
-
-    m_unrequiredPackageList = Package::getUnrequiredPackageList();   
-
-    if(m_debugInfo)
-      std::cout << "Time elapsed obtaining unrequired pkgs from 'ALL group' list: " << m_time->elapsed() << " mili seconds." << std::endl;
-  }
-
   // Fetch package list
   QList<PackageListData> *list;
   list = m_listOfPackages.release();
@@ -765,42 +895,51 @@ void MainWindow::buildPackageList()
   counter = list->count();
   m_progressWidget->setValue(counter);
   m_progressWidget->close();
-  m_packageRepo.setData(list, *m_unrequiredPackageList);
-
-  if(m_debugInfo)
-    std::cout << "Time elapsed setting the list to the treeview: " << m_time->elapsed() << " mili seconds." << std::endl;
 
-  if (ui->actionSearchByDescription->isChecked())
-  {
-    m_packageModel->applyFilter(PackageModel::ctn_PACKAGE_DESCRIPTION_FILTER_NO_COLUMN);
-  }
-  else
+  //Outdated packages are marked before the repository compares the new list with the current one
+  QList<PackageListData>::iterator itOutdated = list->begin();
+  while(itOutdated != list->end())
   {
-    m_packageModel->applyFilter(PackageModel::ctn_PACKAGE_NAME_COLUMN);
+    if (m_outdatedList->contains(itOutdated->name))
+    {
+      itOutdated->status = ectn_OUTDATED;
+      itOutdated->outatedVersion = m_outdatedList->value(itOutdated->name).oldVersion;
+    }
+
+    ++itOutdated;
   }
 
+  //When only a few packages changed, the view keeps its selection, filters and scroll position
+  bool incremental = m_packageRepo.setData(list, *m_unrequiredPackageList);
+  clearPackageInfoCache();
+  m_installedPackageVersions = DependencyGraph::instance()->getInstalledPackageVersions();
+
+  if(m_debugInfo)
+    std::cout << "Time elapsed setting the list to the treeview: " << m_time->elapsed() << " mili seconds." << std::endl;
+
   delete list;
   list = NULL;
 
-  foreach(QString k, m_outdatedList->keys())
+  if (!incremental)
   {
-    OutdatedPackageInfo opi = m_outdatedList->value(k);
-    PackageRepository::PackageData* package = m_packageRepo.getFirstPackageByNameEx(k);
-    if (package != NULL)
+    if (ui->actionSearchByDescription->isChecked())
     {
-      package->status = ectn_OUTDATED;
-      package->outdatedVersion = opi.oldVersion;
+      m_packageModel->applyFilter(PackageModel::ctn_PACKAGE_DESCRIPTION_FILTER_NO_COLUMN);
+    }
+    else
+    {
+      m_packageModel->applyFilter(PackageModel::ctn_PACKAGE_NAME_COLUMN);
     }
-  }
 
-  if (isAllCategoriesSelected()) m_packageModel->applyFilter(m_selectedViewOption, m_selectedRepository, "");
+    if (isAllCategoriesSelected()) m_packageModel->applyFilter(m_selectedViewOption, m_selectedRepository, "");
 
-  reapplyPackageFilter();
+    reapplyPackageFilter();
 
-  QModelIndex maux = m_packageModel->index(0, 0, QModelIndex());
-  ui->tvPackages->setCurrentIndex(maux);
-  ui->tvPackages->scrollTo(maux, QAbstractItemView::PositionAtCenter);
-  ui->tvPackages->setCurrentIndex(maux);
+    QModelIndex maux = m_packageModel->index(0, 0, QModelIndex());
+    ui->tvPackages->setCurrentIndex(maux);
+    ui->tvPackages->scrollTo(maux, QAbstractItemView::PositionAtCenter);
+    ui->tvPackages->setCurrentIndex(maux);
+  }
 
   refreshTabInfo();
   refreshTabFiles();
@@ -832,7 +971,7 @@ void MainWindow::buildPackageList()
     {
       //First, let us throw away that 'wainting cursor'...
       QApplication::restoreOverrideCursor();
-      doSystemUpgrade();
+      doPreSystemUpgrade();
     }
     else if (m_callSystemUpgradeNoConfirm)
     {
@@ -853,6 +992,7 @@ void MainWindow::buildPackageList()
   refreshStatusBarToolButtons();
   m_refreshPackageLists = true;  
 
+  traceAsyncEnd("Build package list", m_packageModel);
   emit buildPackageListDone();
 }
 
@@ -895,6 +1035,7 @@ void MainWindow::buildPackageList()
   }
 
   m_packageRepo.setData(list, *unrequiredPackageList);
+  clearPackageInfoCache();
   delete list;
   list = NULL;
 }
@@ -1049,6 +1190,7 @@ void MainWindow::refreshTabInfo(QString pkgName)
  */
 void MainWindow::refreshTabInfo(bool clearContents, bool neverQuit)
 {
+  TraceSpan span("MainWindow::refreshTabInfo");
   if(neverQuit == false &&
      (ui->twProperties->currentIndex() != ctn_TABINDEX_INFORMATION || !isPropertiesTabWidgetVisible())) return;
 
@@ -1110,7 +1252,8 @@ void MainWindow::refreshTabInfo(bool clearContents, bool neverQuit)
  * Re-populates the treeview which contains the file list of selected package (tab TWO)
  */
 void MainWindow::refreshTabFiles(bool clearContents, bool neverQuit)
-{  
+{
+  TraceSpan span("MainWindow::refreshTabFiles");
   if (m_progressWidget->isVisible()) return;
 
   if(neverQuit == false &&
@@ -1345,6 +1488,7 @@ void MainWindow::refreshTabFiles(bool clearContents, bool neverQuit)
  */
 void MainWindow::reapplyPackageFilter()
 {
+  TraceSpan span("MainWindow::reapplyPackageFilter");
   if (!isSearchByFileSelected())
   {
     bool isFilterPackageSelected = m_leFilterPackage->hasFocus();
@@ -1385,12 +1529,40 @@ void MainWindow::reapplyPackageFilter()
 
     //We need to provide QCompleter data to the SearchLineEdit...
     if (!m_leFilterPackage->text().isEmpty())
-      m_leFilterPackage->refreshCompleterData();
+      refreshFilePathSuggestions();
 
     connect(m_leFilterPackage, SIGNAL(textChanged(QString)), this, SLOT(reapplyPackageFilter()));
   }
 }
 
+/*
+ * Starts looking (in a worker thread) for file paths which complete the text of the search line edit.
+ * Suggestions still being computed for an older text are thrown away
+ */
+void MainWindow::refreshFilePathSuggestions()
+{
+  m_filePathSuggestionsPrefix = m_leFilterPackage->text();
+  int generation = g_filePathSuggestionsGeneration.fetchAndAddOrdered(1) + 1;
+
+  disconnect(&g_fwFilePathSuggestions, SIGNAL(finished()), this, SLOT(onFilePathSuggestionsReady()));
+
+  QFuture<QStringList> f;
+  f = QtConcurrent::run(getFilePathSuggestions, m_filePathSuggestionsPrefix, m_hasSLocate, generation);
+  g_fwFilePathSuggestions.setFuture(f);
+
+  connect(&g_fwFilePathSuggestions, SIGNAL(finished()), this, SLOT(onFilePathSuggestionsReady()));
+}
+
+/*
+ * Feeds the SearchLineEdit completer, if the user didn't type anything else meanwhile
+ */
+void MainWindow::onFilePathSuggestionsReady()
+{
+  if (m_leFilterPackage->text() != m_filePathSuggestionsPrefix) return;
+
+  m_leFilterPackage->setCompleterData(g_fwFilePathSuggestions.result());
+}
+
 /*
  * Whenever user selects View/All we show him all the available packages
  */
@@ -34,6 +34,8 @@
 #include <cassert>
 #include "searchlineedit.h"
 #include "xbpsexec.h"
+#include "packagestatecache.h"
+#include "tracer.h"
 
 #include <QComboBox>
 #include <QProgressBar>
@@ -128,66 +130,79 @@ QStandardItem * MainWindow::getInstallTransactionParentItem()
  */
 void MainWindow::insertRemovePackageIntoTransaction(const QString &pkgName)
 {
-  QTreeView *tvTransaction =
-      ui->twProperties->widget(ctn_TABINDEX_TRANSACTION)->findChild<QTreeView*>("tvTransaction");
-  QStandardItem * siRemoveParent = getRemoveTransactionParentItem();
-  QStandardItem * siInstallParent = getInstallTransactionParentItem();
-  QStandardItem * siPackageToRemove = new QStandardItem(IconHelper::getIconRemoveItem(), pkgName);
-  QStandardItemModel *sim = qobject_cast<QStandardItemModel *>(siRemoveParent->model());
-  QList<QStandardItem *> foundItems = sim->findItems(pkgName, Qt::MatchRecursive | Qt::MatchExactly);
-  int slash = pkgName.indexOf("/");
-  QString pkg = pkgName.mid(slash+1);
-  siPackageToRemove->setText(pkg);
+  insertRemovePackagesIntoTransaction(QStringList(pkgName));
+}
 
-  if (foundItems.size() == 0)
-  {
-    int slash = pkgName.indexOf("/");
-    QString pkg = pkgName.mid(slash+1);
-    QList<QStandardItem *> aux = sim->findItems(pkg, Qt::MatchRecursive | Qt::MatchExactly);
+/*
+ * Inserts the given package into the Install parent item of the Transaction treeview
+ */
+void MainWindow::insertInstallPackageIntoTransaction(const QString &pkgName)
+{
+  insertInstallPackagesIntoTransaction(QStringList(pkgName));
+}
 
-    if (aux.count() == 0) siRemoveParent->appendRow(siPackageToRemove);
-  }
-  else if (foundItems.size() == 1 && foundItems.at(0)->parent() == siInstallParent)
-  {
-    siInstallParent->removeRow(foundItems.at(0)->row());
-    siRemoveParent->appendRow(siPackageToRemove);
-  }
+/*
+ * Inserts the given packages into the Remove parent item of the Transaction treeview
+ */
+void MainWindow::insertRemovePackagesIntoTransaction(const QStringList &pkgNames)
+{
+  insertPackagesIntoTransaction(pkgNames, true);
+}
 
-  ui->twProperties->setCurrentIndex(ctn_TABINDEX_TRANSACTION);
-  tvTransaction->expandAll();
-  changeTransactionActionsState();
+/*
+ * Inserts the given packages into the Install parent item of the Transaction treeview
+ */
+void MainWindow::insertInstallPackagesIntoTransaction(const QStringList &pkgNames)
+{
+  insertPackagesIntoTransaction(pkgNames, false);
 }
 
 /*
- * Inserts the given package into the Install parent item of the Transaction treeview
+ * Inserts a batch of packages ("repo/name" or just "name") into the Remove or Install parent item.
+ * A package queued in the other parent is moved. Membership is checked in the queue hashes and
+ * the view is updated only once, after the whole batch
  */
-void MainWindow::insertInstallPackageIntoTransaction(const QString &pkgName)
+void MainWindow::insertPackagesIntoTransaction(const QStringList &pkgNames, bool toRemove)
 {
   QTreeView *tvTransaction =
       ui->twProperties->widget(ctn_TABINDEX_TRANSACTION)->findChild<QTreeView*>("tvTransaction");
-  QStandardItem * siInstallParent = getInstallTransactionParentItem();
-  QStandardItem * siPackageToInstall = new QStandardItem(IconHelper::getIconInstallItem(), pkgName);
-  QStandardItem * siRemoveParent = getRemoveTransactionParentItem();
-  QStandardItemModel *sim = qobject_cast<QStandardItemModel *>(siInstallParent->model());
-  QList<QStandardItem *> foundItems = sim->findItems(pkgName, Qt::MatchRecursive | Qt::MatchExactly);
+  QStandardItem * siParent = toRemove ? getRemoveTransactionParentItem() : getInstallTransactionParentItem();
+  QStandardItem * siOtherParent = toRemove ? getInstallTransactionParentItem() : getRemoveTransactionParentItem();
+  QHash<QString, QStandardItem *> &queue = toRemove ? m_removeQueue : m_installQueue;
+  QHash<QString, QStandardItem *> &otherQueue = toRemove ? m_installQueue : m_removeQueue;
+  QList<QStandardItem *> newItems;
 
-  if (foundItems.size() == 0)
+  m_transactionBatch = true;
+  tvTransaction->setUpdatesEnabled(false);
+
+  foreach(QString pkgName, pkgNames)
   {
     int slash = pkgName.indexOf("/");
     QString pkg = pkgName.mid(slash+1);
-    QList<QStandardItem *> aux = sim->findItems(pkg, Qt::MatchRecursive | Qt::MatchExactly);
 
-    if (aux.count() > 0) siRemoveParent->removeRow(aux.at(0)->row());
-    siInstallParent->appendRow(siPackageToInstall);
-  }
-  else if (foundItems.size() == 1 && foundItems.at(0)->parent() == siRemoveParent)
-  {
-    siRemoveParent->removeRow(foundItems.at(0)->row());
-    siInstallParent->appendRow(siPackageToInstall);
+    if (queue.contains(pkg)) continue;
+
+    //tvTransactionRowsAboutToBeRemoved() takes it out of the other queue
+    QStandardItem * siOther = otherQueue.value(pkg);
+    if (siOther != NULL) siOtherParent->removeRow(siOther->row());
+
+    QStandardItem * siPackage = new QStandardItem(
+          toRemove ? IconHelper::getIconRemoveItem() : IconHelper::getIconInstallItem(), pkg);
+    siPackage->setData(pkg, ctn_PACKAGE_NAME_ROLE);
+
+    queue.insert(pkg, siPackage);
+    newItems.append(siPackage);
   }
 
+  if (!newItems.isEmpty()) siParent->appendRows(newItems);
+
+  m_transactionBatch = false;
+  tvTransactionRowsChanged(siOtherParent->index());
+  tvTransactionRowsChanged(siParent->index());
+
   ui->twProperties->setCurrentIndex(ctn_TABINDEX_TRANSACTION);
   tvTransaction->expandAll();
+  tvTransaction->setUpdatesEnabled(true);
   changeTransactionActionsState();
 }
 
@@ -266,6 +281,7 @@ void MainWindow::insertIntoRemovePackage()
 
   ensureTabVisible(ctn_TABINDEX_TRANSACTION);
   QModelIndexList selectedRows = ui->tvPackages->selectionModel()->selectedRows();
+  QStringList targets;
 
   //First, let's see if we are dealing with a package group
   if(!isAllCategoriesSelected())
@@ -313,8 +329,10 @@ void MainWindow::insertIntoRemovePackage()
         }
       }*/
 
-    insertRemovePackageIntoTransaction(package->repository + "/" + package->name);
+    targets.append(package->repository + "/" + package->name);
   }
+
+  insertRemovePackagesIntoTransaction(targets);
 }
 
 /*
@@ -335,6 +353,7 @@ void MainWindow::insertIntoInstallPackage()
   qApp->processEvents();
   ensureTabVisible(ctn_TABINDEX_TRANSACTION);
   QModelIndexList selectedRows = ui->tvPackages->selectionModel()->selectedRows();
+  QStringList targets;
 
   foreach(QModelIndex item, selectedRows)
   {
@@ -344,8 +363,10 @@ void MainWindow::insertIntoInstallPackage()
       continue;
     }
 
-    insertInstallPackageIntoTransaction(package->name);
+    targets.append(package->name);
   }
+
+  insertInstallPackagesIntoTransaction(targets);
 }
 
 /*
@@ -353,16 +374,7 @@ void MainWindow::insertIntoInstallPackage()
  */
 bool MainWindow::isPackageInInstallTransaction(const QString &pkgName)
 {
-  QStandardItem * siInstallParent = getInstallTransactionParentItem();
-  QStandardItemModel *sim = qobject_cast<QStandardItemModel *>(siInstallParent->model());
-  const PackageRepository::PackageData*const package = m_packageRepo.getFirstPackageByName(pkgName);
-  QString repo;
-
-  if (package != NULL) repo = package->repository;
-
-  QList<QStandardItem *> foundItems = sim->findItems(repo + "/" + pkgName, Qt::MatchRecursive | Qt::MatchExactly);
-
-  return (foundItems.size() > 0);
+  return m_installQueue.contains(pkgName);
 }
 
 /*
@@ -370,11 +382,7 @@ bool MainWindow::isPackageInInstallTransaction(const QString &pkgName)
  */
 bool MainWindow::isPackageInRemoveTransaction(const QString &pkgName)
 {
-  QStandardItem * siRemoveParent = getRemoveTransactionParentItem();
-  QStandardItemModel *sim = qobject_cast<QStandardItemModel *>(siRemoveParent->model());
-  QList<QStandardItem *> foundItems = sim->findItems(pkgName, Qt::MatchRecursive | Qt::MatchExactly);
-
-  return (foundItems.size() > 0);
+  return m_removeQueue.contains(pkgName);
 }
 
 /*
@@ -422,10 +430,7 @@ void MainWindow::insertIntoInstallPackageOptDeps(const QString &packageName)
     if (msd->exec() == QMessageBox::Ok)
     {
       selectedPackages = msd->getSelectedPackages();
-      foreach(QString pkg, selectedPackages)
-      {
-        insertInstallPackageIntoTransaction(pkg);
-      }
+      insertInstallPackagesIntoTransaction(selectedPackages);
     }
 
     delete msd;
@@ -482,10 +487,7 @@ bool MainWindow::insertIntoRemovePackageDeps(const QStringList &dependencies)
     if (res == QMessageBox::Ok)
     {
       selectedPackages = msd->getSelectedPackages();
-      foreach(QString pkg, selectedPackages)
-      {
-        insertRemovePackageIntoTransaction(pkg);
-      }
+      insertRemovePackagesIntoTransaction(selectedPackages);
     }
 
     delete msd;
@@ -564,31 +566,307 @@ void MainWindow::tvTransactionRowsChanged(const QModelIndex& parent)
       tvTransactionAdjustItemText(itemRemove);
     }
     else itemRemove->setText(StrConstants::getTransactionRemoveText());
+
+    refreshRemovalClosure();
   }
   else if (item == itemInstall)
   {
-    if (item->rowCount() > 0)
-    {
-      itemInstall->setText(StrConstants::getTransactionInstallText() + " (" + count + ")");
-      tvTransactionAdjustItemText(itemInstall);
-    }
-    else itemInstall->setText(StrConstants::getTransactionInstallText());
+    refreshInstallClosure();
+    refreshInstallTransactionText();
   }
 }
 
+/*
+ * Starts computing (in a worker thread) the recursive removal list of the packages in the Remove queue
+ */
+void MainWindow::refreshRemovalClosure()
+{
+  QString listOfTargets = getTobeRemovedPackages();
+  if (listOfTargets == m_removalClosureTargets) return;
+
+  m_removalClosureTargets = listOfTargets;
+  m_removalVerificationTargets.clear();
+  m_removalClosure.clear();
+  m_removalVerificationTimer->stop();
+  getRemoveTransactionParentItem()->setToolTip("");
+
+  if (listOfTargets.isEmpty()) return;
+
+  QFuture<RemovalClosure> f;
+  f = QtConcurrent::run(getRemovalClosure, listOfTargets);
+  g_fwRemovalClosure.setFuture(f);
+}
+
+/*
+ * The in-memory removal list is ready: show it and, once the Remove queue settles down,
+ * let "xbps-remove -n" verify it in background
+ */
+void MainWindow::onRemovalClosureComputed()
+{
+  RemovalClosure closure = g_fwRemovalClosure.result();
+  if (closure.targets != m_removalClosureTargets) return;
+
+  m_removalClosure = closure.packages;
+  getRemoveTransactionParentItem()->setToolTip(
+        StrConstants::getRemovePackages(m_removalClosure.count()) + ":\n" + m_removalClosure.join("\n"));
+
+  m_removalVerificationTimer->start();
+}
+
+/*
+ * Runs only one "xbps-remove -n" at a time. If one is still running, onRemovalClosureVerified()
+ * starts the next
+ */
+void MainWindow::startRemovalVerification()
+{
+  if (m_removalClosureTargets.isEmpty() || m_removalVerificationTargets == m_removalClosureTargets) return;
+  if (g_fwRemovalVerification.isRunning()) return;
+
+  QFuture<RemovalClosure> f;
+  f = QtConcurrent::run(verifyRemovalClosure, m_removalClosureTargets);
+  g_fwRemovalVerification.setFuture(f);
+}
+
+/*
+ * "xbps-remove -n" has the final word about the removal list, as long as it's about the current queue
+ */
+void MainWindow::onRemovalClosureVerified()
+{
+  RemovalClosure verified = g_fwRemovalVerification.result();
+
+  if (verified.targets != m_removalClosureTargets)
+  {
+    //The Remove queue changed while xbps-remove was running
+    if (!m_removalVerificationTimer->isActive() && !g_fwRemovalClosure.isRunning())
+      startRemovalVerification();
+
+    return;
+  }
+
+  if (verified.packages != m_removalClosure)
+  {
+    if (m_debugInfo)
+      std::cout << "Removal list differs from xbps-remove dry run: " <<
+                   m_removalClosure.count() << " x " << verified.packages.count() << std::endl;
+
+    m_removalClosure = verified.packages;
+    getRemoveTransactionParentItem()->setToolTip(
+          StrConstants::getRemovePackages(m_removalClosure.count()) + ":\n" + m_removalClosure.join("\n"));
+  }
+
+  m_removalVerificationTargets = verified.targets;
+}
+
+/*
+ * Starts computing (in a worker thread) the install list and sizes of the packages in the Install queue
+ */
+void MainWindow::refreshInstallClosure()
+{
+  QString listOfTargets = getTobeInstalledPackages();
+  if (listOfTargets == m_installClosureTargets) return;
+
+  m_installClosureTargets = listOfTargets;
+  m_installVerificationTargets.clear();
+  delete m_installClosure.packages;
+  m_installClosure.packages = NULL;
+  m_installVerificationTimer->stop();
+  getInstallTransactionParentItem()->setToolTip("");
+
+  if (listOfTargets.isEmpty()) return;
+
+  QFuture<InstallClosureInfo> f;
+  f = QtConcurrent::run(getInstallClosure, listOfTargets);
+  g_fwInstallClosure.setFuture(f);
+}
+
+/*
+ * Shows the install list and sizes of the Install queue in the tooltip of its parent item
+ */
+static void setInstallClosureToolTip(QStandardItem *item, const TransactionInfo &ti)
+{
+  QString toolTip = StrConstants::getRetrievePackages(ti.packages->count()) + "\n" +
+      StrConstants::getDownloadSize() + ": " + ti.sizeToDownload;
+
+  if (!ti.sizeToInstall.isEmpty())
+    toolTip += "\n" + StrConstants::getInstalledSize() + ": " + ti.sizeToInstall;
+
+  item->setToolTip(toolTip + "\n\n" + ti.packages->join("\n"));
+}
+
+/*
+ * Shows the package count of the Install queue and, when they are known, its download and installed sizes
+ */
+void MainWindow::refreshInstallTransactionText()
+{
+  QStandardItem *itemInstall = getInstallTransactionParentItem();
+
+  if (itemInstall->rowCount() == 0)
+  {
+    itemInstall->setText(StrConstants::getTransactionInstallText());
+    return;
+  }
+
+  QString text = StrConstants::getTransactionInstallText() + " (" + QString::number(itemInstall->rowCount()) + ")";
+
+  if (m_installClosure.packages != NULL)
+  {
+    text += "   " + StrConstants::getDownloadSize() + ": " + m_installClosure.sizeToDownload;
+
+    if (!m_installClosure.sizeToInstall.isEmpty())
+      text += "   " + StrConstants::getInstalledSize() + ": " + m_installClosure.sizeToInstall;
+  }
+
+  itemInstall->setText(text);
+  tvTransactionAdjustItemText(itemInstall);
+}
+
+/*
+ * Keeps the given install list as the one of the Install queue
+ */
+void MainWindow::setInstallClosure(const TransactionInfo &ti)
+{
+  delete m_installClosure.packages;
+  m_installClosure = ti;
+  setInstallClosureToolTip(getInstallTransactionParentItem(), m_installClosure);
+  refreshInstallTransactionText();
+}
+
+/*
+ * The install list is ready: show it and, unless it already came from it, let "xbps-install -n"
+ * verify it in background once the Install queue settles down
+ */
+void MainWindow::onInstallClosureComputed()
+{
+  InstallClosureInfo closure = g_fwInstallClosure.result();
+
+  if (closure.targets != m_installClosureTargets)
+  {
+    delete closure.info.packages;
+    return;
+  }
+
+  setInstallClosure(closure.info);
+
+  if (closure.verified)
+  {
+    m_installVerificationTargets = closure.targets;
+    return;
+  }
+
+  m_installVerificationTimer->start();
+}
+
+/*
+ * Runs only one "xbps-install -n" at a time. If one is still running, onInstallClosureVerified()
+ * starts the next
+ */
+void MainWindow::startInstallVerification()
+{
+  if (m_installClosureTargets.isEmpty() || m_installClosure.packages == NULL ||
+      m_installVerificationTargets == m_installClosureTargets) return;
+  if (g_fwInstallVerification.isRunning()) return;
+
+  QFuture<InstallClosureInfo> f;
+  f = QtConcurrent::run(verifyInstallClosure, m_installClosureTargets);
+  g_fwInstallVerification.setFuture(f);
+}
+
+/*
+ * "xbps-install -n" has the final word about the install list and its sizes
+ */
+void MainWindow::onInstallClosureVerified()
+{
+  InstallClosureInfo closure = g_fwInstallVerification.result();
+  TransactionInfo verified = closure.info;
+
+  //The queue has changed while "xbps-install -n" was running
+  if (closure.targets != m_installClosureTargets || m_installClosure.packages == NULL)
+  {
+    delete verified.packages;
+
+    if (!m_installVerificationTimer->isActive() && !g_fwInstallClosure.isRunning())
+      startInstallVerification();
+
+    return;
+  }
+
+  //Without pkgdb, the dry run can't tell the installed size: keep the graph's figure
+  if (verified.sizeToInstall.isEmpty())
+  {
+    verified.sizeToInstall = m_installClosure.sizeToInstall;
+    verified.installedBytesDelta = m_installClosure.installedBytesDelta;
+  }
+
+  if (*verified.packages != *m_installClosure.packages ||
+      verified.downloadBytes != m_installClosure.downloadBytes ||
+      verified.installedBytesDelta != m_installClosure.installedBytesDelta)
+  {
+    if (m_debugInfo)
+      std::cout << "Install list differs from xbps-install dry run: " <<
+                   m_installClosure.packages->count() << " x " << verified.packages->count() << " packages, " <<
+                   m_installClosure.downloadBytes << " x " << verified.downloadBytes << " download bytes, " <<
+                   m_installClosure.installedBytesDelta << " x " << verified.installedBytesDelta <<
+                   " installed bytes" << std::endl;
+
+    setInstallClosure(verified);
+  }
+  else
+  {
+    delete verified.packages;
+  }
+
+  m_installVerificationTargets = closure.targets;
+}
+
+/*
+ * Returns the transaction information of the Install queue: the one computed in background when
+ * it's up to date, or the result of the "xbps-install -n" dry run otherwise
+ */
+TransactionInfo MainWindow::getInstallTransactionInfo()
+{
+  if (m_installClosure.packages != NULL && m_installClosureTargets == getTobeInstalledPackages())
+  {
+    TransactionInfo res = m_installClosure;
+    res.packages = new QStringList(*m_installClosure.packages);
+    return res;
+  }
+
+  return g_fwTargetUpgradeList.result();
+}
+
 /*
  * SLOT called each time some item is inserted into tvTransaction
  */
 void MainWindow::tvTransactionRowsInserted(const QModelIndex& parent, int, int)
 {
+  if (m_transactionBatch) return;
   tvTransactionRowsChanged(parent);
 }
 
+/*
+ * SLOT called before items are removed from tvTransaction: takes them out of the queue hashes
+ */
+void MainWindow::tvTransactionRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+  QStandardItem *item = m_modelTransaction->itemFromIndex(parent);
+  QHash<QString, QStandardItem *> *queue = NULL;
+
+  if (item == getRemoveTransactionParentItem()) queue = &m_removeQueue;
+  else if (item == getInstallTransactionParentItem()) queue = &m_installQueue;
+  else return;
+
+  for (int row = first; row <= last; ++row)
+  {
+    queue->remove(item->child(row)->text());
+  }
+}
+
 /*
  * SLOT called each time some item is removed from tvTransaction
  */
 void MainWindow::tvTransactionRowsRemoved(const QModelIndex& parent, int, int)
 {
+  if (m_transactionBatch) return;
   tvTransactionRowsChanged(parent);
 }
 
@@ -738,9 +1016,60 @@ void MainWindow::prepareTargetUpgradeList(const QString& pkgName, CommandExecuti
  */
 void MainWindow::doPreSystemUpgrade()
 {
+  TraceSpan span("MainWindow::doPreSystemUpgrade");
+
+  //The notifier already did the dry run for us
+  if (hasUpgradePlan())
+  {
+    toggleSystemActions(false);
+    doSystemUpgrade();
+    return;
+  }
+
   prepareTargetUpgradeList();
 }
 
+/*
+ * Keeps the system upgrade plan sent by the notifier, so the upgrade dialog doesn't need a dry run
+ */
+void MainWindow::setUpgradePlan(const QString &message)
+{
+  TransactionInfo ti;
+  QString stamp;
+
+  if (!PackageStateCache::decodeUpgradePlan(message, ti, stamp)) return;
+
+  delete m_upgradePlan.packages;
+  m_upgradePlan = ti;
+  m_upgradePlanStamp = stamp;
+}
+
+/*
+ * Returns true if we hold a plan computed for the current pkgdb and repodata
+ */
+bool MainWindow::hasUpgradePlan()
+{
+  return (m_upgradePlan.packages != NULL && m_upgradePlanStamp == PackageStateCache::getStamp());
+}
+
+/*
+ * Hands over the plan sent by the notifier (if it's still valid) and forgets it
+ */
+bool MainWindow::takeUpgradePlan(TransactionInfo &ti)
+{
+  if (m_upgradePlan.packages == NULL) return false;
+
+  bool valid = hasUpgradePlan();
+
+  if (valid)
+    ti = m_upgradePlan;
+  else
+    delete m_upgradePlan.packages;
+
+  m_upgradePlan.packages = NULL;
+  return valid;
+}
+
 /*
  * Does a system upgrade with "pacman -Su" !
  */
@@ -764,7 +1093,9 @@ void MainWindow::doSystemUpgrade(SystemUpgradeOptions systemUpgradeOptions)
   m_progressWidget->setRange(0, 100);
 
   //Shows a dialog indicating the targets needed to be retrieved and asks for the user's permission.
-  TransactionInfo ti = g_fwTargetUpgradeList.result(); //Package::getTargetUpgradeList();
+  TransactionInfo ti;
+  if (!takeUpgradePlan(ti))
+    ti = g_fwTargetUpgradeList.result(); //Package::getTargetUpgradeList();
   QStringList *targets = ti.packages;
 
   //There are no new updates to install!
@@ -850,6 +1181,14 @@ void MainWindow::doSystemUpgrade(SystemUpgradeOptions systemUpgradeOptions)
 void MainWindow::doPreRemoveAndInstall()
 {
   QString listOfInstallTargets = getTobeInstalledPackages();
+
+  //The install list was already computed in background while the user filled the queue
+  if (m_installClosure.packages != NULL && m_installClosureTargets == listOfInstallTargets)
+  {
+    doRemoveAndInstall();
+    return;
+  }
+
   prepareTargetUpgradeList(listOfInstallTargets, ectn_REMOVE_INSTALL);
 }
 
@@ -859,6 +1198,7 @@ void MainWindow::doPreRemoveAndInstall()
  */
 void MainWindow::doRemoveAndInstall()
 {
+  TraceSpan span("MainWindow::doRemoveAndInstall");
   m_progressWidget->setRange(0, 100);
   QString listOfRemoveTargets = getTobeRemovedPackages();
   QString removeList;
@@ -873,7 +1213,7 @@ void MainWindow::doRemoveAndInstall()
   }
 
   QString listOfInstallTargets = getTobeInstalledPackages();
-  TransactionInfo ti = g_fwTargetUpgradeList.result();
+  TransactionInfo ti = getInstallTransactionInfo();
   QStringList *installTargets = ti.packages;
   QString ds = ti.sizeToDownload;
 
@@ -925,6 +1265,8 @@ void MainWindow::doRemoveAndInstall()
     if (m_debugInfo)
       m_xbpsExec->setDebugMode(true);
 
+    m_xbpsExec->setInstalledPackages(m_packageRepo.getInstalledPackageNames());
+
     QObject::connect(m_xbpsExec, SIGNAL( finished ( int, QProcess::ExitStatus )),
                      this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
 
@@ -956,20 +1298,41 @@ void MainWindow::doRemoveAndInstall()
  */
 void MainWindow::doRemove()
 {
+  TraceSpan span("MainWindow::doRemove");
   m_progressWidget->setRange(0, 100);
   QString listOfTargets = getTobeRemovedPackages();
-  QStringList *_targets = Package::getTargetRemovalList(listOfTargets);
-  listOfTargets = "";      
+
+  //The removal list is usually ready by now, computed while the user filled the Remove queue
+  refreshRemovalClosure();
+  g_fwRemovalClosure.waitForFinished();
+
+  QStringList _targets;
+
+  if (m_removalVerificationTargets == listOfTargets)
+  {
+    _targets = m_removalClosure;
+  }
+  else if (!listOfTargets.isEmpty())
+  {
+    RemovalClosure closure = g_fwRemovalClosure.result();
+
+    if (closure.targets == listOfTargets)
+      _targets = closure.packages;
+    else
+      _targets = verifyRemovalClosure(listOfTargets).packages;
+  }
+
+  listOfTargets = "";
   QString list;
 
-  if (_targets->count() == 0)
+  if (_targets.count() == 0)
   {
     QMessageBox::warning(
           this, StrConstants::getAttention(), StrConstants::getWarnTransactionAborted(), QMessageBox::Ok);
     return;
   }
 
-  foreach(QString target, *_targets)
+  foreach(QString target, _targets)
   {
     list = list + target + "\n";
     listOfTargets += target + " ";
@@ -978,14 +1341,14 @@ void MainWindow::doRemove()
   TransactionDialog question(this);
 
   //Shows a dialog indicating the targets which will be removed and asks for the user's permission.  
-  if(_targets->count()==1)
+  if(_targets.count()==1)
   {
     question.setText(StrConstants::getRemovePackage());
   }
   else
-    question.setText(StrConstants::getRemovePackages(_targets->count()));
+    question.setText(StrConstants::getRemovePackages(_targets.count()));
 
-  if (getNumberOfTobeRemovedPackages() < _targets->count())
+  if (getNumberOfTobeRemovedPackages() < _targets.count())
     question.setWindowTitle(StrConstants::getWarning());
   else
     question.setWindowTitle(StrConstants::getConfirmation());
@@ -1005,6 +1368,8 @@ void MainWindow::doRemove()
     if (m_debugInfo)
       m_xbpsExec->setDebugMode(true);
 
+    m_xbpsExec->setInstalledPackages(m_packageRepo.getInstalledPackageNames());
+
     QObject::connect(m_xbpsExec, SIGNAL( finished ( int, QProcess::ExitStatus )),
                      this, SLOT( pacmanProcessFinished(int, QProcess::ExitStatus) ));
     QObject::connect(m_xbpsExec, SIGNAL(percentage(int)), this, SLOT(incrementPercentage(int)));
@@ -1037,6 +1402,14 @@ void MainWindow::doRemove()
 void MainWindow::doPreInstall()
 {
   QString listOfTargets = getTobeInstalledPackages();
+
+  //The install list was already computed in background while the user filled the queue
+  if (m_installClosure.packages != NULL && m_installClosureTargets == listOfTargets)
+  {
+    doInstall();
+    return;
+  }
+
   prepareTargetUpgradeList(listOfTargets, ectn_INSTALL);
 }
 
@@ -1045,10 +1418,11 @@ void MainWindow::doPreInstall()
  */
 void MainWindow::doInstall()
 {
+  TraceSpan span("MainWindow::doInstall");
   m_progressWidget->setRange(0, 100);
   QString listOfTargets = getTobeInstalledPackages();
 
-  TransactionInfo ti = g_fwTargetUpgradeList.result();
+  TransactionInfo ti = getInstallTransactionInfo();
   QStringList *targets = ti.packages;
 
   if (targets->count() == 0)
@@ -1507,6 +1881,13 @@ void MainWindow::resetTransaction()
   delete m_xbpsExec;
   m_commandExecuting = ectn_NONE;
   disconnect(this, SIGNAL(buildPackageListDone()), this, SLOT(resetTransaction()));
+
+  //The notifier asked for an upgrade while this transaction was running
+  if (m_callSystemUpgradeAfterTransaction)
+  {
+    m_callSystemUpgradeAfterTransaction = false;
+    doPreSystemUpgrade();
+  }
 }
 
 /*
@@ -18,12 +18,14 @@
 *
 */
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 
 #include "packagemodel.h"
 #include "src/uihelper.h"
 #include "src/strconstants.h"
+#include "src/tracer.h"
 
 #include <QRegularExpression>
 #include <QDebug>
@@ -32,8 +34,14 @@
  * The specific model which abstracts the package list data seem in the main treeview
  */
 
+struct TNameSort {
+  bool operator()(const PackageRepository::PackageData* a, const PackageRepository::PackageData* b) const {
+    return a->name < b->name;
+  }
+};
+
 PackageModel::PackageModel(const PackageRepository& repo, QObject *parent)
-: QAbstractItemModel(parent), m_installedPackagesCount(0), m_showColumnPopularity(false), m_packageRepo(repo),
+: QAbstractItemModel(parent), m_installedPackagesCount(0), m_resetPending(false), m_showColumnPopularity(false), m_packageRepo(repo),
   m_sortOrder(Qt::AscendingOrder), m_sortColumn(1), m_filterPackagesInstalled(false),
   m_filterPackagesNotInstalled(false), m_filterPackagesNotInThisGroup(""),
   m_filterColumn(-1), m_filterRegExp("", Qt::CaseInsensitive, QRegExp::RegExp),
@@ -187,42 +195,18 @@ void PackageModel::beginResetRepository()
 
 void PackageModel::endResetRepository()
 {
+  TraceSpan span("PackageModel::endResetRepository");
   m_installedPackagesCount = 0;
   const QList<PackageRepository::PackageData*>& data = m_packageRepo.getPackageList(m_filterPackagesNotInThisGroup);
   m_listOfPackages.reserve(data.size());
 
   for (QList<PackageRepository::PackageData*>::const_iterator it = data.begin(); it != data.end(); ++it)
   {
-    //if (m_filterPackagesNotInstalled && (*it)->installed()) continue;
-    //else if (m_filterPackagesInstalled && !(*it)->installed()) continue;
-
-    if (!m_filterPackagesNotInThisRepo.isEmpty() && (*it)->repository != m_filterPackagesNotInThisRepo) continue;
-
-    if (m_filterRegExp.isEmpty()) {
+    if (acceptsPackage(**it))
+    {
       m_listOfPackages.push_back(*it);
       if ((*it)->installed()) m_installedPackagesCount++;
     }
-    else {
-      switch (m_filterColumn) {
-      case ctn_PACKAGE_NAME_COLUMN:
-        if (m_filterRegExp.indexIn((*it)->name) != -1)
-        {
-          m_listOfPackages.push_back(*it);
-          if ((*it)->installed()) m_installedPackagesCount++;
-        }
-        break;
-      case ctn_PACKAGE_DESCRIPTION_FILTER_NO_COLUMN:
-        if (m_filterRegExp.indexIn((*it)->comment) != -1)
-        {
-          m_listOfPackages.push_back(*it);
-          if ((*it)->installed()) m_installedPackagesCount++;
-        }
-        break;
-      default:
-        m_listOfPackages.push_back(*it);
-        if ((*it)->installed()) m_installedPackagesCount++;
-      }
-    }
   }
 
   m_columnSortedlistOfPackages.reserve(data.size());
@@ -231,6 +215,183 @@ void PackageModel::endResetRepository()
   endResetModel();
 }
 
+/*
+ * Returns true if the package passes the repository and the name/description filters
+ */
+bool PackageModel::acceptsPackage(const PackageRepository::PackageData& package) const
+{
+  //if (m_filterPackagesNotInstalled && package.installed()) return false;
+  //else if (m_filterPackagesInstalled && !package.installed()) return false;
+
+  if (!m_filterPackagesNotInThisRepo.isEmpty() && package.repository != m_filterPackagesNotInThisRepo) return false;
+  if (m_filterRegExp.isEmpty()) return true;
+
+  switch (m_filterColumn) {
+  case ctn_PACKAGE_NAME_COLUMN:
+    return (m_filterRegExp.indexIn(package.name) != -1);
+  case ctn_PACKAGE_DESCRIPTION_FILTER_NO_COLUMN:
+    return (m_filterRegExp.indexIn(package.comment) != -1);
+  default:
+    return true;
+  }
+}
+
+/*
+ * The repository is about to delete these packages: their rows go away one by one,
+ * so the view keeps its selection and scroll position
+ */
+void PackageModel::removePackages(const PackageRepository::TListOfPackages& removed)
+{
+  TraceSpan span("PackageModel::removePackages");
+
+  //Group lists are rebuilt by the repository, so a group filtered view is simply reset
+  if (!m_filterPackagesNotInThisGroup.isEmpty())
+  {
+    beginResetRepository();
+    m_resetPending = true;
+    return;
+  }
+
+  for (PackageRepository::TListOfPackages::const_iterator it = removed.begin(); it != removed.end(); ++it)
+  {
+    int position = m_columnSortedlistOfPackages.indexOf(*it);
+    if (position != -1) removePackageAt(position);
+  }
+}
+
+/*
+ * The repository updated "changed" in place and created "added": each one is moved, inserted,
+ * removed or just repainted, depending on the filters and on its new place in the sort order
+ */
+void PackageModel::updatePackages(const PackageRepository::TListOfPackages& changed,
+                                  const PackageRepository::TListOfPackages& added)
+{
+  TraceSpan span("PackageModel::updatePackages");
+
+  if (m_resetPending)
+  {
+    m_resetPending = false;
+    endResetRepository();
+    return;
+  }
+
+  //Until it's visited, a changed package may sit out of sort order
+  QSet<const PackageRepository::PackageData*> misplaced;
+  for (PackageRepository::TListOfPackages::const_iterator it = changed.begin(); it != changed.end(); ++it)
+  {
+    misplaced.insert(*it);
+  }
+
+  for (PackageRepository::TListOfPackages::const_iterator it = changed.begin(); it != changed.end(); ++it)
+  {
+    misplaced.remove(*it);
+    updatePackage(*it, misplaced);
+  }
+
+  for (PackageRepository::TListOfPackages::const_iterator it = added.begin(); it != added.end(); ++it)
+  {
+    insertPackage(*it, misplaced);
+  }
+
+  countInstalledPackages();
+}
+
+/*
+ * Maps a position of m_columnSortedlistOfPackages (with "count" items) to a view row
+ */
+int PackageModel::rowOfSortedPosition(int position, int count) const
+{
+  return (m_sortOrder == Qt::AscendingOrder ? position : count - position - 1);
+}
+
+/*
+ * Returns where the package belongs in m_columnSortedlistOfPackages, ignoring itself and the misplaced ones
+ */
+int PackageModel::findSortedPosition(const PackageRepository::PackageData* package,
+                                     const QSet<const PackageRepository::PackageData*>& misplaced) const
+{
+  for (int c = 0; c < m_columnSortedlistOfPackages.size(); ++c)
+  {
+    const PackageRepository::PackageData* other = m_columnSortedlistOfPackages.at(c);
+    if (other == package || misplaced.contains(other)) continue;
+    if (!lessThan(other, package)) return c;
+  }
+
+  return m_columnSortedlistOfPackages.size();
+}
+
+void PackageModel::removePackageAt(int position)
+{
+  int row = rowOfSortedPosition(position, m_columnSortedlistOfPackages.size());
+  PackageRepository::PackageData* package = m_columnSortedlistOfPackages.at(position);
+
+  beginRemoveRows(QModelIndex(), row, row);
+  m_columnSortedlistOfPackages.removeAt(position);
+  m_listOfPackages.removeOne(package);
+  endRemoveRows();
+}
+
+void PackageModel::insertPackage(PackageRepository::PackageData* package,
+                                 const QSet<const PackageRepository::PackageData*>& misplaced)
+{
+  if (!acceptsPackage(*package)) return;
+
+  int position = findSortedPosition(package, misplaced);
+  int row = (m_sortOrder == Qt::AscendingOrder ? position : m_columnSortedlistOfPackages.size() - position);
+  QList<PackageRepository::PackageData*>::iterator it =
+      std::upper_bound(m_listOfPackages.begin(), m_listOfPackages.end(), package, TNameSort());
+
+  beginInsertRows(QModelIndex(), row, row);
+  m_listOfPackages.insert(it, package);
+  m_columnSortedlistOfPackages.insert(position, package);
+  endInsertRows();
+}
+
+void PackageModel::updatePackage(PackageRepository::PackageData* package,
+                                 const QSet<const PackageRepository::PackageData*>& misplaced)
+{
+  int position = m_columnSortedlistOfPackages.indexOf(package);
+
+  if (position == -1)
+  {
+    insertPackage(package, misplaced);
+    return;
+  }
+  else if (!acceptsPackage(*package))
+  {
+    removePackageAt(position);
+    return;
+  }
+
+  //Names don't change, so only the column sorted list may need to move this package
+  int count = m_columnSortedlistOfPackages.size();
+  int oldRow = rowOfSortedPosition(position, count);
+  m_columnSortedlistOfPackages.removeAt(position);
+  int newPosition = findSortedPosition(package, misplaced);
+  m_columnSortedlistOfPackages.insert(position, package);
+  int newRow = rowOfSortedPosition(newPosition, count);
+
+  if (newRow != oldRow &&
+      beginMoveRows(QModelIndex(), oldRow, oldRow, QModelIndex(), newRow > oldRow ? newRow + 1 : newRow))
+  {
+    m_columnSortedlistOfPackages.removeAt(position);
+    m_columnSortedlistOfPackages.insert(newPosition, package);
+    endMoveRows();
+  }
+
+  emit dataChanged(index(newRow, 0, QModelIndex()), index(newRow, columnCount(QModelIndex()) - 1, QModelIndex()));
+}
+
+void PackageModel::countInstalledPackages()
+{
+  m_installedPackagesCount = 0;
+
+  for (QList<PackageRepository::PackageData*>::const_iterator it = m_listOfPackages.begin(); it != m_listOfPackages.end(); ++it)
+  {
+    if ((*it)->installed()) m_installedPackagesCount++;
+  }
+}
+
 int PackageModel::getPackageCount() const
 {
   return m_listOfPackages.size();
@@ -299,6 +460,7 @@ void PackageModel::applyFilter(const QString& filterExp)
 
 void PackageModel::applyFilter(const int filterColumn, const QString& filterExp)
 {
+  TraceSpan span("PackageModel::applyFilter", filterExp);
   assert(filterExp.isNull() == false);
 //  std::cout << "apply new column filter " << filterColumn << ", " << filterExp.toStdString() << std::endl;
   beginResetRepository();
@@ -477,8 +639,26 @@ struct TSort4 {
   }
 };
 
+/*
+ * The order sort() gives to the current sort column
+ */
+bool PackageModel::lessThan(const PackageRepository::PackageData* a, const PackageRepository::PackageData* b) const
+{
+  switch (m_sortColumn) {
+  case ctn_PACKAGE_ICON_COLUMN:
+    return TSort0()(a, b);
+  case ctn_PACKAGE_VERSION_COLUMN:
+    return TSort2()(a, b);
+  case ctn_PACKAGE_SIZE_COLUMN:
+    return TSort4()(a, b);
+  default:
+    return TNameSort()(a, b);
+  }
+}
+
 void PackageModel::sort()
 {
+  TraceSpan span("PackageModel::sort");
   switch (m_sortColumn) {
   case ctn_PACKAGE_NAME_COLUMN:
     m_columnSortedlistOfPackages = m_listOfPackages;
@@ -64,6 +64,9 @@ public:
 public:
   virtual void beginResetRepository() /*override*/;
   virtual void endResetRepository()   /*override*/;
+  virtual void removePackages(const PackageRepository::TListOfPackages& removed) /*override*/;
+  virtual void updatePackages(const PackageRepository::TListOfPackages& changed,
+                              const PackageRepository::TListOfPackages& added) /*override*/;
 
   // Getter
 public:
@@ -87,8 +90,21 @@ private:
   const QIcon& getIconFor(const PackageRepository::PackageData& package) const;
   void sort();
 
+  bool acceptsPackage(const PackageRepository::PackageData& package) const;
+  bool lessThan(const PackageRepository::PackageData* a, const PackageRepository::PackageData* b) const;
+  int findSortedPosition(const PackageRepository::PackageData* package,
+                         const QSet<const PackageRepository::PackageData*>& misplaced) const;
+  int rowOfSortedPosition(int position, int count) const;
+  void removePackageAt(int position);
+  void insertPackage(PackageRepository::PackageData* package,
+                     const QSet<const PackageRepository::PackageData*>& misplaced);
+  void updatePackage(PackageRepository::PackageData* package,
+                     const QSet<const PackageRepository::PackageData*>& misplaced);
+  void countInstalledPackages();
+
 private:
   int                                     m_installedPackagesCount;
+  bool                                    m_resetPending; // an incremental update fell back to a reset
   bool                                    m_showColumnPopularity;
   const PackageRepository&                m_packageRepo;
   QList<PackageRepository::PackageData*>  m_listOfPackages;             // should be provided sorted by name (by repo)
@@ -20,6 +20,10 @@
 
 #include "package.h"
 #include "unixcommand.h"
+#include "dependencygraph.h"
+#include "packagecacheindex.h"
+#include "searchindex.h"
+#include "tracer.h"
 #include "stdlib.h"
 #include "strconstants.h"
 #include <iostream>
@@ -154,6 +158,17 @@ QString Package::kbytesToSize( float Bytes )
   return res;
 }
 
+/*
+ * Formats a byte count (maybe negative, as a transaction can free space) the same way as kbytesToSize()
+ */
+QString Package::bytesToSize(qlonglong bytes)
+{
+  if (bytes < 0)
+    return "-" + kbytesToSize(-bytes / 1024.0);
+  else
+    return kbytesToSize(bytes / 1024.0);
+}
+
 /*
  * Converts the size in String type to double
  */
@@ -241,6 +256,10 @@ double Package::strToKBytes2(QString size)
  */
 QSet<QString>* Package::getUnrequiredPackageList()
 {
+  TraceSpan span("Package::getUnrequiredPackageList");
+  if (DependencyGraph::instance()->hasPackageDatabase())
+    return DependencyGraph::instance()->getUnrequiredPackageList();
+
   QString pkgName;
   QString unrequiredPkgList = UnixCommand::getUnrequiredPackageList();
   QStringList packageTuples = unrequiredPkgList.split(QRegularExpression("\\n"), QString::SkipEmptyParts);
@@ -264,6 +283,7 @@ QSet<QString>* Package::getUnrequiredPackageList()
  */
 QMap<QString, OutdatedPackageInfo> *Package::getOutdatedStringList()
 {
+  TraceSpan span("Package::getOutdatedStringList");
   QString pkgAux, pkgName;
   QString outPkgList = UnixCommand::getOutdatedPackageList();
   QStringList packageTuples = outPkgList.split(QRegularExpression("\\n"), QString::SkipEmptyParts);
@@ -341,16 +361,17 @@ QStringList *Package::getPackagesOfGroup(const QString &groupName)
  */
 TransactionInfo Package::getTargetUpgradeList(const QString &pkgName)
 {
+  TraceSpan span("Package::getTargetUpgradeList", pkgName);
   QString targets = UnixCommand::getTargetUpgradeList(pkgName);
   QString pkg;
   QStringList infoTuples = targets.split(QRegularExpression("\\n"), QString::SkipEmptyParts);
   TransactionInfo res;
   res.packages = new QStringList();
   int pos;
-  QString strSum;
-  double number;
-  double sum;
+  qlonglong installedBytes = 0;
+  bool hasPackageDatabase = DependencyGraph::instance()->hasPackageDatabase();
 
+  //Each line is "pkgver action arch repository installed-size [download-size]", sizes in bytes
   foreach(QString infoTuple, infoTuples)
   {
     QStringList t = infoTuple.split(" ");
@@ -359,30 +380,25 @@ TransactionInfo Package::getTargetUpgradeList(const QString &pkgName)
     pkg = pkg.left(pos);
     res.packages->append(pkg);
 
-    if (t.size() == 5){
-      QString ds = t.at(4);
-      number = ds.toDouble() / 1024;
+    if (t.size() >= 5){
+      installedBytes += t.at(4).toLongLong();
+      if (hasPackageDatabase) installedBytes -= DependencyGraph::instance()->getInstalledSize(pkg);
     }
 
     if (t.size() == 6){
-      QString ds = t.at(5);
-      number = ds.toDouble() / 1024;
+      res.downloadBytes += t.at(5).toLongLong();
     }
-
-    sum += number;
   }
 
-  if (sum > 1024)
-  {
-    sum /= 1024;
-    strSum = QString::number(sum, 'f', 2) + "MB";
-  }
-  else
+  res.sizeToDownload = bytesToSize(res.downloadBytes);
+
+  //Without pkgdb we can't tell how much the replaced versions took
+  if (hasPackageDatabase)
   {
-    strSum = QString::number(sum, 'f', 2) + "KB";
+    res.installedBytesDelta = installedBytes;
+    res.sizeToInstall = bytesToSize(installedBytes);
   }
 
-  res.sizeToDownload = strSum;
   res.packages->sort();
   return res;
 }
@@ -400,6 +416,7 @@ QString Package::getRemoteFilenameSize(const QString &pkgName)
  */
 QStringList *Package::getTargetRemovalList(const QString &pkgName)
 {
+  TraceSpan span("Package::getTargetRemovalList", pkgName);
   QString targets = UnixCommand::getTargetRemovalList(pkgName);
   QStringList infoTuples = targets.split(QRegularExpression("\\n"), QString::SkipEmptyParts);
   QStringList *res = new QStringList();
@@ -458,10 +475,18 @@ QStringList *Package::getTargetRemovalList(const QString &pkgName)
  */
 QList<PackageListData> * Package::getPackageList(const QString &packageName)
 {
+  return parsePackageList(UnixCommand::getPackageList(packageName));
+}
+
+/*
+ * Parses the output of "xbps-query" used to build the list of packages
+ */
+QList<PackageListData> * Package::parsePackageList(const QString &pkgList)
+{
+  TraceSpan span("Package::parsePackageList");
   QString pkgAux, pkgName, pkgOrigin, pkgVersion, pkgComment, pkgDescription;
   double pkgInstalledSize, pkgDownloadedSize;
   PackageStatus pkgStatus;
-  QString pkgList = UnixCommand::getPackageList(packageName);
   QStringList packageTuples = pkgList.split(QRegularExpression("\\n"), QString::SkipEmptyParts);
   QList<PackageListData> * res = new QList<PackageListData>();
 
@@ -513,6 +538,7 @@ QList<PackageListData> * Package::getPackageList(const QString &packageName)
  */
 QList<PackageListData> * Package::parsePackageTuple(const QStringList &packageTuples, QStringList &packageCache)
 {
+  TraceSpan span("Package::parsePackageTuple");
   Q_UNUSED(packageCache)
 
   QString pkgAux, pkgName, pkgVersion, pkgComment, strStatus, pkgDescription, pkgOrigin;
@@ -567,6 +593,7 @@ QList<PackageListData> * Package::parsePackageTuple(const QStringList &packageTu
  */
 QList<PackageListData> * Package::getRemotePackageList(const QString& searchString)
 {
+  TraceSpan span("Package::getRemotePackageList", searchString);
   QList<PackageListData> * res = new QList<PackageListData>();
   QList<PackageListData> * resComment = new QList<PackageListData>();
   QStringList packageCache;
@@ -574,6 +601,13 @@ QList<PackageListData> * Package::getRemotePackageList(const QString& searchStri
   if (searchString.isEmpty())
     return res;
 
+  if (SearchIndex::instance()->isAvailable())
+  {
+    delete res;
+    delete resComment;
+    return SearchIndex::instance()->search(searchString);
+  }
+
   /*QString pkgList = UnixCommand::getRemotePackageList(searchString, false);
   QStringList packageTuples = pkgList.split(QRegularExpression("\\n"), QString::SkipEmptyParts);
   res = parsePackageTuple(packageTuples, packageCache);*/
@@ -1031,6 +1065,7 @@ QString Package::getComment(const QString &pkgInfo)
  */
 PackageInfoData Package::getInformation(const QString &pkgName, bool foreignPackage)
 {
+  TraceSpan span("Package::getInformation", pkgName);
   PackageInfoData res;
   QString pkgInfo = UnixCommand::getPackageInformation(pkgName, foreignPackage);
 
@@ -1109,7 +1144,12 @@ QString Package::formatDependencies(const QString &dependenciesList, PackageAnch
  */
 QString Package::getDependencies(const QString &pkgName, PackageAnchor pkgAnchorState)
 {
-  QString aux = UnixCommand::getDependenciesList(pkgName);
+  QString aux;
+
+  if (DependencyGraph::instance()->hasPackageDatabase())
+    aux = DependencyGraph::instance()->getDependsOn(pkgName).join("\n");
+  else
+    aux = UnixCommand::getDependenciesList(pkgName);
 
   return formatDependencies(aux, pkgAnchorState);
 }
@@ -1119,11 +1159,40 @@ QString Package::getDependencies(const QString &pkgName, PackageAnchor pkgAnchor
  */
 QString Package::getRemoteDependencies(const QString &pkgName, PackageAnchor pkgAnchorState)
 {
-  QString aux = UnixCommand::getRemoteDependenciesList(pkgName);
+  QString aux;
+
+  if (DependencyGraph::instance()->hasRepositoryIndex())
+    aux = DependencyGraph::instance()->getRemoteDependsOn(pkgName).join("\n");
+  else
+    aux = UnixCommand::getRemoteDependenciesList(pkgName);
 
   return formatDependencies(aux, pkgAnchorState);
 }
 
+/*
+ * Retrieves the installed packages which depend on the given pkgName
+ */
+QString Package::getReverseDependencies(const QString &pkgName, PackageAnchor pkgAnchorState)
+{
+  QStringList names;
+
+  if (DependencyGraph::instance()->hasPackageDatabase())
+  {
+    names = DependencyGraph::instance()->getRequiredBy(pkgName);
+  }
+  else
+  {
+    //"xbps-query -X" prints pkgvers
+    QString pkgvers = UnixCommand::getReverseDependenciesList(pkgName);
+    foreach(QString pkgver, pkgvers.split("\n", QString::SkipEmptyParts))
+    {
+      names.append(DependencyGraph::getNameFromPattern(pkgver.trimmed()));
+    }
+  }
+
+  return formatDependencies(names.join("\n"), pkgAnchorState);
+}
+
 /*
  * Navigate thru directories to build a hierarquic directory list
  */
@@ -1154,16 +1223,29 @@ void Package::navigateThroughDirs(QStringList parts, QStringList& auxList, int i
  */
 QStringList Package::getContents(const QString& pkgName, bool isInstalled)
 {
-  QByteArray result;
+  TraceSpan span("Package::getContents", pkgName);
+  QStringList fileList;
 
   if (isInstalled)
   {
-    result = UnixCommand::getPackageContentsUsingPacman(pkgName);
+    QString aux(UnixCommand::getPackageContentsUsingPacman(pkgName));
+    fileList = aux.split("\n", QString::SkipEmptyParts);
+  }
+  else
+  {
+    //Maybe the package was downloaded to the XBPS cache...
+    fileList = PackageCacheIndex::instance()->getFiles(pkgName);
   }
 
-  QString aux(result);
-  QStringList fileList = aux.split("\n", QString::SkipEmptyParts);
+  return addDirectoriesToFileList(fileList);
+}
 
+/*
+ * Adds every parent directory of the given files to the list and sorts it
+ */
+QStringList Package::addDirectoriesToFileList(QStringList fileList)
+{
+  TraceSpan span("Package::addDirectoriesToFileList");
   //Let's change that listing a bit...
   QStringList auxList;
   foreach(QString file, fileList)
@@ -120,6 +120,11 @@ struct TransactionInfo{
   QStringList *packages;
   QString sizeToInstall;
   QString sizeToDownload;
+  qlonglong downloadBytes;
+  qlonglong installedBytesDelta; //may be negative
+
+  TransactionInfo(): packages(NULL), downloadBytes(0), installedBytesDelta(0){
+  }
 };
 
 struct OutdatedPackageInfo{
@@ -176,6 +181,7 @@ class Package{
     //static QList<PackageListData> *getForeignPackageList();
     static QList<PackageListData> * parsePackageTuple(const QStringList &packageTuples, QStringList &packageCache);
     static QList<PackageListData> *getPackageList(const QString &packageName = "");
+    static QList<PackageListData> *parsePackageList(const QString &pkgList);
 
     //Remote package methods
     static QList<PackageListData> * getRemotePackageList(const QString& searchString);
@@ -187,7 +193,9 @@ class Package{
     static QString formatDependencies(const QString &dependenciesList, PackageAnchor pkgAnchorState = ectn_WITH_PACKAGE_ANCHOR);
     static QString getDependencies(const QString &pkgName, PackageAnchor pkgAnchorState = ectn_WITH_PACKAGE_ANCHOR);
     static QString getRemoteDependencies(const QString &pkgName, PackageAnchor pkgAnchorState = ectn_WITH_PACKAGE_ANCHOR);
+    static QString getReverseDependencies(const QString &pkgName, PackageAnchor pkgAnchorState = ectn_WITH_PACKAGE_ANCHOR);
     static QStringList getContents(const QString &pkgName, bool isInstalled);
+    static QStringList addDirectoriesToFileList(QStringList fileList);
     static QStringList getOptionalDeps(const QString &pkgName);
     static QString getName(const QString &pkgInfo);
     static QString getVersion(const QString &pkgInfo);
@@ -219,6 +227,7 @@ class Package{
     static QString getRemoteHomepage(const QString &pkgName);
     static QString getRemoteFilenameSize(const QString &pkgName);
     static QString kbytesToSize(float Bytes );
+    static QString bytesToSize(qlonglong bytes);
     static double strToKBytes(QString size);
     static double strToKBytes2(QString size);
     static QString makeURLClickable(const QString &information);
@@ -0,0 +1,308 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "packagecacheindex.h"
+#include "constants.h"
+#include "xbpsplist.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+
+const quint32 ctn_PACKAGE_CACHE_INDEX_MAGIC = 0x4f585043; //"OXPC"
+const quint32 ctn_PACKAGE_CACHE_INDEX_VERSION = 1;
+
+/*
+ * Reads the "files.plist" of one archive in a worker thread of the pool
+ */
+class FilesPlistReader: public QRunnable
+{
+private:
+  QString m_archive;
+  QStringList *m_files;
+
+public:
+  FilesPlistReader(const QString &archive, QStringList *files): m_archive(archive), m_files(files) {}
+
+  void run()
+  {
+    *m_files = XBPSPlist::getFileList(XBPSPlist::parse(XBPSPlist::extractFromArchive(m_archive, "./files.plist")));
+  }
+};
+
+/*
+ * The index is loaded at the first query
+ */
+PackageCacheIndex::PackageCacheIndex()
+{
+  m_loaded = false;
+  m_indexing = false;
+}
+
+/*
+ * Returns the single index instance
+ */
+PackageCacheIndex* PackageCacheIndex::instance()
+{
+  static PackageCacheIndex index;
+  return &index;
+}
+
+/*
+ * Path of the file in which the index is saved
+ */
+QString PackageCacheIndex::getIndexFileName()
+{
+  return ctn_OCTOXBPS_CACHE_DIR + QDir::separator() + "cached-packages.idx";
+}
+
+/*
+ * Archives are named "<pkgver>.<arch>.xbps"
+ */
+QString PackageCacheIndex::getPkgverFromArchive(const QString &archive)
+{
+  QString pkgver = archive;
+  pkgver.chop(QString(".xbps").length());
+
+  return pkgver.left(pkgver.lastIndexOf('.'));
+}
+
+/*
+ * Rebuilds the "by package" and "by file" lookups. When the cache holds more than one version
+ * of a package, the newest archive wins
+ */
+void PackageCacheIndex::rebuildLookups()
+{
+  m_packages.clear();
+  m_owners.clear();
+
+  for (QHash<QString, Record>::const_iterator it = m_records.constBegin(); it != m_records.constEnd(); ++it)
+  {
+    QString current = m_packages.value(it.value().pkgName);
+    if (current.isEmpty() || m_records.value(current).modified < it.value().modified)
+      m_packages.insert(it.value().pkgName, it.key());
+  }
+
+  for (QHash<QString, QString>::const_iterator it = m_packages.constBegin(); it != m_packages.constEnd(); ++it)
+  {
+    foreach(QString file, m_records.value(it.value()).files)
+    {
+      m_owners.insert(file, it.key());
+    }
+  }
+}
+
+/*
+ * Loads the file lists saved by a previous run
+ */
+bool PackageCacheIndex::loadFromFile()
+{
+  QFile file(getIndexFileName());
+  if (!file.open(QIODevice::ReadOnly)) return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_0);
+
+  quint32 magic, version;
+  QByteArray compressed;
+  in >> magic >> version >> compressed;
+  if (in.status() != QDataStream::Ok ||
+      magic != ctn_PACKAGE_CACHE_INDEX_MAGIC || version != ctn_PACKAGE_CACHE_INDEX_VERSION) return false;
+
+  QByteArray data = qUncompress(compressed);
+  QDataStream records(data);
+  records.setVersion(QDataStream::Qt_5_0);
+
+  quint32 count;
+  records >> count;
+
+  for (quint32 i = 0; i < count && records.status() == QDataStream::Ok; ++i)
+  {
+    QString archive;
+    Record record;
+    records >> archive >> record.pkgver >> record.modified >> record.size >> record.files;
+
+    record.pkgName = record.pkgver.left(record.pkgver.lastIndexOf('-'));
+    m_records.insert(archive, record);
+  }
+
+  return records.status() == QDataStream::Ok;
+}
+
+/*
+ * Saves the file lists, compressed: paths inside one package share long prefixes
+ */
+void PackageCacheIndex::saveToFile()
+{
+  QByteArray data;
+  QDataStream records(&data, QIODevice::WriteOnly);
+  records.setVersion(QDataStream::Qt_5_0);
+
+  records << quint32(m_records.count());
+  for (QHash<QString, Record>::const_iterator it = m_records.constBegin(); it != m_records.constEnd(); ++it)
+  {
+    records << it.key() << it.value().pkgver << it.value().modified << it.value().size << it.value().files;
+  }
+
+  QDir().mkpath(ctn_OCTOXBPS_CACHE_DIR);
+
+  QSaveFile file(getIndexFileName());
+  if (!file.open(QIODevice::WriteOnly)) return;
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_0);
+  out << ctn_PACKAGE_CACHE_INDEX_MAGIC << ctn_PACKAGE_CACHE_INDEX_VERSION << qCompress(data);
+
+  file.commit();
+}
+
+/*
+ * Reads the archives which appeared (or changed) in the XBPS cache and forgets the deleted ones.
+ * The caller's locker is released while the workers extract, and callers arriving meanwhile
+ * just see the previous file lists
+ */
+void PackageCacheIndex::ensureUpToDate(QMutexLocker &locker)
+{
+  if (m_indexing) return;
+
+  if (!m_loaded)
+  {
+    if (!loadFromFile()) m_records.clear();
+    m_loaded = true;
+    rebuildLookups();
+  }
+
+  QDir cacheDir(ctn_XBPS_CACHE_DIR);
+  QFileInfoList archives = cacheDir.entryInfoList(QStringList() << "*.xbps", QDir::Files);
+  QSet<QString> present;
+  QList<QFileInfo> pending;
+
+  foreach(QFileInfo archive, archives)
+  {
+    present.insert(archive.fileName());
+
+    QHash<QString, Record>::const_iterator it = m_records.constFind(archive.fileName());
+    if (it == m_records.constEnd() || it.value().size != archive.size() ||
+        it.value().modified != archive.lastModified().toMSecsSinceEpoch())
+      pending.append(archive);
+  }
+
+  bool changed = false;
+  foreach(QString archive, m_records.keys())
+  {
+    if (!present.contains(archive))
+    {
+      m_records.remove(archive);
+      changed = true;
+    }
+  }
+
+  if (!pending.isEmpty())
+  {
+    m_indexing = true;
+    locker.unlock();
+
+    QVector<QStringList> files(pending.count());
+    QThreadPool pool;
+
+    for (int i = 0; i < pending.count(); ++i)
+    {
+      pool.start(new FilesPlistReader(pending.at(i).absoluteFilePath(), &files[i]));
+    }
+
+    pool.waitForDone();
+
+    locker.relock();
+    m_indexing = false;
+
+    for (int i = 0; i < pending.count(); ++i)
+    {
+      Record record;
+      record.pkgver = getPkgverFromArchive(pending.at(i).fileName());
+      record.pkgName = record.pkgver.left(record.pkgver.lastIndexOf('-'));
+      record.modified = pending.at(i).lastModified().toMSecsSinceEpoch();
+      record.size = pending.at(i).size();
+      record.files = files.at(i);
+
+      m_records.insert(pending.at(i).fileName(), record);
+    }
+
+    changed = true;
+  }
+
+  if (changed)
+  {
+    rebuildLookups();
+    saveToFile();
+  }
+}
+
+/*
+ * Brings the index up to date with the XBPS cache (meant to run in a background thread)
+ */
+void PackageCacheIndex::update()
+{
+  QMutexLocker locker(&m_mutex);
+  ensureUpToDate(locker);
+}
+
+/*
+ * Returns true if the XBPS cache holds an archive of the given package
+ */
+bool PackageCacheIndex::hasPackage(const QString &pkgName)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureUpToDate(locker);
+
+  return m_packages.contains(pkgName);
+}
+
+/*
+ * Returns the file list of the newest cached archive of the given package
+ */
+QStringList PackageCacheIndex::getFiles(const QString &pkgName)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureUpToDate(locker);
+
+  QString archive = m_packages.value(pkgName);
+  if (archive.isEmpty()) return QStringList();
+
+  return m_records.value(archive).files;
+}
+
+/*
+ * Returns the name of the cached package which ships the given path, or an empty string
+ */
+QString PackageCacheIndex::getOwner(const QString &filePath)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureUpToDate(locker);
+
+  return m_owners.value(filePath);
+}
@@ -0,0 +1,78 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef PACKAGECACHEINDEX_H
+#define PACKAGECACHEINDEX_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+/*
+ * File lists of the packages XBPS downloaded to its cache (ctn_XBPS_CACHE_DIR), installed or not.
+ *
+ * Only the "files.plist" metadata at the start of each ".xbps" archive is read (never the payload),
+ * using a pool of workers. The lists are saved compressed in ctn_OCTOXBPS_CACHE_DIR, so after
+ * a restart only archives added or changed since the last run are read.
+ */
+
+class PackageCacheIndex
+{
+private:
+  struct Record
+  {
+    Record(): modified(0), size(0) {}
+
+    QString pkgName;
+    QString pkgver;
+    qint64 modified; //msecs since epoch
+    qint64 size;
+    QStringList files;
+  };
+
+  QHash<QString, Record> m_records;   //archive file name -> record
+  QHash<QString, QString> m_packages; //package name -> newest archive of it
+  QHash<QString, QString> m_owners;   //file path -> package name
+  bool m_loaded;
+  bool m_indexing;
+
+  QMutex m_mutex;
+
+  PackageCacheIndex();
+
+  void ensureUpToDate(QMutexLocker &locker);
+  void rebuildLookups();
+  bool loadFromFile();
+  void saveToFile();
+
+  static QString getIndexFileName();
+  static QString getPkgverFromArchive(const QString &archive);
+
+public:
+  static PackageCacheIndex* instance();
+
+  void update();
+  bool hasPackage(const QString &pkgName);
+  QStringList getFiles(const QString &pkgName);
+  QString getOwner(const QString &filePath);
+};
+
+#endif // PACKAGECACHEINDEX_H
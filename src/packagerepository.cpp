@@ -20,7 +20,9 @@
 
 #include "strconstants.h"
 #include "packagerepository.h"
+#include "tracer.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <QSet>
@@ -54,7 +56,191 @@ struct EndResetModel {
   }
 };
 
-void PackageRepository::setData(const QList<PackageListData>*const listOfPackages, const QSet<QString>& unrequiredPackages)
+struct TListDataSort {
+  bool operator()(const PackageListData* a, const PackageListData* b) const {
+    return a->name < b->name;
+  }
+};
+
+/*
+ * An incremental refresh is only worth it while few packages differ: beyond this fraction of
+ * the list a full reset is cheaper than row-level notifications
+ */
+static const int ctn_MAX_INCREMENTAL_FRACTION = 4;
+
+/**
+ * @brief replaces the package data with %listOfPackages
+ *
+ * The new list is compared (by name, then by every field) with the current one. When only a few
+ * packages differ, the survivors are updated in place and the depending models get row-level
+ * notifications, so their selection and scroll position are kept. Otherwise everything is rebuilt.
+ * @return true if the data was updated in place, false if the depending models were reset
+ */
+bool PackageRepository::setData(const QList<PackageListData>*const listOfPackages, const QSet<QString>& unrequiredPackages)
+{
+  TraceSpan span("PackageRepository::setData");
+
+  if (m_listOfPackages.isEmpty() || !m_listOfAURPackages.isEmpty())
+  {
+    resetData(listOfPackages, unrequiredPackages);
+    return false;
+  }
+
+  QList<const PackageListData*> sortedList;
+  sortedList.reserve(listOfPackages->size());
+  for (QList<PackageListData>::const_iterator it = listOfPackages->begin(); it != listOfPackages->end(); ++it) {
+    sortedList.push_back(&(*it));
+  }
+  qSort(sortedList.begin(), sortedList.end(), TListDataSort());
+
+  // walk both lists (sorted by name) looking for what differs
+  TListOfPackages removed;
+  TListOfPackages changed;
+  QList<PackageData> changedData;
+  QList<const PackageListData*> added;
+  int maxChanges = m_listOfPackages.size() / ctn_MAX_INCREMENTAL_FRACTION;
+  int i = 0, j = 0;
+
+  while (i < m_listOfPackages.size() || j < sortedList.size())
+  {
+    if (removed.size() + changed.size() + added.size() > maxChanges)
+    {
+      resetData(listOfPackages, unrequiredPackages);
+      return false;
+    }
+
+    if (j == sortedList.size() || (i < m_listOfPackages.size() && m_listOfPackages.at(i)->name < sortedList.at(j)->name)) {
+      removed.push_back(m_listOfPackages.at(i++));
+    }
+    else if (i == m_listOfPackages.size() || sortedList.at(j)->name < m_listOfPackages.at(i)->name) {
+      added.push_back(sortedList.at(j++));
+    }
+    else {
+      PackageData data(*sortedList.at(j), unrequiredPackages.contains(sortedList.at(j)->name) == false);
+      if (*m_listOfPackages.at(i) != data) {
+        changed.push_back(m_listOfPackages.at(i));
+        changedData.push_back(data);
+      }
+      ++i;
+      ++j;
+    }
+  }
+
+  if (removed.isEmpty() && changed.isEmpty() && added.isEmpty()) return true;
+
+  applyChanges(removed, changed, changedData, added, unrequiredPackages);
+  return true;
+}
+
+/**
+ * @brief merges the installed packages that changed outside of a full refresh (pkgdb was written)
+ *
+ * %installedPackages holds the new data of packages that were installed or updated, %removedPackages
+ * the names of packages that went away. Packages whose required flag changed are updated too.
+ * @return false if there are too many changes to be notified row by row (nothing is touched then)
+ */
+bool PackageRepository::updateInstalledPackages(const QList<PackageListData>& installedPackages,
+                                                const QStringList& removedPackages, const QSet<QString>& unrequiredPackages)
+{
+  TraceSpan span("PackageRepository::updateInstalledPackages");
+
+  if (!m_listOfAURPackages.isEmpty()) return false;
+
+  TListOfPackages removed;
+  TListOfPackages changed;
+  QList<PackageData> changedData;
+  QList<const PackageListData*> added;
+  QSet<QString> visited;
+
+  for (QStringList::const_iterator it = removedPackages.begin(); it != removedPackages.end(); ++it) {
+    PackageData*const pkg = getFirstPackageByNameEx(*it);
+    if (pkg != NULL && !visited.contains(pkg->name)) {
+      removed.push_back(pkg);
+      visited.insert(pkg->name);
+    }
+  }
+
+  for (QList<PackageListData>::const_iterator it = installedPackages.begin(); it != installedPackages.end(); ++it) {
+    if (visited.contains(it->name)) continue;
+    visited.insert(it->name);
+
+    PackageData*const pkg = getFirstPackageByNameEx(it->name);
+    if (pkg == NULL) {
+      added.push_back(&(*it));
+      continue;
+    }
+
+    PackageData data(*it, unrequiredPackages.contains(it->name) == false);
+    if (*pkg != data) {
+      changed.push_back(pkg);
+      changedData.push_back(data);
+    }
+  }
+
+  // removing a package may leave its dependencies unrequired (and the other way around)
+  for (TListOfPackages::const_iterator it = m_listOfPackages.begin(); it != m_listOfPackages.end(); ++it) {
+    if (visited.contains((*it)->name)) continue;
+
+    const bool required = unrequiredPackages.contains((*it)->name) == false;
+    if ((*it)->required != required) {
+      PackageData data(**it);
+      data.required = required;
+      changed.push_back(*it);
+      changedData.push_back(data);
+    }
+  }
+
+  if (removed.size() + changed.size() + added.size() > m_listOfPackages.size() / ctn_MAX_INCREMENTAL_FRACTION)
+    return false;
+
+  if (removed.isEmpty() && changed.isEmpty() && added.isEmpty()) return true;
+
+  applyChanges(removed, changed, changedData, added, unrequiredPackages);
+  return true;
+}
+
+/**
+ * @brief deletes %removed, updates %changed with %changedData and creates %added, notifying the depending models row by row
+ */
+void PackageRepository::applyChanges(const TListOfPackages& removed, const TListOfPackages& changed,
+                                     const QList<PackageData>& changedData, const QList<const PackageListData*>& added,
+                                     const QSet<QString>& unrequiredPackages)
+{
+  // groups hold weak pointers, so they must be rebuilt if packages come and go
+  if (!removed.isEmpty() || !added.isEmpty()) {
+    for (QList<Group*>::const_iterator it = m_listOfGroups.begin(); it != m_listOfGroups.end(); ++it) {
+      if (*it != NULL) (*it)->invalidateList();
+    }
+  }
+
+  for (std::vector<IDependency*>::const_iterator it = m_dependingModels.begin(); it != m_dependingModels.end(); ++it) {
+    (*it)->removePackages(removed);
+  }
+  for (TListOfPackages::const_iterator it = removed.begin(); it != removed.end(); ++it) {
+    m_listOfPackages.removeOne(*it);
+    delete *it;
+  }
+
+  for (int c = 0; c < changed.size(); ++c) {
+    *changed.at(c) = changedData.at(c);
+  }
+
+  TListOfPackages addedPackages;
+  for (QList<const PackageListData*>::const_iterator it = added.begin(); it != added.end(); ++it) {
+    PackageData*const pkg = new PackageData(**it, unrequiredPackages.contains((*it)->name) == false);
+    m_listOfPackages.insert(std::upper_bound(m_listOfPackages.begin(), m_listOfPackages.end(), pkg, TSort()), pkg);
+    addedPackages.push_back(pkg);
+  }
+
+  for (std::vector<IDependency*>::const_iterator it = m_dependingModels.begin(); it != m_dependingModels.end(); ++it) {
+    (*it)->updatePackages(changed, addedPackages);
+  }
+}
+
+/**
+ * @brief throws every package away and rebuilds the list from %listOfPackages, resetting the depending models
+ */
+void PackageRepository::resetData(const QList<PackageListData>*const listOfPackages, const QSet<QString>& unrequiredPackages)
 {
 //  std::cout << "received new package list" << std::endl;
 
@@ -216,24 +402,37 @@ const QList<PackageRepository::PackageData*>& PackageRepository::getPackageList(
   else return m_listOfPackages;
 }
 
+/**
+ * @brief m_listOfPackages is kept sorted by name, so a binary search does the job
+ */
 PackageRepository::PackageData* PackageRepository::getFirstPackageByName(const QString name) const
 {
-  for (TListOfPackages::const_iterator it = m_listOfPackages.begin(); it != m_listOfPackages.end(); ++it) {
-    if ((*it)->name == name)
-      return *it;
-  }
+  TListOfPackages::const_iterator it = std::lower_bound(m_listOfPackages.begin(), m_listOfPackages.end(), name, TComp());
+  if (it != m_listOfPackages.end() && (*it)->name == name)
+    return *it;
+
   return NULL;
 }
 
 PackageRepository::PackageData* PackageRepository::getFirstPackageByNameEx(const QString name)
 {
-  for (TListOfPackages::iterator it = m_listOfPackages.begin(); it != m_listOfPackages.end(); ++it) {
-    if ((*it)->name == name)
-      return *it;
-  }
+  TListOfPackages::iterator it = std::lower_bound(m_listOfPackages.begin(), m_listOfPackages.end(), name, TComp());
+  if (it != m_listOfPackages.end() && (*it)->name == name)
+    return *it;
+
   return NULL;
 }
 
+QSet<QString> PackageRepository::getInstalledPackageNames() const
+{
+  QSet<QString> res;
+  for (TListOfPackages::const_iterator it = m_listOfPackages.begin(); it != m_listOfPackages.end(); ++it) {
+    if ((*it)->installed())
+      res.insert((*it)->name);
+  }
+  return res;
+}
+
 /**
  * @brief checks if the repository groups are up to date
  * @param listOfGroups == group-names
@@ -276,6 +475,15 @@ PackageRepository::PackageData::PackageData(const PackageListData& pkg, const bo
 {
 }
 
+bool PackageRepository::PackageData::operator==(const PackageData& other) const
+{
+  return required == other.required && name == other.name && repository == other.repository &&
+      origin == other.origin && version == other.version && description == other.description &&
+      outdatedVersion == other.outdatedVersion && downloadSize == other.downloadSize &&
+      installedSize == other.installedSize && status == other.status && comment == other.comment &&
+      www == other.www && categories == other.categories;
+}
+
 //////// PackageRepository::Group //////////////////////////////
 
 PackageRepository::Group::Group(const QString& grpName)
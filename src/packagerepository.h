@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <QList>
+#include <QSet>
 
 #include "package.h"
 
@@ -44,6 +45,10 @@ public:
   public:
     virtual void beginResetRepository() = 0;
     virtual void endResetRepository() = 0;
+
+    // Incremental updates: "removed" are still alive during the call, "changed" were updated in place
+    virtual void removePackages(const TListOfPackages& removed) = 0;
+    virtual void updatePackages(const TListOfPackages& changed, const TListOfPackages& added) = 0;
   };
 
   ////////////////////////
@@ -67,6 +72,11 @@ public:
       return status == ectn_OUTDATED || status == ectn_NEWER;
     }
 
+    bool operator==(const PackageData& other) const;
+    inline bool operator!=(const PackageData& other) const {
+      return !(*this == other);
+    }
+
   public:
     /*const*/ bool    required;
     //const bool    managedByAUR; // AUR packages must not be in any group
@@ -111,7 +121,9 @@ public:
 
   void registerDependency(IDependency& depends);
   void setAURData(const QList<PackageListData>*const listOfForeignPackages, const QSet<QString>& unrequiredPackages);
-  void setData(const QList<PackageListData>*const listOfPackages, const QSet<QString>& unrequiredPackages);
+  bool setData(const QList<PackageListData>*const listOfPackages, const QSet<QString>& unrequiredPackages);
+  bool updateInstalledPackages(const QList<PackageListData>& installedPackages,
+                               const QStringList& removedPackages, const QSet<QString>& unrequiredPackages);
   void checkAndSetGroups(const QStringList& listOfGroups);
   void checkAndSetMembersOfGroup(const QString& group, const QStringList& members);
 
@@ -119,6 +131,7 @@ public:
   const TListOfPackages& getPackageList(const QString& group) const;
   PackageData*           getFirstPackageByName(const QString name) const;
   PackageData*           getFirstPackageByNameEx(const QString name);
+  QSet<QString>          getInstalledPackageNames() const;
 
 private:
   std::vector<IDependency*> m_dependingModels;
@@ -126,6 +139,10 @@ private:
   TListOfPackages           m_listOfAURPackages;    // sorted qlist of all AUR packages
   QList<Group*>             m_listOfGroups;         // sorted list of all pacman package groups
   bool memberListOfGroupsEquals(const QStringList& listOfGroups);
+  void resetData(const QList<PackageListData>*const listOfPackages, const QSet<QString>& unrequiredPackages);
+  void applyChanges(const TListOfPackages& removed, const TListOfPackages& changed,
+                    const QList<PackageData>& changedData, const QList<const PackageListData*>& added,
+                    const QSet<QString>& unrequiredPackages);
 };
 
 #endif // OCTOPI_PACKAGEREPOSITORY_H
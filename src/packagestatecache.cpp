@@ -0,0 +1,302 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#include "packagestatecache.h"
+#include "dependencygraph.h"
+#include "tracer.h"
+#include "QtSolutions/qtlockedfile.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+using namespace QtLP_Private;
+
+const quint32 ctn_PACKAGE_STATE_CACHE_MAGIC = 0x4f585053; //"OXPS"
+const quint32 ctn_PACKAGE_STATE_CACHE_VERSION = 1;
+const QString ctn_UPGRADE_PLAN_MESSAGE = "SYSUPGRADE_PLAN:";
+
+//fcntl() locks belong to the process, so threads of the same process are serialized here
+static QMutex s_outdatedPackagesMutex;
+static QMutex s_packageListMutex;
+
+/*
+ * Path of the file in which the given list is saved
+ */
+QString PackageStateCache::getFileName(const QString &section)
+{
+  return ctn_OCTOXBPS_CACHE_DIR + QDir::separator() + section + ".state";
+}
+
+/*
+ * Every saved list depends on the installed packages and on the synced repositories
+ */
+QString PackageStateCache::getStamp()
+{
+  QStringList res;
+  QDir dbDir(ctn_XBPS_DATABASE_DIR);
+
+  foreach(QString pkgdb, dbDir.entryList(QStringList() << "pkgdb-*.plist", QDir::Files, QDir::Name))
+  {
+    res.append(pkgdb + "=" + QString::number(QFileInfo(dbDir.absoluteFilePath(pkgdb)).lastModified().toMSecsSinceEpoch()));
+  }
+
+  foreach(QString repodata, DependencyGraph::getRepodataFiles())
+  {
+    res.append(repodata + "=" + QString::number(QFileInfo(repodata).lastModified().toMSecsSinceEpoch()));
+  }
+
+  return res.join("\n");
+}
+
+/*
+ * Reads the saved list into "data" if the file has our format and was saved with the given stamp
+ */
+bool PackageStateCache::readFile(const QString &fileName, const QString &stamp, QByteArray &data)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_0);
+
+  quint32 magic, version;
+  QString fileStamp;
+  in >> magic >> version >> fileStamp >> data;
+
+  return (in.status() == QDataStream::Ok && magic == ctn_PACKAGE_STATE_CACHE_MAGIC &&
+          version == ctn_PACKAGE_STATE_CACHE_VERSION && fileStamp == stamp);
+}
+
+/*
+ * QSaveFile only replaces the old list when the new one is completely written
+ */
+void PackageStateCache::writeFile(const QString &fileName, const QString &stamp, const QByteArray &data)
+{
+  QSaveFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly)) return;
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_0);
+  out << ctn_PACKAGE_STATE_CACHE_MAGIC << ctn_PACKAGE_STATE_CACHE_VERSION << stamp << data;
+
+  file.commit();
+}
+
+/*
+ * Returns the saved list if it's still valid. Otherwise the one holding the write lock computes
+ * and saves it, while other processes (or threads) asking for the same list wait for it
+ */
+QByteArray PackageStateCache::fetch(const QString &section, QMutex &mutex, QByteArray (*compute)())
+{
+  QMutexLocker locker(&mutex);
+
+  QString stamp = getStamp();
+  QString fileName = getFileName(section);
+  QByteArray data;
+
+  //Without pkgdb and repodata there's nothing the list could be checked against
+  if (stamp.isEmpty()) return compute();
+
+  QDir().mkpath(ctn_OCTOXBPS_CACHE_DIR);
+
+  QtLockedFile lockFile(fileName + ".lock");
+  if (!lockFile.open(QIODevice::ReadWrite)) return compute();
+
+  lockFile.lock(QtLockedFile::ReadLock);
+  bool found = readFile(fileName, stamp, data);
+  lockFile.unlock();
+
+  if (found) return data;
+
+  lockFile.lock(QtLockedFile::WriteLock);
+
+  //Maybe the other process computed it while we were waiting for the lock
+  if (!readFile(fileName, stamp, data))
+  {
+    data = compute();
+    writeFile(fileName, stamp, data);
+  }
+
+  lockFile.unlock();
+  return data;
+}
+
+/*
+ * Serializes the outdated packages in the format saved by this cache
+ */
+QByteArray PackageStateCache::encodeOutdatedPackages(const QMap<QString, OutdatedPackageInfo> &outdated)
+{
+  QByteArray data;
+  QDataStream out(&data, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_5_0);
+
+  out << quint32(outdated.count());
+  for (QMap<QString, OutdatedPackageInfo>::const_iterator it = outdated.constBegin(); it != outdated.constEnd(); ++it)
+  {
+    out << it.key() << it.value().oldVersion << it.value().newVersion;
+  }
+
+  return data;
+}
+
+QMap<QString, OutdatedPackageInfo>* PackageStateCache::decodeOutdatedPackages(const QByteArray &data)
+{
+  QMap<QString, OutdatedPackageInfo> *res = new QMap<QString, OutdatedPackageInfo>();
+
+  QDataStream in(data);
+  in.setVersion(QDataStream::Qt_5_0);
+
+  quint32 count = 0;
+  in >> count;
+
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+  {
+    QString pkgName;
+    OutdatedPackageInfo opi;
+    in >> pkgName >> opi.oldVersion >> opi.newVersion;
+    res->insert(pkgName, opi);
+  }
+
+  return res;
+}
+
+/*
+ * Serializes the package list in the format saved by this cache
+ */
+QByteArray PackageStateCache::encodePackageList(const QList<PackageListData> &packages)
+{
+  QByteArray data;
+  QDataStream out(&data, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_5_0);
+
+  out << quint32(packages.count());
+  foreach(PackageListData pld, packages)
+  {
+    out << pld.name << pld.repository << pld.origin << pld.version << pld.comment << pld.description
+        << pld.outatedVersion << pld.installedSize << pld.downloadSize << qint32(pld.status);
+  }
+
+  return data;
+}
+
+QList<PackageListData>* PackageStateCache::decodePackageList(const QByteArray &data)
+{
+  QList<PackageListData> *res = new QList<PackageListData>();
+
+  QDataStream in(data);
+  in.setVersion(QDataStream::Qt_5_0);
+
+  quint32 count = 0;
+  in >> count;
+  res->reserve(count);
+
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+  {
+    PackageListData pld;
+    qint32 status;
+    in >> pld.name >> pld.repository >> pld.origin >> pld.version >> pld.comment >> pld.description
+       >> pld.outatedVersion >> pld.installedSize >> pld.downloadSize >> status;
+    pld.status = PackageStatus(status);
+    res->append(pld);
+  }
+
+  return res;
+}
+
+QByteArray PackageStateCache::computeOutdatedPackages()
+{
+  QMap<QString, OutdatedPackageInfo> *outdated = Package::getOutdatedStringList();
+  QByteArray data = encodeOutdatedPackages(*outdated);
+
+  delete outdated;
+  return data;
+}
+
+QByteArray PackageStateCache::computePackageList()
+{
+  QList<PackageListData> *packages = Package::getPackageList();
+  QByteArray data = encodePackageList(*packages);
+
+  delete packages;
+  return data;
+}
+
+/*
+ * Retrieves the outdated packages ("xbps-install -un"), computed by whichever process asked first
+ */
+QMap<QString, OutdatedPackageInfo>* PackageStateCache::getOutdatedPackages()
+{
+  TraceSpan span("PackageStateCache::getOutdatedPackages");
+  return decodeOutdatedPackages(fetch("outdated-packages", s_outdatedPackagesMutex, computeOutdatedPackages));
+}
+
+/*
+ * Retrieves the list of all available packages, computed by whichever process asked first
+ */
+QList<PackageListData>* PackageStateCache::getPackageList()
+{
+  TraceSpan span("PackageStateCache::getPackageList");
+  return decodePackageList(fetch("package-list", s_packageListMutex, computePackageList));
+}
+
+/*
+ * Builds the QtSingleApplication message which hands an upgrade plan to OctoXBPS
+ */
+QString PackageStateCache::encodeUpgradePlan(const TransactionInfo &ti)
+{
+  QByteArray data;
+  QDataStream out(&data, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_5_0);
+
+  out << ctn_PACKAGE_STATE_CACHE_MAGIC << ctn_PACKAGE_STATE_CACHE_VERSION << getStamp()
+      << (ti.packages != NULL ? *ti.packages : QStringList()) << ti.sizeToInstall << ti.sizeToDownload;
+
+  return ctn_UPGRADE_PLAN_MESSAGE + QString::fromLatin1(data.toBase64());
+}
+
+bool PackageStateCache::isUpgradePlanMessage(const QString &message)
+{
+  return message.startsWith(ctn_UPGRADE_PLAN_MESSAGE);
+}
+
+/*
+ * Reads the upgrade plan of the given message. "stamp" tells the pkgdb and repodata it was computed for
+ */
+bool PackageStateCache::decodeUpgradePlan(const QString &message, TransactionInfo &ti, QString &stamp)
+{
+  if (!isUpgradePlanMessage(message)) return false;
+
+  QByteArray data = QByteArray::fromBase64(message.mid(ctn_UPGRADE_PLAN_MESSAGE.length()).toLatin1());
+  QDataStream in(data);
+  in.setVersion(QDataStream::Qt_5_0);
+
+  quint32 magic, version;
+  QStringList packages;
+  in >> magic >> version >> stamp >> packages >> ti.sizeToInstall >> ti.sizeToDownload;
+
+  if (in.status() != QDataStream::Ok ||
+      magic != ctn_PACKAGE_STATE_CACHE_MAGIC || version != ctn_PACKAGE_STATE_CACHE_VERSION) return false;
+
+  ti.packages = new QStringList(packages);
+  return true;
+}
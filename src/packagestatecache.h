@@ -0,0 +1,69 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#ifndef PACKAGESTATECACHE_H
+#define PACKAGESTATECACHE_H
+
+#include "package.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+/*
+ * Package state shared by OctoXBPS and its notifier through ctn_OCTOXBPS_CACHE_DIR.
+ *
+ * Each list is saved in its own file, stamped with the modification times of pkgdb and of every
+ * repodata, so it stays valid until a transaction or a sync happens. Files are replaced atomically
+ * and guarded by a QtLockedFile: the first process needing a list computes it while holding the
+ * write lock, and any other process asking for it meanwhile waits and reads the result.
+ *
+ * A system upgrade plan (the TransactionInfo of "xbps-install -un") travels the other way, as a
+ * QtSingleApplication message, and carries the same stamp so the receiver can tell if it's stale.
+ */
+
+class PackageStateCache
+{
+private:
+  static QString getFileName(const QString &section);
+  static bool readFile(const QString &fileName, const QString &stamp, QByteArray &data);
+  static void writeFile(const QString &fileName, const QString &stamp, const QByteArray &data);
+  static QByteArray fetch(const QString &section, QMutex &mutex, QByteArray (*compute)());
+
+  static QByteArray computeOutdatedPackages();
+  static QByteArray computePackageList();
+
+public:
+  static QString getStamp();
+  static QMap<QString, OutdatedPackageInfo>* getOutdatedPackages();
+  static QList<PackageListData>* getPackageList();
+
+  static QByteArray encodeOutdatedPackages(const QMap<QString, OutdatedPackageInfo> &outdated);
+  static QMap<QString, OutdatedPackageInfo>* decodeOutdatedPackages(const QByteArray &data);
+  static QByteArray encodePackageList(const QList<PackageListData> &packages);
+  static QList<PackageListData>* decodePackageList(const QByteArray &data);
+
+  static QString encodeUpgradePlan(const TransactionInfo &ti);
+  static bool isUpgradePlanMessage(const QString &message);
+  static bool decodeUpgradePlan(const QString &message, TransactionInfo &ti, QString &stamp);
+};
+
+#endif // PACKAGESTATECACHE_H
@@ -0,0 +1,134 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "pathresolver.h"
+#include "systemcapabilities.h"
+
+#include <QCoreApplication>
+#include <QFileSystemWatcher>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Reads the PATH dirs and starts watching them, so we know when some executable comes or goes
+ */
+PathResolver::PathResolver(QObject *parent): QObject(parent)
+{
+  QStringList dirs = QString::fromLocal8Bit(qgetenv("PATH")).split(':', QString::SkipEmptyParts);
+
+  foreach(QString dir, dirs)
+  {
+    if (!m_pathDirs.contains(dir) && QFileInfo(dir).isDir())
+      m_pathDirs.append(dir);
+  }
+
+  m_pathWatcher = new QFileSystemWatcher(this);
+  if (!m_pathDirs.isEmpty())
+    m_pathWatcher->addPaths(m_pathDirs);
+
+  connect(m_pathWatcher, SIGNAL(directoryChanged(QString)), this, SLOT(invalidate()));
+}
+
+/*
+ * Returns the one and only resolver, which always lives in the GUI thread
+ */
+PathResolver* PathResolver::instance()
+{
+  static QMutex instanceMutex;
+  static PathResolver *resolver = 0;
+
+  QMutexLocker locker(&instanceMutex);
+
+  if (resolver == 0)
+  {
+    resolver = new PathResolver();
+
+    if (QCoreApplication::instance() && resolver->thread() != QCoreApplication::instance()->thread())
+      resolver->moveToThread(QCoreApplication::instance()->thread());
+  }
+
+  return resolver;
+}
+
+/*
+ * Looks for "exeName" in every PATH dir, the same order the shell uses
+ */
+QString PathResolver::scanPathDirs(const QString &exeName) const
+{
+  struct stat st;
+
+  foreach(QString dir, m_pathDirs)
+  {
+    QByteArray path = QString(dir + "/" + exeName).toLocal8Bit();
+
+    if (stat(path.constData(), &st) == 0 && S_ISREG(st.st_mode) &&
+        access(path.constData(), X_OK) == 0)
+    {
+      return dir + "/" + exeName;
+    }
+  }
+
+  return QString();
+}
+
+/*
+ * Some PATH dir has changed, so everything we know may be stale. That includes the tools
+ * SystemCapabilities found through us, which are probed again once our lock is released
+ */
+void PathResolver::invalidate()
+{
+  {
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+  }
+
+  SystemCapabilities::refreshExecutables();
+}
+
+/*
+ * Returns the full path of "exeName" or an empty string if it is not in PATH
+ */
+QString PathResolver::resolve(const QString &exeName)
+{
+  if (exeName.isEmpty()) return QString();
+
+  QMutexLocker locker(&m_mutex);
+
+  QHash<QString, QString>::const_iterator it = m_cache.constFind(exeName);
+  if (it != m_cache.constEnd())
+    return it.value();
+
+  QString path;
+
+  if (exeName.contains('/'))
+  {
+    QFileInfo fi(exeName);
+    if (fi.isFile() && fi.isExecutable())
+      path = fi.absoluteFilePath();
+  }
+  else
+    path = scanPathDirs(exeName);
+
+  m_cache.insert(exeName, path);
+  return path;
+}
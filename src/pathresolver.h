@@ -0,0 +1,59 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef PATHRESOLVER_H
+#define PATHRESOLVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+class QFileSystemWatcher;
+
+/*
+ * This class resolves executable names against the PATH directories without spawning "which".
+ * Every lookup is memoised, and the whole cache is dropped whenever some PATH dir changes.
+ */
+
+class PathResolver : public QObject
+{
+  Q_OBJECT
+
+private:
+  QStringList m_pathDirs;
+  QHash<QString, QString> m_cache; //executable name -> full path ("" when missing)
+  QFileSystemWatcher *m_pathWatcher;
+  QMutex m_mutex;
+
+  explicit PathResolver(QObject *parent = 0);
+  QString scanPathDirs(const QString &exeName) const;
+
+private slots:
+  void invalidate();
+
+public:
+  static PathResolver* instance();
+
+  QString resolve(const QString &exeName);
+};
+
+#endif // PATHRESOLVER_H
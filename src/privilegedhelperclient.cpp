@@ -0,0 +1,267 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "privilegedhelperclient.h"
+#include "constants.h"
+#include "unixcommand.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QLocalSocket>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include <unistd.h>
+
+PrivilegedHelperClient *PrivilegedHelperClient::m_instance = 0;
+
+PrivilegedHelperClient::PrivilegedHelperClient(): QObject()
+{
+  m_blockSize = 0;
+  m_busy = false;
+
+  m_socket = new QLocalSocket(this);
+  connect(m_socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+  connect(m_socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+
+  m_launcher = new QProcess(this);
+  connect(m_launcher, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(onLauncherFinished(int,QProcess::ExitStatus)));
+
+  m_connectTimer = new QTimer(this);
+  m_connectTimer->setInterval(250);
+  connect(m_connectTimer, SIGNAL(timeout()), this, SLOT(onConnectTimer()));
+}
+
+PrivilegedHelperClient* PrivilegedHelperClient::instance()
+{
+  if (m_instance == 0)
+    m_instance = new PrivilegedHelperClient();
+
+  return m_instance;
+}
+
+/*
+ * The socket lives in the user's runtime dir, so OctoXBPS and the notifier share the same helper
+ */
+QString PrivilegedHelperClient::getSocketPath()
+{
+  return QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation) +
+      QDir::separator() + ctn_OCTOXBPS_HELPER_SOCKET_NAME;
+}
+
+bool PrivilegedHelperClient::isAvailable()
+{
+  return QFile::exists(ctn_OCTOXBPS_HELPER_BINARY);
+}
+
+/*
+ * Splits a ";" separated command line into the programs the helper runs, one after the other.
+ * Returns an empty list if any part of it needs a shell or isn't an XBPS command
+ */
+QList<QStringList> PrivilegedHelperClient::parseCommand(const QString &command)
+{
+  QList<QStringList> res;
+  QStringList allowed = ctn_OCTOXBPS_HELPER_COMMANDS.split(" ");
+
+  if (command.contains(QRegularExpression("[\"'`$|&<>\\\\]"))) return res;
+
+  foreach(QString part, command.split(";", QString::SkipEmptyParts))
+  {
+    QStringList args = part.split(" ", QString::SkipEmptyParts);
+    if (args.isEmpty()) continue;
+
+    if (!allowed.contains(args.first())) return QList<QStringList>();
+    res.append(args);
+  }
+
+  return res;
+}
+
+bool PrivilegedHelperClient::connectToHelper(int timeout)
+{
+  if (m_socket->state() == QLocalSocket::ConnectedState) return true;
+
+  m_socket->abort();
+  m_blockSize = 0;
+  m_socket->connectToServer(getSocketPath());
+
+  return m_socket->waitForConnected(timeout);
+}
+
+/*
+ * Returns true if some OctoXBPS process has already started the helper
+ */
+bool PrivilegedHelperClient::isRunning()
+{
+  return connectToHelper(500);
+}
+
+/*
+ * Queues the given commands in the helper, starting it first if needed.
+ * Returns false if another transaction of this process is still running
+ */
+bool PrivilegedHelperClient::execute(const QList<QStringList> &commands, const QString &lang)
+{
+  if (m_busy || commands.isEmpty()) return false;
+
+  m_busy = true;
+  m_standardOutput.clear();
+  m_standardError.clear();
+
+  QDataStream out(&m_request, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_5_0);
+  out << quint32(0) << lang << commands;
+  out.device()->seek(0);
+  out << quint32(m_request.size() - sizeof(quint32));
+
+  //Just like QProcess::start(), started() comes after we return
+  QMetaObject::invokeMethod(this, "started", Qt::QueuedConnection);
+
+  if (connectToHelper(500))
+  {
+    sendRequest();
+  }
+  else
+  {
+    //This is the only time the user authenticates
+    if (m_launcher->state() == QProcess::NotRunning)
+    {
+      m_launcher->start(UnixCommand::getRootCommand(ctn_OCTOXBPS_HELPER_BINARY + " " +
+                                                    getSocketPath() + " " + QString::number(getuid())));
+    }
+
+    m_connectTimer->start();
+  }
+
+  return true;
+}
+
+void PrivilegedHelperClient::sendRequest()
+{
+  m_socket->write(m_request);
+  m_socket->flush();
+  m_request.clear();
+}
+
+/*
+ * The helper couldn't be started (ex: the user cancelled the authentication)
+ */
+void PrivilegedHelperClient::fail(int exitCode)
+{
+  m_connectTimer->stop();
+  m_request.clear();
+  m_busy = false;
+
+  emit finished(exitCode != 0 ? exitCode : 1, QProcess::NormalExit);
+}
+
+/*
+ * Waits for the helper to create its socket while the SU front-end asks for the password
+ */
+void PrivilegedHelperClient::onConnectTimer()
+{
+  if (connectToHelper(100))
+  {
+    m_connectTimer->stop();
+    sendRequest();
+  }
+  else if (m_launcher->state() == QProcess::NotRunning)
+  {
+    fail(m_launcher->exitCode());
+  }
+}
+
+void PrivilegedHelperClient::onLauncherFinished(int exitCode, QProcess::ExitStatus)
+{
+  if (m_connectTimer->isActive() && !connectToHelper(100))
+    fail(exitCode);
+}
+
+/*
+ * Every message is a size prefixed (type, code, data) block
+ */
+void PrivilegedHelperClient::onReadyRead()
+{
+  QDataStream in(m_socket);
+  in.setVersion(QDataStream::Qt_5_0);
+
+  forever
+  {
+    if (m_blockSize == 0)
+    {
+      if (m_socket->bytesAvailable() < (int)sizeof(quint32)) return;
+      in >> m_blockSize;
+    }
+
+    if (m_socket->bytesAvailable() < m_blockSize) return;
+
+    qint32 type, code;
+    QByteArray data;
+    in >> type >> code >> data;
+    m_blockSize = 0;
+
+    if (type == ectn_HELPER_STANDARD_OUTPUT)
+    {
+      m_standardOutput = QString::fromUtf8(data);
+      emit readyReadStandardOutput();
+    }
+    else if (type == ectn_HELPER_STANDARD_ERROR)
+    {
+      m_standardError = QString::fromUtf8(data);
+      emit readyReadStandardError();
+    }
+    else if (type == ectn_HELPER_FINISHED)
+    {
+      m_busy = false;
+      emit finished(code, QProcess::ExitStatus(data.toInt()));
+    }
+  }
+}
+
+/*
+ * The helper went away (idle timeout or killed). If it had our transaction, it's over
+ */
+void PrivilegedHelperClient::onDisconnected()
+{
+  m_blockSize = 0;
+
+  if (m_busy && m_request.isEmpty() && !m_connectTimer->isActive())
+  {
+    m_busy = false;
+    emit finished(1, QProcess::CrashExit);
+  }
+}
+
+/*
+ * Retrieves the last chunk of standard output of the running transaction
+ */
+QString PrivilegedHelperClient::readAllStandardOutput()
+{
+  return m_standardOutput;
+}
+
+/*
+ * Retrieves the last chunk of standard error of the running transaction
+ */
+QString PrivilegedHelperClient::readAllStandardError()
+{
+  return m_standardError;
+}
@@ -0,0 +1,90 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef PRIVILEGEDHELPERCLIENT_H
+#define PRIVILEGEDHELPERCLIENT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+
+class QLocalSocket;
+class QTimer;
+
+/*
+ * Talks to octoxbps-helper, the privileged process which runs XBPS transactions for the session.
+ *
+ * The first transaction starts the helper through the SU front-end (the only time the user is asked
+ * for a password). Later ones, from OctoXBPS or its notifier, are just queued on its local socket and
+ * their output streams back. The helper exits by itself after ctn_OCTOXBPS_HELPER_IDLE_TIMEOUT.
+ *
+ * It emits the same signals as a QProcess, so UnixCommand can forward them unchanged.
+ */
+
+class PrivilegedHelperClient : public QObject
+{
+  Q_OBJECT
+
+private:
+  QLocalSocket *m_socket;
+  QProcess *m_launcher;
+  QTimer *m_connectTimer;
+  QByteArray m_request; //Waiting for the helper to come up
+  quint32 m_blockSize;
+  bool m_busy;
+  QString m_standardOutput;
+  QString m_standardError;
+
+  static PrivilegedHelperClient *m_instance;
+  PrivilegedHelperClient();
+
+  bool connectToHelper(int timeout);
+  void sendRequest();
+  void fail(int exitCode);
+
+private slots:
+  void onConnectTimer();
+  void onLauncherFinished(int exitCode, QProcess::ExitStatus);
+  void onReadyRead();
+  void onDisconnected();
+
+public:
+  static PrivilegedHelperClient* instance();
+  static QString getSocketPath();
+  static bool isAvailable();
+  static QList<QStringList> parseCommand(const QString &command);
+
+  bool isRunning();
+  bool execute(const QList<QStringList> &commands, const QString &lang);
+
+  QString readAllStandardOutput();
+  QString readAllStandardError();
+
+signals:
+  void started();
+  void readyReadStandardOutput();
+  void readyReadStandardError();
+  void finished(int, QProcess::ExitStatus);
+};
+
+#endif // PRIVILEGEDHELPERCLIENT_H
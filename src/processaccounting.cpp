@@ -0,0 +1,214 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "processaccounting.h"
+
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+
+static QMutex s_accountingMutex;
+static QHash<QString, ProcessStatistics> s_statistics; //normalized command -> totals
+
+/*
+ * Groups commands by what they do: "xbps-query -f foo" and "xbps-query -f bar" are both "xbps-query -f"
+ */
+QString ProcessAccounting::normalizeCommand(const QString &command)
+{
+  QStringList parts = command.split(' ', QString::SkipEmptyParts);
+  QStringList res;
+
+  foreach(QString part, parts)
+  {
+    part.remove('"');
+    if (part.isEmpty()) continue;
+
+    if (res.isEmpty())
+      res.append(QFileInfo(part).fileName());
+    else if (part.startsWith('-'))
+      res.append(part);
+    else if (res.count() == 1 && !part.contains('/') && (res.at(0) == "sh" || res.at(0).endsWith("su") ||
+                                                         res.at(0) == "sudo" || res.at(0) == "dbus-launch"))
+      res.append(QFileInfo(part).fileName()); //The real command behind a wrapper
+  }
+
+  return res.join(" ");
+}
+
+void ProcessAccounting::record(const QString &command, qint64 wallTime, int exitCode, qint64 bytesRead)
+{
+  QString key = normalizeCommand(command);
+  QMutexLocker locker(&s_accountingMutex);
+
+  ProcessStatistics &stats = s_statistics[key];
+  stats.command = key;
+  stats.count++;
+  if (exitCode != 0) stats.failures++;
+  stats.totalTime += wallTime;
+  if (wallTime > stats.maxTime) stats.maxTime = wallTime;
+  stats.bytesRead += bytesRead;
+}
+
+/*
+ * Adds output read after the process finished to the totals of its command
+ */
+void ProcessAccounting::addBytesRead(const QString &command, qint64 bytes)
+{
+  if (bytes <= 0) return;
+
+  QString key = normalizeCommand(command);
+  QMutexLocker locker(&s_accountingMutex);
+
+  if (s_statistics.contains(key))
+    s_statistics[key].bytesRead += bytes;
+}
+
+/*
+ * Starts a detached process (editors, file managers, terminals) and counts it. Its time isn't known
+ */
+bool ProcessAccounting::startDetached(const QString &command)
+{
+  bool res = QProcess::startDetached(command);
+  record(command, 0, res ? 0 : -1);
+
+  return res;
+}
+
+bool ProcessAccounting::startDetached(const QString &program, const QStringList &arguments)
+{
+  bool res = QProcess::startDetached(program, arguments);
+  record(program + " " + arguments.join(" "), 0, res ? 0 : -1);
+
+  return res;
+}
+
+static bool sortByTotalTime(const ProcessStatistics &a, const ProcessStatistics &b)
+{
+  if (a.totalTime != b.totalTime) return a.totalTime > b.totalTime;
+  return a.count > b.count;
+}
+
+/*
+ * Returns the totals of each command, the most expensive ones first
+ */
+QList<ProcessStatistics> ProcessAccounting::getStatistics()
+{
+  QMutexLocker locker(&s_accountingMutex);
+  QList<ProcessStatistics> res = s_statistics.values();
+  locker.unlock();
+
+  qSort(res.begin(), res.end(), sortByTotalTime);
+  return res;
+}
+
+int ProcessAccounting::getProcessCount()
+{
+  QMutexLocker locker(&s_accountingMutex);
+  int res = 0;
+
+  foreach(ProcessStatistics stats, s_statistics)
+    res += stats.count;
+
+  return res;
+}
+
+qint64 ProcessAccounting::getTotalTime()
+{
+  QMutexLocker locker(&s_accountingMutex);
+  qint64 res = 0;
+
+  foreach(ProcessStatistics stats, s_statistics)
+    res += stats.totalTime;
+
+  return res;
+}
+
+/*
+ * A plain text table of getStatistics(), dumped at exit when "-d" is given
+ */
+QString ProcessAccounting::getReport()
+{
+  QString res;
+  QTextStream out(&res);
+  QList<ProcessStatistics> statistics = getStatistics();
+
+  out << "Processes spawned: " << getProcessCount() << ", total wall time: " << getTotalTime() << " ms\n";
+  out << qSetFieldWidth(8) << "count" << "total ms" << "avg ms" << "max ms" << "failed" << qSetFieldWidth(12) << "bytes read"
+      << qSetFieldWidth(0) << "  command\n";
+
+  foreach(ProcessStatistics stats, statistics)
+  {
+    out << qSetFieldWidth(8) << stats.count << stats.totalTime << (stats.totalTime / stats.count) << stats.maxTime
+        << stats.failures << qSetFieldWidth(12) << stats.bytesRead << qSetFieldWidth(0) << "  " << stats.command << "\n";
+  }
+
+  out.flush();
+  return res;
+}
+
+/*
+ * "parent" is null for processes living on the stack of a blocking call
+ */
+ProcessWatcher::ProcessWatcher(QProcess *process, QObject *parent): QObject(parent)
+{
+  m_process = process;
+  m_bytesRead = 0;
+
+  connect(m_process, SIGNAL(started()), this, SLOT(onStarted()));
+  connect(m_process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(onFinished(int,QProcess::ExitStatus)));
+  connect(m_process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(onError(QProcess::ProcessError)));
+}
+
+/*
+ * Output read while the process runs goes with its record, the rest is added to what was recorded
+ */
+void ProcessWatcher::addBytesRead(qint64 bytes)
+{
+  if (m_timer.isValid())
+    m_bytesRead += bytes;
+  else
+    ProcessAccounting::addBytesRead(m_command, bytes);
+}
+
+void ProcessWatcher::onStarted()
+{
+  m_command = m_process->program() + " " + m_process->arguments().join(" ");
+  m_bytesRead = 0;
+  m_timer.start();
+}
+
+void ProcessWatcher::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+  if (!m_timer.isValid()) return;
+
+  ProcessAccounting::record(m_command, m_timer.elapsed(),
+                            exitStatus == QProcess::NormalExit ? exitCode : -1, m_bytesRead);
+  m_timer.invalidate();
+}
+
+void ProcessWatcher::onError(QProcess::ProcessError error)
+{
+  if (error != QProcess::FailedToStart) return;
+
+  m_command = m_process->program() + " " + m_process->arguments().join(" ");
+  ProcessAccounting::record(m_command, 0, -1);
+}
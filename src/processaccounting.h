@@ -0,0 +1,94 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef PROCESSACCOUNTING_H
+#define PROCESSACCOUNTING_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+
+/*
+ * Totals of every process started with the same program and options
+ */
+struct ProcessStatistics
+{
+  QString command; //program + options, without package names or paths
+  int count;
+  int failures; //non zero exit codes
+  qint64 totalTime; //msecs
+  qint64 maxTime;
+  qint64 bytesRead;
+
+  ProcessStatistics(): count(0), failures(0), totalTime(0), maxTime(0), bytesRead(0){
+  }
+};
+
+/*
+ * This class is the central record of the processes we spawn: command, wall time, exit code and
+ * bytes read. Every QProcess is followed by a ProcessWatcher, which reports here; detached ones
+ * are started with startDetached().
+ */
+
+class ProcessAccounting
+{
+public:
+  static QString normalizeCommand(const QString &command);
+
+  static void record(const QString &command, qint64 wallTime, int exitCode, qint64 bytesRead = 0);
+  static void addBytesRead(const QString &command, qint64 bytes);
+  static bool startDetached(const QString &command);
+  static bool startDetached(const QString &program, const QStringList &arguments);
+
+  static QList<ProcessStatistics> getStatistics();
+  static int getProcessCount();
+  static qint64 getTotalTime();
+  static QString getReport();
+};
+
+/*
+ * Follows a QProcess, recording each run when it finishes (or fails to start).
+ * Output is consumed by the owner of the process, so it reports what it read with addBytesRead()
+ */
+class ProcessWatcher : public QObject
+{
+  Q_OBJECT
+
+private:
+  QProcess *m_process;
+  QString m_command;
+  QElapsedTimer m_timer;
+  qint64 m_bytesRead;
+
+private slots:
+  void onStarted();
+  void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+  void onError(QProcess::ProcessError error);
+
+public:
+  explicit ProcessWatcher(QProcess *process, QObject *parent = 0);
+
+  void addBytesRead(qint64 bytes);
+};
+
+#endif // PROCESSACCOUNTING_H
@@ -0,0 +1,301 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "queryrecorder.h"
+#include "processaccounting.h"
+
+#include <iostream>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+
+/*
+ * Environment variables which change what the queries print, so they are part of each fixture key
+ */
+static const char * const ctn_RECORDED_ENVIRONMENT[] = { "LANG", "LC_ALL", "LC_MESSAGES", "COLUMNS" };
+
+/*
+ * Starts in the mode given by the environment, if any. The command line switches may change it later
+ */
+QueryRecorder::QueryRecorder()
+{
+  m_mode = ectn_QUERY_LIVE;
+  m_replayLatency = -1;
+  m_sessionTimer.start();
+
+  QString recordDir = QString::fromLocal8Bit(qgetenv("OCTOXBPS_RECORD"));
+  QString replayDir = QString::fromLocal8Bit(qgetenv("OCTOXBPS_REPLAY"));
+  QByteArray latency = qgetenv("OCTOXBPS_REPLAY_LATENCY");
+
+  if (!replayDir.isEmpty())
+    setMode(ectn_QUERY_REPLAY, replayDir);
+  else if (!recordDir.isEmpty())
+    setMode(ectn_QUERY_RECORD, recordDir);
+
+  if (!latency.isEmpty())
+  {
+    bool ok;
+    int msecs = latency.toInt(&ok);
+    if (ok) m_replayLatency = msecs;
+  }
+}
+
+/*
+ * Returns the one and only recorder
+ */
+QueryRecorder* QueryRecorder::instance()
+{
+  static QueryRecorder recorder;
+  return &recorder;
+}
+
+/*
+ * The fixture key is a hash of the command line plus the environment bits that change its output.
+ * Arguments are kept apart, so "a b" and "a" "b" get different keys
+ */
+QString QueryRecorder::getFixtureKey(const QStringList &command, const QProcessEnvironment &env)
+{
+  QByteArray data = command.join(QChar('\0')).toUtf8();
+
+  for (unsigned int c=0; c<sizeof(ctn_RECORDED_ENVIRONMENT)/sizeof(ctn_RECORDED_ENVIRONMENT[0]); c++)
+  {
+    QString var = QLatin1String(ctn_RECORDED_ENVIRONMENT[c]);
+    data += "\n" + var.toUtf8() + "=" + env.value(var).toUtf8();
+  }
+
+  return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex().left(16);
+}
+
+void QueryRecorder::setMode(QueryMode mode, const QString &fixtureDir)
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_mode = mode;
+  m_fixtureDir = fixtureDir;
+  m_counters.clear();
+  m_sessionTimer.restart();
+
+  if (mode == ectn_QUERY_RECORD && !QDir().mkpath(fixtureDir))
+  {
+    std::cerr << "Could not create the fixture directory " << fixtureDir.toStdString() << std::endl;
+    m_mode = ectn_QUERY_LIVE;
+  }
+}
+
+/*
+ * The command as a single line for the logs, quoting the arguments which have blanks
+ */
+QString QueryRecorder::getCommandLine(const QStringList &command)
+{
+  QStringList res;
+
+  foreach(QString arg, command)
+  {
+    if (arg.contains(QRegularExpression("\\s")) || arg.isEmpty())
+      res.append("\"" + arg + "\"");
+    else
+      res.append(arg);
+  }
+
+  return res.join(" ");
+}
+
+/*
+ * The same command may run many times in a session: each run gets its own fixture number
+ */
+int QueryRecorder::nextFixtureNumber(const QString &key)
+{
+  int number = m_counters.value(key, 0) + 1;
+  m_counters.insert(key, number);
+  return number;
+}
+
+/*
+ * "session.log" keeps the order and timing of every recorded query, one per line:
+ * <msecs since start> <elapsed msecs> <fixture name> <command line>
+ */
+void QueryRecorder::appendToSessionLog(const QString &fixtureName, const QString &command, qint64 elapsed)
+{
+  QFile log(m_fixtureDir + QDir::separator() + "session.log");
+  if (!log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) return;
+
+  QTextStream out(&log);
+  out << (m_sessionTimer.elapsed() - elapsed) << "\t" << elapsed << "\t" << fixtureName << "\t" << command << "\n";
+}
+
+/*
+ * Saves "<key>-<n>.query" (command, environment, exit code and timing), "<key>-<n>.out" and "<key>-<n>.err"
+ */
+void QueryRecorder::record(const QStringList &command, const QProcessEnvironment &env, const QByteArray &output,
+                           const QByteArray &errorOutput, int exitCode, qint64 elapsed)
+{
+  QMutexLocker locker(&m_mutex);
+  QString key = getFixtureKey(command, env);
+  QString fixtureName = key + "-" + QString::number(nextFixtureNumber(key));
+  QString fixturePath = m_fixtureDir + QDir::separator() + fixtureName;
+
+  QFile out(fixturePath + ".out");
+  if (out.open(QIODevice::WriteOnly)) out.write(output);
+
+  QFile err(fixturePath + ".err");
+  if (err.open(QIODevice::WriteOnly)) err.write(errorOutput);
+
+  QSettings query(fixturePath + ".query", QSettings::IniFormat);
+  query.setValue("command", getCommandLine(command));
+  if (command.count() > 1) query.setValue("arguments", command.mid(1));
+  for (unsigned int c=0; c<sizeof(ctn_RECORDED_ENVIRONMENT)/sizeof(ctn_RECORDED_ENVIRONMENT[0]); c++)
+  {
+    QString var = QLatin1String(ctn_RECORDED_ENVIRONMENT[c]);
+    query.setValue("environment/" + var, env.value(var));
+  }
+  query.setValue("environment/PATH", env.value("PATH"));
+  query.setValue("exitCode", exitCode);
+  query.setValue("elapsed", elapsed);
+  query.sync();
+
+  appendToSessionLog(fixtureName, getCommandLine(command), elapsed);
+}
+
+/*
+ * Serves the next recorded output of the given command. When the session asks for it more times
+ * than it was recorded, the first recording is served again
+ */
+QByteArray QueryRecorder::replay(const QStringList &command, const QProcessEnvironment &env)
+{
+  QByteArray output;
+  int latency;
+
+  {
+    QMutexLocker locker(&m_mutex);
+    QString key = getFixtureKey(command, env);
+    QString fixturePath = m_fixtureDir + QDir::separator() + key + "-" + QString::number(nextFixtureNumber(key));
+
+    if (!QFile::exists(fixturePath + ".query"))
+      fixturePath = m_fixtureDir + QDir::separator() + key + "-1";
+
+    if (!QFile::exists(fixturePath + ".query"))
+    {
+      std::cerr << "No recorded output for: " << getCommandLine(command).toStdString() << std::endl;
+      return output;
+    }
+
+    QFile out(fixturePath + ".out");
+    if (out.open(QIODevice::ReadOnly)) output = out.readAll();
+
+    QSettings query(fixturePath + ".query", QSettings::IniFormat);
+    latency = (m_replayLatency >= 0 ? m_replayLatency : query.value("elapsed", 0).toInt());
+  }
+
+  //Sleeping outside the lock lets concurrent queries overlap as they did when recorded
+  if (latency > 0) QThread::msleep(latency);
+
+  return output;
+}
+
+/*
+ * Records every query into the given directory
+ */
+void QueryRecorder::setRecordDir(const QString &fixtureDir)
+{
+  instance()->setMode(ectn_QUERY_RECORD, fixtureDir);
+}
+
+/*
+ * Serves every query from the recordings in the given directory
+ */
+void QueryRecorder::setReplayDir(const QString &fixtureDir)
+{
+  instance()->setMode(ectn_QUERY_REPLAY, fixtureDir);
+}
+
+/*
+ * Replayed queries take "msecs" instead of their recorded time (-1 goes back to the recorded one)
+ */
+void QueryRecorder::setReplayLatency(int msecs)
+{
+  QueryRecorder *recorder = instance();
+  QMutexLocker locker(&recorder->m_mutex);
+  recorder->m_replayLatency = msecs;
+}
+
+QueryMode QueryRecorder::getMode()
+{
+  return instance()->m_mode;
+}
+
+/*
+ * Runs "program" and returns its StandardOutput, recording it or replaying it when asked to.
+ * Without arguments, "program" is a whole command line QProcess splits by itself
+ */
+QByteArray QueryRecorder::run(const QString &program, const QStringList &arguments,
+                              const QProcessEnvironment &env, int msecs)
+{
+  QStringList command = QStringList(program) << arguments;
+
+  if (m_mode == ectn_QUERY_REPLAY)
+    return replay(command, env);
+
+  QElapsedTimer timer;
+  QProcess proc;
+  ProcessWatcher watcher(&proc);
+  proc.setProcessEnvironment(env);
+
+  timer.start();
+  if (arguments.isEmpty())
+    proc.start(program);
+  else
+    proc.start(program, arguments);
+  proc.waitForFinished(msecs);
+
+  QByteArray output = proc.readAllStandardOutput();
+  watcher.addBytesRead(output.size());
+
+  if (m_mode == ectn_QUERY_RECORD)
+  {
+    record(command, env, output, proc.readAllStandardError(), proc.exitCode(), timer.elapsed());
+  }
+
+  proc.close();
+  return output;
+}
+
+/*
+ * Runs the given command line and returns its StandardOutput
+ */
+QByteArray QueryRecorder::execute(const QString &command, const QProcessEnvironment &env, int msecs)
+{
+  return instance()->run(command, QStringList(), env, msecs);
+}
+
+/*
+ * Runs "program" with the given arguments, each one passed as is, and returns its StandardOutput
+ */
+QByteArray QueryRecorder::execute(const QString &program, const QStringList &arguments,
+                                  const QProcessEnvironment &env, int msecs)
+{
+  return instance()->run(program, arguments, env, msecs);
+}
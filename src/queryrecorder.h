@@ -0,0 +1,82 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef QUERYRECORDER_H
+#define QUERYRECORDER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QProcessEnvironment>
+#include <QString>
+#include <QStringList>
+
+/*
+ * This class runs the read-only commands UnixCommand asks for (xbps-query, xbps-install -n...).
+ * In record mode it saves the command line, the locale bits of its environment, stdout, stderr,
+ * exit code and timing of each one into a fixture directory. In replay mode it serves them back
+ * from there, waiting for the recorded (or a fixed) latency, without running anything.
+ *
+ * It's set by the "-record <dir>", "-replay <dir>" and "-replay-latency <ms>" switches or by the
+ * OCTOXBPS_RECORD, OCTOXBPS_REPLAY and OCTOXBPS_REPLAY_LATENCY environment variables.
+ *
+ * Members extracted from repodata and cached archives go through it too, but the plist files
+ * DependencyGraph, FileOwnerIndex and PackageStateCache read straight from the XBPS database
+ * (pkgdb-*.plist, .<pkg>-files.plist) do not: a replay still sees the database of the machine it runs on.
+ */
+
+enum QueryMode { ectn_QUERY_LIVE, ectn_QUERY_RECORD, ectn_QUERY_REPLAY };
+
+class QueryRecorder
+{
+private:
+  QueryMode m_mode;
+  QString m_fixtureDir;
+  int m_replayLatency; //-1 means "the recorded one"
+  QHash<QString, int> m_counters; //fixture key -> times it was recorded/replayed
+  QElapsedTimer m_sessionTimer;
+  QMutex m_mutex;
+
+  QueryRecorder();
+  static QueryRecorder* instance();
+
+  static QString getFixtureKey(const QStringList &command, const QProcessEnvironment &env);
+  static QString getCommandLine(const QStringList &command);
+  void setMode(QueryMode mode, const QString &fixtureDir);
+  int nextFixtureNumber(const QString &key);
+  void appendToSessionLog(const QString &fixtureName, const QString &command, qint64 elapsed);
+  void record(const QStringList &command, const QProcessEnvironment &env, const QByteArray &output,
+              const QByteArray &errorOutput, int exitCode, qint64 elapsed);
+  QByteArray replay(const QStringList &command, const QProcessEnvironment &env);
+  QByteArray run(const QString &program, const QStringList &arguments, const QProcessEnvironment &env, int msecs);
+
+public:
+  static void setRecordDir(const QString &fixtureDir);
+  static void setReplayDir(const QString &fixtureDir);
+  static void setReplayLatency(int msecs);
+  static QueryMode getMode();
+
+  static QByteArray execute(const QString &command, const QProcessEnvironment &env, int msecs = 30000);
+  static QByteArray execute(const QString &program, const QStringList &arguments,
+                            const QProcessEnvironment &env, int msecs = 30000);
+};
+
+#endif // QUERYRECORDER_H
@@ -0,0 +1,359 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "searchindex.h"
+#include "constants.h"
+#include "dependencygraph.h"
+#include "xbpsplist.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QSet>
+
+#include <algorithm>
+#include <iterator>
+
+const quint32 ctn_SEARCH_INDEX_MAGIC = 0x4f584944; //"OXID"
+const quint32 ctn_SEARCH_INDEX_VERSION = 1;
+
+/*
+ * The index starts empty: it is loaded (or built) at the first search
+ */
+SearchIndex::SearchIndex()
+{
+  m_loaded = false;
+  m_loadedFlag = 0;
+}
+
+/*
+ * Returns the single index instance
+ */
+SearchIndex* SearchIndex::instance()
+{
+  static SearchIndex index;
+  return &index;
+}
+
+/*
+ * Path of the file in which the index is saved between sessions
+ */
+QString SearchIndex::getIndexFileName()
+{
+  return ctn_OCTOXBPS_CACHE_DIR + QDir::separator() + "remote-search.idx";
+}
+
+/*
+ * Returns every distinct group of 3 consecutive chars of the given (lower case) text
+ */
+QStringList SearchIndex::getTrigrams(const QString &text)
+{
+  QStringList res;
+
+  for (int i = 0; i + 3 <= text.length(); ++i)
+  {
+    QString trigram = text.mid(i, 3);
+    if (!res.contains(trigram)) res.append(trigram);
+  }
+
+  return res;
+}
+
+/*
+ * Appends one package to the index, updating the trigram lists
+ */
+void SearchIndex::addEntry(const Entry &entry)
+{
+  int id = m_entries.count();
+  m_entries.append(entry);
+
+  QString text = (entry.name + " " + entry.description).toLower();
+
+  foreach(QString trigram, getTrigrams(text))
+  {
+    m_trigrams[trigram].append(id);
+  }
+}
+
+/*
+ * Reads the index.plist of every repository, in the order they are configured. When more than one
+ * repository has the same package, the first one wins (like XBPS does)
+ */
+void SearchIndex::build(const QStringList &repodataFiles)
+{
+  m_entries.clear();
+  m_trigrams.clear();
+
+  QSet<QString> names;
+
+  foreach(QString repodata, repodataFiles)
+  {
+    QVariantMap index = XBPSPlist::parse(XBPSPlist::extractFromArchive(repodata, "index.plist")).toMap();
+
+    for (QVariantMap::const_iterator it = index.constBegin(); it != index.constEnd(); ++it)
+    {
+      if (names.contains(it.key())) continue;
+      names.insert(it.key());
+
+      QVariantMap pkg = it.value().toMap();
+      QString pkgver = pkg.value("pkgver").toString();
+
+      Entry entry;
+      entry.name = it.key();
+      entry.version = pkgver.mid(entry.name.length() + 1);
+      entry.description = pkg.value("short_desc").toString();
+      addEntry(entry);
+    }
+  }
+}
+
+/*
+ * Loads the saved index, if it was built from the same repodata files we have now
+ */
+bool SearchIndex::loadFromFile(const QHash<QString, QDateTime> &repodataModified)
+{
+  QFile file(getIndexFileName());
+  if (!file.open(QIODevice::ReadOnly)) return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_0);
+
+  quint32 magic, version;
+  in >> magic >> version;
+  if (magic != ctn_SEARCH_INDEX_MAGIC || version != ctn_SEARCH_INDEX_VERSION) return false;
+
+  QHash<QString, QDateTime> savedModified;
+  in >> savedModified;
+  if (savedModified != repodataModified) return false;
+
+  QStringList names, versions, descriptions;
+  in >> names >> versions >> descriptions;
+  if (in.status() != QDataStream::Ok || names.count() != versions.count() ||
+      names.count() != descriptions.count()) return false;
+
+  m_entries.clear();
+  m_trigrams.clear();
+
+  for (int i = 0; i < names.count(); ++i)
+  {
+    Entry entry;
+    entry.name = names.at(i);
+    entry.version = versions.at(i);
+    entry.description = descriptions.at(i);
+    addEntry(entry);
+  }
+
+  return true;
+}
+
+/*
+ * Saves the package names, versions and descriptions along with the repodata times they came from.
+ * The trigram lists are cheap to rebuild, so they are not saved
+ */
+void SearchIndex::saveToFile()
+{
+  QDir().mkpath(ctn_OCTOXBPS_CACHE_DIR);
+
+  QFile file(getIndexFileName());
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return;
+
+  QStringList names, versions, descriptions;
+  foreach(Entry entry, m_entries)
+  {
+    names.append(entry.name);
+    versions.append(entry.version);
+    descriptions.append(entry.description);
+  }
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_0);
+  out << ctn_SEARCH_INDEX_MAGIC << ctn_SEARCH_INDEX_VERSION << m_repodataModified;
+  out << names << versions << descriptions;
+}
+
+/*
+ * Rebuilds the index only when a repodata file changed (a sync happened) since it was built
+ */
+void SearchIndex::ensureUpToDate()
+{
+  QHash<QString, QDateTime> modified;
+  QStringList repodataFiles = DependencyGraph::getRepodataFiles();
+
+  foreach(QString repodata, repodataFiles)
+  {
+    modified.insert(repodata, QFileInfo(repodata).lastModified());
+  }
+
+  if (modified.isEmpty() || (m_loaded && modified == m_repodataModified)) return;
+
+  if (!loadFromFile(modified))
+  {
+    build(repodataFiles);
+    if (m_entries.isEmpty())
+    {
+      m_loaded = false;
+      m_loadedFlag = 0;
+      return;
+    }
+
+    m_repodataModified = modified;
+    saveToFile();
+  }
+  else
+  {
+    m_repodataModified = modified;
+  }
+
+  m_loaded = true;
+  m_loadedFlag = 1;
+}
+
+/*
+ * Returns the ids of the entries whose text contains the given (lower case) term
+ */
+QVector<int> SearchIndex::getCandidates(const QString &term) const
+{
+  QVector<int> res;
+  QStringList trigrams = getTrigrams(term);
+
+  if (trigrams.isEmpty())
+  {
+    for (int id = 0; id < m_entries.count(); ++id)
+    {
+      res.append(id);
+    }
+  }
+  else
+  {
+    //Starts with the shortest list and drops whatever is missing from the others
+    QList<const QVector<int> *> lists;
+    foreach(QString trigram, trigrams)
+    {
+      QHash<QString, QVector<int> >::const_iterator it = m_trigrams.constFind(trigram);
+      if (it == m_trigrams.constEnd()) return res;
+
+      lists.append(&it.value());
+    }
+
+    int shortest = 0;
+    for (int i = 1; i < lists.count(); ++i)
+    {
+      if (lists.at(i)->count() < lists.at(shortest)->count()) shortest = i;
+    }
+
+    foreach(int id, *lists.at(shortest))
+    {
+      bool inAll = true;
+      for (int i = 0; i < lists.count() && inAll; ++i)
+      {
+        if (i != shortest)
+          inAll = std::binary_search(lists.at(i)->constBegin(), lists.at(i)->constEnd(), id);
+      }
+
+      if (inAll) res.append(id);
+    }
+  }
+
+  //Trigrams only tell a term may be there, so let's check it
+  QVector<int> checked;
+  foreach(int id, res)
+  {
+    const Entry &entry = m_entries.at(id);
+    if (entry.name.contains(term, Qt::CaseInsensitive) ||
+        entry.description.contains(term, Qt::CaseInsensitive))
+      checked.append(id);
+  }
+
+  return checked;
+}
+
+/*
+ * Returns true if the index could be loaded or built from the repository indexes
+ */
+bool SearchIndex::isAvailable()
+{
+  QMutexLocker locker(&m_mutex);
+  ensureUpToDate();
+
+  return m_loaded;
+}
+
+/*
+ * Returns true if the index is already in memory. It never blocks nor builds anything,
+ * so it is safe to call from the GUI thread
+ */
+bool SearchIndex::isLoaded() const
+{
+  return m_loadedFlag.load() != 0;
+}
+
+/*
+ * Retrieves the repository packages which contain every word of searchString in their
+ * name or description (the same list "xbps-query -Rs" gives). The package list sorts them itself,
+ * so they are not ranked here
+ */
+QList<PackageListData> * SearchIndex::search(const QString &searchString)
+{
+  QMutexLocker locker(&m_mutex);
+  ensureUpToDate();
+
+  QList<PackageListData> * res = new QList<PackageListData>();
+  QStringList terms = searchString.toLower().split(QRegularExpression("\\s+"), QString::SkipEmptyParts);
+  if (terms.isEmpty()) return res;
+
+  QVector<int> ids;
+  bool first = true;
+
+  foreach(QString term, terms)
+  {
+    QVector<int> candidates = getCandidates(term);
+
+    if (first)
+    {
+      ids = candidates;
+      first = false;
+    }
+    else
+    {
+      QVector<int> both;
+      std::set_intersection(ids.constBegin(), ids.constEnd(), candidates.constBegin(), candidates.constEnd(),
+                            std::back_inserter(both));
+      ids = both;
+    }
+
+    if (ids.isEmpty()) return res;
+  }
+
+  DependencyGraph *graph = DependencyGraph::instance();
+
+  foreach(int id, ids)
+  {
+    const Entry &entry = m_entries.at(id);
+    PackageStatus status = graph->isInstalled(entry.name) ? ectn_INSTALLED : ectn_NON_INSTALLED;
+    QString comment = (entry.name + " " + entry.description).trimmed();
+
+    res->append(PackageListData(entry.name, "", entry.version, comment, status, 0, 0));
+  }
+
+  return res;
+}
@@ -0,0 +1,80 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include "package.h"
+
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/*
+ * Full-text index over the names and short descriptions of every repository package.
+ *
+ * It replaces "xbps-query -Rs": the index is built from the repository indexes once per sync,
+ * saved in ctn_OCTOXBPS_CACHE_DIR and reloaded from there at next startup. A lookup intersects
+ * the trigram lists of each search term and checks the candidates.
+ */
+
+class SearchIndex
+{
+private:
+  struct Entry
+  {
+    QString name;
+    QString version;
+    QString description;
+  };
+
+  QVector<Entry> m_entries;
+  QHash<QString, QVector<int> > m_trigrams; //3 chars of "name description" -> entries
+  QHash<QString, QDateTime> m_repodataModified;
+  bool m_loaded;
+  QAtomicInt m_loadedFlag;                  //mirrors m_loaded, readable without m_mutex
+
+  QMutex m_mutex;
+
+  SearchIndex();
+
+  void ensureUpToDate();
+  bool loadFromFile(const QHash<QString, QDateTime> &repodataModified);
+  void saveToFile();
+  void build(const QStringList &repodataFiles);
+  void addEntry(const Entry &entry);
+  QVector<int> getCandidates(const QString &term) const;
+
+  static QString getIndexFileName();
+  static QStringList getTrigrams(const QString &text);
+
+public:
+  static SearchIndex* instance();
+
+  bool isAvailable();
+  bool isLoaded() const;
+  QList<PackageListData> * search(const QString &searchString);
+};
+
+#endif // SEARCHINDEX_H
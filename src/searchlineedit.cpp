@@ -20,11 +20,9 @@
 #include <QStringListModel>
 #include <QDebug>
 
-SearchLineEdit::SearchLineEdit(QWidget *parent, bool hasSLocate) :
+SearchLineEdit::SearchLineEdit(QWidget *parent) :
   QLineEdit(parent){
 
-  m_hasLocate = hasSLocate;
-
   m_completerModel = new QStringListModel(this);
   m_completer = new QCompleter(m_completerModel, this);
   m_completer->setCaseSensitivity(Qt::CaseInsensitive);
@@ -80,17 +78,19 @@ void SearchLineEdit::setRefreshValidator(ValidatorType validatorType)
 }
 
 /*
- * Refreshes completer data used in QLineEdit if slocate is installed
+ * Refreshes completer data used in QLineEdit with the file paths found for its current text
  */
-void SearchLineEdit::refreshCompleterData()
+void SearchLineEdit::setCompleterData(const QStringList &suggestions)
 {
-  if (m_hasLocate)
+  if (suggestions.count() > 0)
   {
-    QStringList sl = UnixCommand::getFilePathSuggestions(text());
+    m_completerModel->setStringList(suggestions);
 
-    if (sl.count() > 0)
+    //The suggestions arrive after the keystroke, so the popup must be asked to show them
+    if (hasFocus())
     {
-      m_completerModel->setStringList(sl);
+      m_completer->setCompletionPrefix(text());
+      m_completer->complete();
     }
   }
 }
@@ -23,7 +23,6 @@ class SearchLineEdit : public QLineEdit
   Q_OBJECT
 
 private:
-  bool m_hasLocate;
   QStringListModel *m_completerModel;
 
   QCompleter *m_completer;
@@ -41,11 +40,11 @@ protected:
   void resizeEvent(QResizeEvent *event);
 
 public:
-  explicit SearchLineEdit(QWidget *parent = NULL, bool hasSLocate = false);
+  explicit SearchLineEdit(QWidget *parent = NULL);
 
   inline void initStyleSheet(){ setStyleSheet(styleSheetForCurrentState()); }
   void setRefreshValidator(ValidatorType validatorType);
-  void refreshCompleterData();
+  void setCompleterData(const QStringList &suggestions);
 
 public slots:
   void setFoundStyle();
@@ -25,6 +25,7 @@
 
 #include "settingsmanager.h"
 #include "unixcommand.h"
+#include "systemcapabilities.h"
 #include "uihelper.h"
 
 #include <QString>
@@ -323,7 +324,7 @@ bool SettingsManager::isValidTerminalSelected()
       userTerminal == ctn_RXVT_TERMINAL ||
       userTerminal == ctn_XTERM)
   {
-    if (UnixCommand::hasTheExecutable(userTerminal))
+    if (SystemCapabilities::hasExecutable(userTerminal))
     {
       return true;
     }
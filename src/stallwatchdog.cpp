@@ -0,0 +1,234 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "stallwatchdog.h"
+#include "tracer.h"
+
+#include <iostream>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QtAlgorithms>
+
+StallWatchdog *StallWatchdog::s_instance = 0;
+
+/*
+ * The watchdog object lives in the GUI thread, so its queued onPing() is answered by the GUI event loop
+ */
+StallWatchdog::StallWatchdog(int threshold)
+{
+  m_threshold = threshold;
+  m_pingPending = false;
+  m_pingSentAt = 0;
+  m_stallDetected = false;
+  m_stalledOperationSince = 0;
+}
+
+/*
+ * Starts watching the GUI event loop. Call it from the GUI thread
+ */
+void StallWatchdog::startWatching(int threshold)
+{
+  if (s_instance != 0) return;
+
+  Tracer::setTrackOperations(true);
+  s_instance = new StallWatchdog(threshold > 0 ? threshold : ctn_STALL_THRESHOLD);
+  s_instance->start(QThread::LowPriority);
+}
+
+/*
+ * Stops the watchdog thread. The statistics gathered so far are kept
+ */
+void StallWatchdog::stopWatching()
+{
+  if (s_instance == 0 || !s_instance->isRunning()) return;
+
+  s_instance->m_stop.store(1);
+  s_instance->wait();
+  Tracer::setTrackOperations(false);
+}
+
+bool StallWatchdog::isWatching()
+{
+  return (s_instance != 0 && s_instance->isRunning());
+}
+
+/*
+ * The watchdog loop: sends a ping whenever the previous one was answered, otherwise checks
+ * whether the GUI thread is late enough to call it a stall
+ */
+void StallWatchdog::run()
+{
+  while (m_stop.load() == 0)
+  {
+    m_mutex.lock();
+    qint64 now = Tracer::operationClock();
+
+    if (!m_pingPending)
+    {
+      m_pingPending = true;
+      m_pingSentAt = now;
+      QMetaObject::invokeMethod(this, "onPing", Qt::QueuedConnection);
+    }
+    else if (!m_stallDetected && now - m_pingSentAt >= m_threshold)
+    {
+      qint64 since;
+      const char *operation = Tracer::getCurrentOperation(&since);
+
+      m_stallDetected = true;
+      if (operation != 0)
+      {
+        m_stalledOperation = QString::fromLatin1(operation);
+        m_stalledOperationSince = since;
+      }
+      else
+      {
+        m_stalledOperation = "(no instrumented operation)";
+        m_stalledOperationSince = m_pingSentAt;
+      }
+    }
+
+    m_mutex.unlock();
+    msleep(ctn_STALL_PING_INTERVAL);
+  }
+}
+
+/*
+ * Runs in the GUI thread: the event loop is answering again
+ */
+void StallWatchdog::onPing()
+{
+  QMutexLocker locker(&m_mutex);
+  qint64 duration = Tracer::operationClock() - m_pingSentAt;
+
+  m_pingPending = false;
+  if (m_stallDetected || duration >= m_threshold)
+  {
+    if (!m_stallDetected)
+    {
+      m_stalledOperation = "(no instrumented operation)";
+      m_stalledOperationSince = m_pingSentAt;
+    }
+
+    finishStall(duration);
+  }
+}
+
+/*
+ * Counts a stall and logs it. Called with m_mutex locked
+ */
+void StallWatchdog::finishStall(qint64 duration)
+{
+  m_stallDetected = false;
+  m_stalls.append(duration);
+
+  OperationStalls &stalls = m_operationStalls[m_stalledOperation];
+  stalls.operation = m_stalledOperation;
+  stalls.count++;
+  stalls.totalTime += duration;
+  if (duration > stalls.maxTime) stalls.maxTime = duration;
+
+  std::cout << "GUI event loop stalled for " << duration << " ms inside " << m_stalledOperation.toLatin1().data()
+            << " (running for " << (m_pingSentAt + duration - m_stalledOperationSince) << " ms)" << std::endl;
+}
+
+/*
+ * Nearest-rank percentile of the sorted "values"
+ */
+static qint64 percentile(const QVector<qint64> &values, int percent)
+{
+  if (values.isEmpty()) return 0;
+
+  int rank = (percent * values.count() + 99) / 100;
+  if (rank < 1) rank = 1;
+
+  return values.at(rank - 1);
+}
+
+StallStatistics StallWatchdog::getStatistics()
+{
+  StallStatistics res;
+  if (s_instance == 0) return res;
+
+  QMutexLocker locker(&s_instance->m_mutex);
+  QVector<qint64> stalls = s_instance->m_stalls;
+  locker.unlock();
+
+  qSort(stalls);
+  foreach(qint64 stall, stalls)
+    res.totalTime += stall;
+
+  res.count = stalls.count();
+  res.p50 = percentile(stalls, 50);
+  res.p99 = percentile(stalls, 99);
+  if (!stalls.isEmpty()) res.maxTime = stalls.last();
+
+  return res;
+}
+
+static bool sortByStallTime(const OperationStalls &a, const OperationStalls &b)
+{
+  return a.totalTime > b.totalTime;
+}
+
+/*
+ * Returns the stalls of each operation, the worst ones first
+ */
+QList<OperationStalls> StallWatchdog::getOperationStatistics()
+{
+  QList<OperationStalls> res;
+  if (s_instance == 0) return res;
+
+  QMutexLocker locker(&s_instance->m_mutex);
+  res = s_instance->m_operationStalls.values();
+  locker.unlock();
+
+  qSort(res.begin(), res.end(), sortByStallTime);
+  return res;
+}
+
+/*
+ * A plain text summary of the stalls, dumped at exit when "-d" is given
+ */
+QString StallWatchdog::getReport()
+{
+  QString res;
+  QTextStream out(&res);
+
+  if (s_instance == 0)
+  {
+    out << "GUI stall watchdog was off\n";
+  }
+  else
+  {
+    StallStatistics stats = getStatistics();
+
+    out << "GUI stalls over " << s_instance->m_threshold << " ms: " << stats.count << ", p50: " << stats.p50
+        << " ms, p99: " << stats.p99 << " ms, max: " << stats.maxTime << " ms, total: " << stats.totalTime << " ms\n";
+
+    foreach(OperationStalls stalls, getOperationStatistics())
+    {
+      out << qSetFieldWidth(8) << stalls.count << stalls.totalTime << stalls.maxTime << qSetFieldWidth(0)
+          << "  " << stalls.operation << "\n";
+    }
+  }
+
+  out.flush();
+  return res;
+}
@@ -0,0 +1,104 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+const int ctn_STALL_THRESHOLD = 200; //msecs without the GUI event loop answering
+const int ctn_STALL_PING_INTERVAL = 50; //msecs, also the resolution of the measured stalls
+
+/*
+ * Stalls seen while the GUI thread was inside the given instrumented operation (a TraceSpan)
+ */
+struct OperationStalls
+{
+  QString operation;
+  int count;
+  qint64 totalTime;
+  qint64 maxTime;
+
+  OperationStalls(): count(0), totalTime(0), maxTime(0){
+  }
+};
+
+struct StallStatistics
+{
+  int count;
+  qint64 p50;
+  qint64 p99;
+  qint64 maxTime;
+  qint64 totalTime;
+
+  StallStatistics(): count(0), p50(0), p99(0), maxTime(0), totalTime(0){
+  }
+};
+
+/*
+ * A watchdog thread which pings the GUI event loop. When an answer takes longer than the
+ * threshold, the TraceSpan the GUI thread is running is taken as the culprit, and the stall
+ * is logged and counted when the loop answers again.
+ */
+class StallWatchdog : public QThread
+{
+  Q_OBJECT
+
+private:
+  int m_threshold;
+  QAtomicInt m_stop;
+
+  QMutex m_mutex; //guards everything below
+  bool m_pingPending;
+  qint64 m_pingSentAt;
+  bool m_stallDetected;
+  QString m_stalledOperation;
+  qint64 m_stalledOperationSince;
+  QVector<qint64> m_stalls;
+  QHash<QString, OperationStalls> m_operationStalls;
+
+  static StallWatchdog *s_instance;
+
+  explicit StallWatchdog(int threshold);
+  void finishStall(qint64 duration);
+
+private slots:
+  void onPing();
+
+protected:
+  virtual void run();
+
+public:
+  static void startWatching(int threshold = ctn_STALL_THRESHOLD);
+  static void stopWatching();
+  static bool isWatching();
+
+  static StallStatistics getStatistics();
+  static QList<OperationStalls> getOperationStatistics();
+  static QString getReport();
+};
+
+#endif // STALLWATCHDOG_H
@@ -41,7 +41,12 @@ public:
   static QString getApplicationCliHelp(){
     QString str =
         "\n" + QObject::tr("OctoXBPS usage help:") + "\n\n" +
-        "-version: " + QObject::tr("show application version."); /*+ "\n" +
+        "-version: " + QObject::tr("show application version.") + "\n" +
+        "-record <dir>: " + QObject::tr("save the output of every xbps query into the given directory.") + "\n" +
+        "-replay <dir>: " + QObject::tr("answer xbps queries with the output saved by -record.") + "\n" +
+        "-replay-latency <ms|recorded>: " + QObject::tr("time each replayed query takes (default: recorded).") + "\n" +
+        "-trace <file>: " + QObject::tr("write a Chrome trace-event JSON file with the timing of this session.") + "\n" +
+        "-watchdog <ms>: " + QObject::tr("log every GUI stall longer than the given time (default with -d: 200).") + "\n"; /*+ "\n" +
         "-style <Qt4-style>: " + QObject::tr("use a different Qt4 style (ex: -style gtk).") + "\n" +
         //"-removecmd <Remove-command>: " + QObject::tr("use a different remove command (ex: -removecmd R).") + "\n" +
         "-sysupgrade: " + QObject::tr("force a system upgrade at startup.") + "\n";*/
@@ -113,6 +118,62 @@ public:
     return QObject::tr("About");
   }
 
+  static QString getHelpDiagnostics(){
+    return QObject::tr("Diagnostics");
+  }
+
+  static QString getDiagnosticsSummary(int processCount, qint64 totalTime){
+    return QObject::tr("%1 processes spawned, %2 ms spent waiting for them").arg(processCount).arg(totalTime);
+  }
+
+  static QString getCommand(){
+    return QObject::tr("Command");
+  }
+
+  static QString getCount(){
+    return QObject::tr("Count");
+  }
+
+  static QString getTotalTime(){
+    return QObject::tr("Total (ms)");
+  }
+
+  static QString getAverageTime(){
+    return QObject::tr("Average (ms)");
+  }
+
+  static QString getMaxTime(){
+    return QObject::tr("Max (ms)");
+  }
+
+  static QString getFailures(){
+    return QObject::tr("Failures");
+  }
+
+  static QString getBytesRead(){
+    return QObject::tr("Bytes read");
+  }
+
+  static QString getStallSummary(int count, qint64 p50, qint64 p99, qint64 maxTime){
+    return QObject::tr("%1 GUI stalls, p50 %2 ms, p99 %3 ms, max %4 ms").arg(count).arg(p50).arg(p99).arg(maxTime);
+  }
+
+  static QString getStallWatchdogOff(){
+    return QObject::tr("The GUI stall watchdog is off (start OctoXBPS with -d or -watchdog <ms>)");
+  }
+
+  static QString getOperation(){
+    return QObject::tr("Operation");
+  }
+
+  static QString getStalls(){
+    return QObject::tr("Stalls");
+  }
+
+  static QString getRefresh(){
+    return QObject::tr("Refresh");
+  }
+
   static QString getName(){
     return QObject::tr("Name");
   }
@@ -505,6 +566,10 @@ public:
     return QObject::tr("'%1' binary was not found.").arg(binName);
   }
 
+  static QString getErrorInvalidReplayLatency(){
+    return QObject::tr("-replay-latency expects a number of milliseconds or \"recorded\".");
+  }
+
   static QString getErrorRunningWithRoot(){
     return QObject::tr("You can not run OctoXBPS with administrator's credentials.");
   }
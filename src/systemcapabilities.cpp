@@ -0,0 +1,211 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "systemcapabilities.h"
+#include "constants.h"
+#include "unixcommand.h"
+
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+
+SystemCapabilities *SystemCapabilities::m_instance = 0;
+
+static QMutex s_capabilitiesMutex;
+
+/*
+ * Builds the snapshot: running processes, known tools and the SU front-end to use
+ */
+SystemCapabilities::SystemCapabilities()
+{
+  probeProcesses();
+  probeExecutables();
+  probeSUFrontEnd();
+}
+
+/*
+ * Returns the current snapshot, probing the system the first time it's called
+ */
+SystemCapabilities* SystemCapabilities::instance()
+{
+  if (m_instance == 0)
+    m_instance = new SystemCapabilities();
+
+  return m_instance;
+}
+
+/*
+ * Reads every "/proc/<pid>/cmdline" to get the same view "ps -A -o command" used to give us
+ */
+void SystemCapabilities::probeProcesses()
+{
+  m_processCommandLines.clear();
+
+  QDir proc("/proc");
+  QStringList pids = proc.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+
+  foreach(QString pid, pids)
+  {
+    if (!pid.at(0).isDigit()) continue;
+
+    QFile cmdLine("/proc/" + pid + "/cmdline");
+    if (!cmdLine.open(QIODevice::ReadOnly)) continue;
+
+    QByteArray data = cmdLine.readAll();
+    cmdLine.close();
+
+    if (data.isEmpty()) continue;
+
+    data.replace('\0', ' ');
+    m_processCommandLines += QString::fromLocal8Bit(data) + "\n";
+  }
+}
+
+/*
+ * Scans PATH for the SU front-ends, terminals, editors and file managers we know about
+ */
+void SystemCapabilities::probeExecutables()
+{
+  m_executables.clear();
+
+  QStringList tools;
+  tools << ctn_GKSU_2 << ctn_KDESU << ctn_TDESU << ctn_LXQTSU << ctn_QSUDO
+        << ctn_KDE_TERMINAL << ctn_TDE_TERMINAL << ctn_XFCE_TERMINAL << ctn_LXDE_TERMINAL
+        << ctn_LXQT_TERMINAL << ctn_MATE_TERMINAL << ctn_CINNAMON_TERMINAL
+        << ctn_PEK_TERMINAL << ctn_RXVT_TERMINAL << ctn_XTERM
+        << ctn_KDE_EDITOR << ctn_KDE4_EDITOR << ctn_TDE_EDITOR << ctn_XFCE_EDITOR
+        << ctn_XFCE_EDITOR_ALT << ctn_LXQT_EDITOR << ctn_MATE_EDITOR << ctn_CINNAMON_EDITOR
+        << ctn_ARCHBANG_EDITOR
+        << ctn_KDE_FILE_MANAGER << ctn_KDE4_FILE_MANAGER << ctn_TDE_FILE_MANAGER
+        << ctn_XFCE_FILE_MANAGER << ctn_LXDE_FILE_MANAGER << ctn_LXQT_FILE_MANAGER
+        << ctn_MATE_FILE_MANAGER << ctn_CINNAMON_FILE_MANAGER << ctn_ARCHBANG_FILE_MANAGER
+        << ctn_ANTERGOS_FILE_MANAGER << ctn_KDE4_OPEN << ctn_KDE5_OPEN;
+
+  foreach(QString tool, tools)
+  {
+    if (!m_executables.contains(tool))
+      m_executables.insert(tool, lookupExecutable(tool));
+  }
+}
+
+/*
+ * Chooses the SU front-end the same way WMHelper::getSUCommand() always did
+ */
+void SystemCapabilities::probeSUFrontEnd()
+{
+  m_suFrontEnd = ctn_NO_SU_COMMAND;
+
+  bool hasGKSU = !m_executables.value(ctn_GKSU_2).isEmpty();
+  bool hasKDESU = !m_executables.value(ctn_KDESU).isEmpty();
+  bool hasTDESU = !m_executables.value(ctn_TDESU).isEmpty();
+  bool hasLXQTSU = !m_executables.value(ctn_LXQTSU).isEmpty();
+
+  if (m_processCommandLines.contains(ctn_XFCE_DESKTOP) && hasGKSU)
+    m_suFrontEnd = ctn_GKSU_2;
+  else if (m_processCommandLines.contains(ctn_KDE_DESKTOP) ||
+           m_processCommandLines.contains(ctn_KDE_X11_DESKTOP) ||
+           m_processCommandLines.contains(ctn_KDE_WAYLAND_DESKTOP))
+    m_suFrontEnd = ctn_KDESU;
+  else if (m_processCommandLines.contains(ctn_TDE_DESKTOP) && hasTDESU)
+    m_suFrontEnd = ctn_TDESU;
+  else if (hasGKSU)
+    m_suFrontEnd = ctn_GKSU_2;
+  else if (hasKDESU)
+    m_suFrontEnd = ctn_KDESU;
+  else if (hasTDESU)
+    m_suFrontEnd = ctn_TDESU;
+  else if (hasLXQTSU)
+    m_suFrontEnd = ctn_LXQTSU;
+}
+
+/*
+ * Returns the full path of the given executable or an empty string
+ */
+QString SystemCapabilities::lookupExecutable(const QString &exeName)
+{
+  return UnixCommand::discoverBinaryPath(exeName);
+}
+
+/*
+ * Throws the current snapshot away and probes the system again
+ */
+void SystemCapabilities::refresh()
+{
+  QMutexLocker locker(&s_capabilitiesMutex);
+
+  delete m_instance;
+  m_instance = new SystemCapabilities();
+}
+
+/*
+ * Scans PATH again for the known tools, and so chooses the SU front-end again. Running processes
+ * are left alone, and nothing is probed if the snapshot wasn't taken yet
+ */
+void SystemCapabilities::refreshExecutables()
+{
+  QMutexLocker locker(&s_capabilitiesMutex);
+  if (m_instance == 0) return;
+
+  m_instance->probeExecutables();
+  m_instance->probeSUFrontEnd();
+}
+
+/*
+ * Returns true if some running process has "processName" in its command line
+ */
+bool SystemCapabilities::isProcessRunning(const QString &processName)
+{
+  QMutexLocker locker(&s_capabilitiesMutex);
+  return instance()->m_processCommandLines.contains(processName);
+}
+
+/*
+ * Returns true if the given executable can be found in PATH
+ */
+bool SystemCapabilities::hasExecutable(const QString &exeName)
+{
+  return !getExecutablePath(exeName).isEmpty();
+}
+
+/*
+ * Returns the full path of the given executable or an empty string if it's not available.
+ * Names not probed at startup are handed to the PATH resolver
+ */
+QString SystemCapabilities::getExecutablePath(const QString &exeName)
+{
+  QMutexLocker locker(&s_capabilitiesMutex);
+  SystemCapabilities *caps = instance();
+
+  QHash<QString, QString>::const_iterator it = caps->m_executables.constFind(exeName);
+  if (it != caps->m_executables.constEnd())
+    return it.value();
+
+  return caps->lookupExecutable(exeName);
+}
+
+/*
+ * Returns the name of the SU front-end to be used, or ctn_NO_SU_COMMAND
+ */
+QString SystemCapabilities::getSUFrontEnd()
+{
+  QMutexLocker locker(&s_capabilitiesMutex);
+  return instance()->m_suFrontEnd;
+}
@@ -0,0 +1,60 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef SYSTEMCAPABILITIES_H
+#define SYSTEMCAPABILITIES_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+/*
+ * This class holds a snapshot of the running desktop environment, the available SU front-end,
+ * terminals and helper tools. It is probed once (reading "/proc" and scanning PATH, without
+ * spawning any process) and it's only rebuilt when someone calls refresh().
+ */
+
+class SystemCapabilities
+{
+private:
+  QString m_processCommandLines;
+  QHash<QString, QString> m_executables; //executable name -> full path ("" when missing)
+  QString m_suFrontEnd;
+
+  SystemCapabilities();
+  static SystemCapabilities *m_instance;
+  static SystemCapabilities* instance();
+
+  void probeProcesses();
+  void probeExecutables();
+  void probeSUFrontEnd();
+  QString lookupExecutable(const QString &exeName);
+
+public:
+  static void refresh();
+  static void refreshExecutables();
+
+  static bool isProcessRunning(const QString &processName);
+  static bool hasExecutable(const QString &exeName);
+  static QString getExecutablePath(const QString &exeName);
+  static QString getSUFrontEnd();
+};
+
+#endif // SYSTEMCAPABILITIES_H
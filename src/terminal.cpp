@@ -21,6 +21,8 @@
 #include "terminal.h"
 #include "wmhelper.h"
 #include "unixcommand.h"
+#include "systemcapabilities.h"
+#include "processaccounting.h"
 
 #include <QApplication>
 #include <QProcess>
@@ -44,6 +46,8 @@ Terminal::Terminal(QObject *parent, const QString &selectedTerminal) : QObject(p
   connect(m_processWrapper, SIGNAL(finishedTerminal(int,QProcess::ExitStatus)),
           this, SIGNAL(finishedTerminal(int,QProcess::ExitStatus)));
 
+  new ProcessWatcher(m_process, m_process);
+
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.insert("LANG", "C");
   env.insert("LC_MESSAGES", "C");
@@ -68,83 +72,83 @@ void Terminal::openTerminal(const QString &dirName)
 
   if (m_selectedTerminal == ctn_AUTOMATIC)
   {
-    if(WMHelper::isXFCERunning() && UnixCommand::hasTheExecutable(ctn_XFCE_TERMINAL)){
+    if(WMHelper::isXFCERunning() && SystemCapabilities::hasExecutable(ctn_XFCE_TERMINAL)){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_XFCE_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_XFCE_TERMINAL, s );
     }
-    else if (WMHelper::isKDERunning() && UnixCommand::hasTheExecutable(ctn_KDE_TERMINAL)){
+    else if (WMHelper::isKDERunning() && SystemCapabilities::hasExecutable(ctn_KDE_TERMINAL)){
       s << "--workdir";
       s << dirName;
 
       if (UnixCommand::isRootRunning())
       {
-        m_process->startDetached( "dbus-launch " + ctn_KDE_TERMINAL + " --workdir " + dirName);
+        ProcessAccounting::startDetached( "dbus-launch " + ctn_KDE_TERMINAL + " --workdir " + dirName);
       }
       else
       {
-        m_process->startDetached( ctn_KDE_TERMINAL, s );
+        ProcessAccounting::startDetached( ctn_KDE_TERMINAL, s );
       }
     }
-    else if (WMHelper::isTDERunning() && UnixCommand::hasTheExecutable(ctn_TDE_TERMINAL)){
+    else if (WMHelper::isTDERunning() && SystemCapabilities::hasExecutable(ctn_TDE_TERMINAL)){
       s << "--workdir";
       s << dirName;
-      m_process->startDetached( ctn_TDE_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_TDE_TERMINAL, s );
     }
-    else if (WMHelper::isLXDERunning() && UnixCommand::hasTheExecutable(ctn_LXDE_TERMINAL)){
+    else if (WMHelper::isLXDERunning() && SystemCapabilities::hasExecutable(ctn_LXDE_TERMINAL)){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_LXDE_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_LXDE_TERMINAL, s );
     }
-    else if (WMHelper::isMATERunning() && UnixCommand::hasTheExecutable(ctn_MATE_TERMINAL)){
+    else if (WMHelper::isMATERunning() && SystemCapabilities::hasExecutable(ctn_MATE_TERMINAL)){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_MATE_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_MATE_TERMINAL, s );
     }
-    else if (WMHelper::isCinnamonRunning() && UnixCommand::hasTheExecutable(ctn_CINNAMON_TERMINAL)){
+    else if (WMHelper::isCinnamonRunning() && SystemCapabilities::hasExecutable(ctn_CINNAMON_TERMINAL)){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_CINNAMON_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_CINNAMON_TERMINAL, s );
     }
-    else if (WMHelper::isLXQTRunning() && UnixCommand::hasTheExecutable(ctn_LXQT_TERMINAL)){
+    else if (WMHelper::isLXQTRunning() && SystemCapabilities::hasExecutable(ctn_LXQT_TERMINAL)){
       s << "--workdir"  ;
       s << dirName;
-      m_process->startDetached( ctn_LXQT_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_LXQT_TERMINAL, s );
     }
-    else if (UnixCommand::hasTheExecutable(ctn_PEK_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_PEK_TERMINAL)){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_PEK_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_PEK_TERMINAL, s );
     }
-    else if (UnixCommand::hasTheExecutable(ctn_XFCE_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_XFCE_TERMINAL)){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_XFCE_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_XFCE_TERMINAL, s );
     }
-    else if (UnixCommand::hasTheExecutable(ctn_MATE_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_MATE_TERMINAL)){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_MATE_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_MATE_TERMINAL, s );
     }
-    else if (UnixCommand::hasTheExecutable(ctn_LXDE_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_LXDE_TERMINAL)){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_LXDE_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_LXDE_TERMINAL, s );
     }
-    else if (UnixCommand::hasTheExecutable(ctn_RXVT_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_RXVT_TERMINAL)){
       QString cmd;
 
-      if (UnixCommand::isAppRunning("urxvtd"))
+      if (SystemCapabilities::isProcessRunning("urxvtd"))
         cmd = "urxvtc -name Urxvt -title Urxvt -cd " + dirName;
       else
         cmd = ctn_RXVT_TERMINAL + " -name Urxvt -title Urxvt -cd " + dirName;
 
-      m_process->startDetached( cmd );
+      ProcessAccounting::startDetached( cmd );
     }
-    else if (UnixCommand::hasTheExecutable(ctn_XTERM)){
+    else if (SystemCapabilities::hasExecutable(ctn_XTERM)){
       QString cmd = ctn_XTERM +
           " -fn \"*-fixed-*-*-*-18-*\" -fg White -bg Black -title xterm -e \"" +
           "cd " + dirName + " && /bin/sh\"";
-      m_process->startDetached( cmd );
+      ProcessAccounting::startDetached( cmd );
     }
   }
   else  //User has chosen a different terminal...
   {
     if(m_selectedTerminal == ctn_XFCE_TERMINAL){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_XFCE_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_XFCE_TERMINAL, s );
     }
     else if (m_selectedTerminal == ctn_KDE_TERMINAL){
       s << "--workdir";
@@ -152,54 +156,54 @@ void Terminal::openTerminal(const QString &dirName)
 
       if (UnixCommand::isRootRunning())
       {
-        m_process->startDetached( "dbus-launch " + ctn_KDE_TERMINAL + " --workdir " + dirName);
+        ProcessAccounting::startDetached( "dbus-launch " + ctn_KDE_TERMINAL + " --workdir " + dirName);
       }
       else
       {
-        m_process->startDetached( ctn_KDE_TERMINAL, s );
+        ProcessAccounting::startDetached( ctn_KDE_TERMINAL, s );
       }
     }
     else if (m_selectedTerminal == ctn_TDE_TERMINAL){
       s << "--workdir";
       s << dirName;
-      m_process->startDetached( ctn_TDE_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_TDE_TERMINAL, s );
     }
     else if (m_selectedTerminal == ctn_LXDE_TERMINAL){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_LXDE_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_LXDE_TERMINAL, s );
     }
     else if (m_selectedTerminal == ctn_MATE_TERMINAL){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_MATE_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_MATE_TERMINAL, s );
     }
     else if (m_selectedTerminal == ctn_CINNAMON_TERMINAL){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_CINNAMON_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_CINNAMON_TERMINAL, s );
     }
     else if (m_selectedTerminal == ctn_LXQT_TERMINAL){
       s << "--workdir";
       s << dirName;
-      m_process->startDetached( ctn_LXQT_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_LXQT_TERMINAL, s );
     }
     else if (m_selectedTerminal == ctn_PEK_TERMINAL){
       s << "--working-directory=" + dirName;
-      m_process->startDetached( ctn_PEK_TERMINAL, s );
+      ProcessAccounting::startDetached( ctn_PEK_TERMINAL, s );
     }
     else if (m_selectedTerminal == ctn_RXVT_TERMINAL){
       QString cmd;
 
-      if (UnixCommand::isAppRunning("urxvtd"))
+      if (SystemCapabilities::isProcessRunning("urxvtd"))
         cmd = "urxvtc -name Urxvt -title Urxvt -cd " + dirName;
       else
         cmd = ctn_RXVT_TERMINAL + " -name Urxvt -title Urxvt -cd " + dirName;
 
-      m_process->startDetached( cmd );
+      ProcessAccounting::startDetached( cmd );
     }
     else if (m_selectedTerminal == ctn_XTERM){
       QString cmd = ctn_XTERM +
           " -fn \"*-fixed-*-*-*-18-*\" -fg White -bg Black -title xterm -e \"" +
           "cd " + dirName + " && /bin/sh\"";
-      m_process->startDetached( cmd );
+      ProcessAccounting::startDetached( cmd );
     }
   }
 }
@@ -211,18 +215,18 @@ void Terminal::openRootTerminal()
 {
   if (m_selectedTerminal == ctn_AUTOMATIC)
   {
-    if (UnixCommand::hasTheExecutable(ctn_RXVT_TERMINAL))
+    if (SystemCapabilities::hasExecutable(ctn_RXVT_TERMINAL))
     {
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_RXVT_TERMINAL +
           " -name Urxvt -title Urxvt \"";
 
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
-    else if(UnixCommand::hasTheExecutable(ctn_XFCE_TERMINAL)){
+    else if(SystemCapabilities::hasExecutable(ctn_XFCE_TERMINAL)){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_XFCE_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
-    else if (WMHelper::isKDERunning() && UnixCommand::hasTheExecutable(ctn_KDE_TERMINAL))
+    else if (WMHelper::isKDERunning() && SystemCapabilities::hasExecutable(ctn_KDE_TERMINAL))
     {
       QString cmd;
 
@@ -235,48 +239,48 @@ void Terminal::openRootTerminal()
         cmd = WMHelper::getSUCommand() + " \"" + ctn_KDE_TERMINAL + "\"";
       }
 
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
-    else if (WMHelper::isTDERunning() && UnixCommand::hasTheExecutable(ctn_TDE_TERMINAL)){
+    else if (WMHelper::isTDERunning() && SystemCapabilities::hasExecutable(ctn_TDE_TERMINAL)){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_TDE_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
-    else if (WMHelper::isLXDERunning() && UnixCommand::hasTheExecutable(ctn_LXDE_TERMINAL)){
+    else if (WMHelper::isLXDERunning() && SystemCapabilities::hasExecutable(ctn_LXDE_TERMINAL)){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_LXDE_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
-    else if (WMHelper::isLXQTRunning() && UnixCommand::hasTheExecutable(ctn_LXQT_TERMINAL)){
+    else if (WMHelper::isLXQTRunning() && SystemCapabilities::hasExecutable(ctn_LXQT_TERMINAL)){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_LXQT_TERMINAL + "\"";
       m_process->start(cmd);
     }
-    else if (WMHelper::isMATERunning() && UnixCommand::hasTheExecutable(ctn_MATE_TERMINAL)){
+    else if (WMHelper::isMATERunning() && SystemCapabilities::hasExecutable(ctn_MATE_TERMINAL)){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_MATE_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
-    else if (WMHelper::isCinnamonRunning() && UnixCommand::hasTheExecutable(ctn_CINNAMON_TERMINAL)){
+    else if (WMHelper::isCinnamonRunning() && SystemCapabilities::hasExecutable(ctn_CINNAMON_TERMINAL)){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_CINNAMON_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
-    else if (UnixCommand::hasTheExecutable(ctn_PEK_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_PEK_TERMINAL)){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_PEK_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
-    else if (UnixCommand::hasTheExecutable(ctn_XFCE_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_XFCE_TERMINAL)){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_XFCE_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
-    else if (UnixCommand::hasTheExecutable(ctn_MATE_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_MATE_TERMINAL)){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_MATE_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
-    else if (UnixCommand::hasTheExecutable(ctn_LXDE_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_LXDE_TERMINAL)){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_LXDE_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
-    else if (UnixCommand::hasTheExecutable(ctn_XTERM)){
+    else if (SystemCapabilities::hasExecutable(ctn_XTERM)){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_XTERM +
           " -fn \"*-fixed-*-*-*-18-*\" -fg White -bg Black -title xterm \"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
   }
   else //User has chosen his own terminal
@@ -286,11 +290,11 @@ void Terminal::openRootTerminal()
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_RXVT_TERMINAL +
           " -name Urxvt -title Urxvt \"";
 
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
     else if(m_selectedTerminal == ctn_XFCE_TERMINAL){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_XFCE_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
     else if (m_selectedTerminal == ctn_KDE_TERMINAL)
     {
@@ -305,36 +309,36 @@ void Terminal::openRootTerminal()
         cmd = WMHelper::getSUCommand() + " \"" + ctn_KDE_TERMINAL + "\"";
       }
 
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
     else if (m_selectedTerminal == ctn_PEK_TERMINAL){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_PEK_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
     else if (m_selectedTerminal == ctn_TDE_TERMINAL){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_TDE_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
     else if (m_selectedTerminal == ctn_LXDE_TERMINAL){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_LXDE_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
     else if (m_selectedTerminal == ctn_LXQT_TERMINAL){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_LXQT_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
     else if (m_selectedTerminal == ctn_MATE_TERMINAL){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_MATE_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
     else if (m_selectedTerminal == ctn_CINNAMON_TERMINAL){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_CINNAMON_TERMINAL + "\"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
     else if (m_selectedTerminal == ctn_XTERM){
       QString cmd = WMHelper::getSUCommand() + " \"" + ctn_XTERM +
           " -fn \"*-fixed-*-*-*-18-*\" -fg White -bg Black -title xterm \"";
-      m_process->startDetached(cmd);
+      ProcessAccounting::startDetached(cmd);
     }
   }
 }
@@ -365,16 +369,16 @@ void Terminal::runCommandInTerminal(const QStringList &commandList)
 
   if (m_selectedTerminal == ctn_AUTOMATIC)
   {
-    if (UnixCommand::hasTheExecutable(ctn_RXVT_TERMINAL))
+    if (SystemCapabilities::hasExecutable(ctn_RXVT_TERMINAL))
     {
       cmd = suCommand + " \"" + ctn_RXVT_TERMINAL + " -title pkg -name pkg -e sh -c " + ftemp->fileName() + "\"";
       m_process->start(cmd);
     }
-    else if(WMHelper::isXFCERunning() && UnixCommand::hasTheExecutable(ctn_XFCE_TERMINAL)){
+    else if(WMHelper::isXFCERunning() && SystemCapabilities::hasExecutable(ctn_XFCE_TERMINAL)){
       cmd = suCommand + " \"" + ctn_XFCE_TERMINAL + " -e \'sh -c " + ftemp->fileName() + "'\"";
       m_process->start(cmd);
     }
-    else if (WMHelper::isKDERunning() && UnixCommand::hasTheExecutable(ctn_KDE_TERMINAL)){
+    else if (WMHelper::isKDERunning() && SystemCapabilities::hasExecutable(ctn_KDE_TERMINAL)){
       if (UnixCommand::isRootRunning())
       {
         cmd = "dbus-launch " + ctn_KDE_TERMINAL + " --nofork -e sh -c " + ftemp->fileName();
@@ -386,43 +390,43 @@ void Terminal::runCommandInTerminal(const QStringList &commandList)
 
       m_process->start(cmd);
     }
-    else if (WMHelper::isTDERunning() && UnixCommand::hasTheExecutable(ctn_TDE_TERMINAL)){
+    else if (WMHelper::isTDERunning() && SystemCapabilities::hasExecutable(ctn_TDE_TERMINAL)){
       cmd = suCommand + " \"" + ctn_TDE_TERMINAL + " --nofork -e sh -c " + ftemp->fileName() + "\"";
       m_process->start(cmd);
     }
-    else if (WMHelper::isLXDERunning() && UnixCommand::hasTheExecutable(ctn_LXDE_TERMINAL)){
+    else if (WMHelper::isLXDERunning() && SystemCapabilities::hasExecutable(ctn_LXDE_TERMINAL)){
       cmd = suCommand + " \"" + ctn_LXDE_TERMINAL + " -e \'sh -c " + ftemp->fileName() + "'\"";
       m_process->start(cmd);
     }
-    else if (WMHelper::isMATERunning() && UnixCommand::hasTheExecutable(ctn_MATE_TERMINAL)){
+    else if (WMHelper::isMATERunning() && SystemCapabilities::hasExecutable(ctn_MATE_TERMINAL)){
       cmd = suCommand + " \"" + ctn_MATE_TERMINAL + " -e \'sh -c " + ftemp->fileName() + "'\"";
       m_process->start(cmd);
     }
-    else if (WMHelper::isCinnamonRunning() && UnixCommand::hasTheExecutable(ctn_CINNAMON_TERMINAL)){
+    else if (WMHelper::isCinnamonRunning() && SystemCapabilities::hasExecutable(ctn_CINNAMON_TERMINAL)){
       cmd = suCommand + " \"" + ctn_CINNAMON_TERMINAL + " -e \'sh -c " + ftemp->fileName() + "'\"";
       m_process->start(cmd);
     }
-    else if (WMHelper::isLXQTRunning() && UnixCommand::hasTheExecutable(ctn_LXQT_TERMINAL)){
+    else if (WMHelper::isLXQTRunning() && SystemCapabilities::hasExecutable(ctn_LXQT_TERMINAL)){
       cmd = suCommand + " \"" + ctn_LXQT_TERMINAL + " -e \'sh -c " + ftemp->fileName() + "'\"";
       m_process->start(cmd);
     }
-    else if (UnixCommand::hasTheExecutable(ctn_PEK_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_PEK_TERMINAL)){
       cmd = suCommand + " \"" + ctn_PEK_TERMINAL + " -e \'sh -c " + ftemp->fileName() + "'\"";
       m_process->start(cmd);
     }
-    else if (UnixCommand::hasTheExecutable(ctn_XFCE_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_XFCE_TERMINAL)){
       cmd = suCommand + " \"" + ctn_XFCE_TERMINAL + " -e \'sh -c " + ftemp->fileName() + "'\"";
       m_process->start(cmd);
     }
-    else if (UnixCommand::hasTheExecutable(ctn_MATE_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_MATE_TERMINAL)){
       cmd = suCommand + " \"" + ctn_MATE_TERMINAL + " -e \'sh -c " + ftemp->fileName() + "'\"";
       m_process->start(cmd);
     }
-    else if (UnixCommand::hasTheExecutable(ctn_LXDE_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_LXDE_TERMINAL)){
       cmd = suCommand + " \"" + ctn_LXDE_TERMINAL + " -e \'sh -c " + ftemp->fileName() + "'\"";
       m_process->start(cmd);
     }
-    else if (UnixCommand::hasTheExecutable(ctn_XTERM)){
+    else if (SystemCapabilities::hasExecutable(ctn_XTERM)){
       cmd = suCommand + " \"" + ctn_XTERM +
           " -fn \"*-fixed-*-*-*-18-*\" -fg White -bg Black -title xterm -e \'sh -c " + ftemp->fileName() + "'\"";
       m_process->start(cmd);
@@ -509,9 +513,9 @@ void Terminal::runCommandInTerminalAsNormalUser(const QStringList &commandList)
 
   if (m_selectedTerminal == ctn_AUTOMATIC)
   {
-    if (UnixCommand::hasTheExecutable(ctn_RXVT_TERMINAL))
+    if (SystemCapabilities::hasExecutable(ctn_RXVT_TERMINAL))
     {
-      if (UnixCommand::isAppRunning("urxvtd"))
+      if (SystemCapabilities::isProcessRunning("urxvtd"))
       {
         cmd = "urxvtc -name Urxvt -title Urxvt -e " + ftemp->fileName();
       }
@@ -520,38 +524,38 @@ void Terminal::runCommandInTerminalAsNormalUser(const QStringList &commandList)
         cmd = ctn_RXVT_TERMINAL + " -name Urxvt -title Urxvt -e " + ftemp->fileName();
       }
     }
-    else if(WMHelper::isXFCERunning() && UnixCommand::hasTheExecutable(ctn_XFCE_TERMINAL)){
+    else if(WMHelper::isXFCERunning() && SystemCapabilities::hasExecutable(ctn_XFCE_TERMINAL)){
       cmd = ctn_XFCE_TERMINAL + " -e " + ftemp->fileName();
     }
-    else if (WMHelper::isKDERunning() && UnixCommand::hasTheExecutable(ctn_KDE_TERMINAL))
+    else if (WMHelper::isKDERunning() && SystemCapabilities::hasExecutable(ctn_KDE_TERMINAL))
     {
       cmd = ctn_KDE_TERMINAL + " --nofork -e sh -c " + ftemp->fileName();
     }
-    else if (WMHelper::isTDERunning() && UnixCommand::hasTheExecutable(ctn_TDE_TERMINAL)){
+    else if (WMHelper::isTDERunning() && SystemCapabilities::hasExecutable(ctn_TDE_TERMINAL)){
       cmd = ctn_TDE_TERMINAL + " --nofork -e " + ftemp->fileName();
     }
-    else if (WMHelper::isLXDERunning() && UnixCommand::hasTheExecutable(ctn_LXDE_TERMINAL)){
+    else if (WMHelper::isLXDERunning() && SystemCapabilities::hasExecutable(ctn_LXDE_TERMINAL)){
       cmd = ctn_LXDE_TERMINAL + " -e " + ftemp->fileName();
     }
-    else if (WMHelper::isMATERunning() && UnixCommand::hasTheExecutable(ctn_MATE_TERMINAL)){
+    else if (WMHelper::isMATERunning() && SystemCapabilities::hasExecutable(ctn_MATE_TERMINAL)){
       cmd = ctn_MATE_TERMINAL + " -e " + ftemp->fileName();
     }
-    else if (WMHelper::isLXQTRunning() && UnixCommand::hasTheExecutable(ctn_LXQT_TERMINAL)){
+    else if (WMHelper::isLXQTRunning() && SystemCapabilities::hasExecutable(ctn_LXQT_TERMINAL)){
       cmd = ctn_LXQT_TERMINAL + " -e sh -c " + ftemp->fileName();
     }
-    else if (WMHelper::isCinnamonRunning() && UnixCommand::hasTheExecutable(ctn_CINNAMON_TERMINAL)){
+    else if (WMHelper::isCinnamonRunning() && SystemCapabilities::hasExecutable(ctn_CINNAMON_TERMINAL)){
       cmd = ctn_CINNAMON_TERMINAL + " -e " + ftemp->fileName();
     }
-    else if (UnixCommand::hasTheExecutable(ctn_PEK_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_PEK_TERMINAL)){
       cmd = ctn_PEK_TERMINAL + " -e " + ftemp->fileName();
     }
-    else if (UnixCommand::hasTheExecutable(ctn_XFCE_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_XFCE_TERMINAL)){
       cmd = ctn_XFCE_TERMINAL + " -e " + ftemp->fileName();
     }
-    else if (UnixCommand::hasTheExecutable(ctn_LXDE_TERMINAL)){
+    else if (SystemCapabilities::hasExecutable(ctn_LXDE_TERMINAL)){
       cmd = ctn_LXDE_TERMINAL + " -e " + ftemp->fileName();
     }
-    else if (UnixCommand::hasTheExecutable(ctn_XTERM)){
+    else if (SystemCapabilities::hasExecutable(ctn_XTERM)){
       cmd = ctn_XTERM +
           " -fn \"*-fixed-*-*-*-18-*\" -fg White -bg Black -title xterm -e " + ftemp->fileName();
     }
@@ -565,7 +569,7 @@ void Terminal::runCommandInTerminalAsNormalUser(const QStringList &commandList)
   {
     if (m_selectedTerminal == ctn_RXVT_TERMINAL)
     {
-      if (UnixCommand::isAppRunning("urxvtd"))
+      if (SystemCapabilities::isProcessRunning("urxvtd"))
       {
         cmd = "urxvtc -name Urxvt -title Urxvt -e " + ftemp->fileName();
       }
@@ -616,34 +620,34 @@ QStringList Terminal::getListOfAvailableTerminals()
   QStringList res;
   res.append(ctn_AUTOMATIC);
 
-  if (UnixCommand::hasTheExecutable(ctn_PEK_TERMINAL))
+  if (SystemCapabilities::hasExecutable(ctn_PEK_TERMINAL))
     res.append(ctn_PEK_TERMINAL);
 
-  if (UnixCommand::hasTheExecutable(ctn_XFCE_TERMINAL))
+  if (SystemCapabilities::hasExecutable(ctn_XFCE_TERMINAL))
     res.append(ctn_XFCE_TERMINAL);
 
-  if (UnixCommand::hasTheExecutable(ctn_LXDE_TERMINAL))
+  if (SystemCapabilities::hasExecutable(ctn_LXDE_TERMINAL))
     res.append(ctn_LXDE_TERMINAL);
 
-  if (UnixCommand::hasTheExecutable(ctn_LXQT_TERMINAL))
+  if (SystemCapabilities::hasExecutable(ctn_LXQT_TERMINAL))
     res.append(ctn_LXQT_TERMINAL);
 
-  if (UnixCommand::hasTheExecutable(ctn_KDE_TERMINAL))
+  if (SystemCapabilities::hasExecutable(ctn_KDE_TERMINAL))
     res.append(ctn_KDE_TERMINAL);
 
-  if (UnixCommand::hasTheExecutable(ctn_TDE_TERMINAL))
+  if (SystemCapabilities::hasExecutable(ctn_TDE_TERMINAL))
     res.append(ctn_TDE_TERMINAL);
 
-  if (UnixCommand::hasTheExecutable(ctn_CINNAMON_TERMINAL))
+  if (SystemCapabilities::hasExecutable(ctn_CINNAMON_TERMINAL))
     res.append(ctn_CINNAMON_TERMINAL);
 
-  if (UnixCommand::hasTheExecutable(ctn_MATE_TERMINAL))
+  if (SystemCapabilities::hasExecutable(ctn_MATE_TERMINAL))
     res.append(ctn_MATE_TERMINAL);
 
-  if (UnixCommand::hasTheExecutable(ctn_RXVT_TERMINAL))
+  if (SystemCapabilities::hasExecutable(ctn_RXVT_TERMINAL))
     res.append(ctn_RXVT_TERMINAL);
 
-  if (UnixCommand::hasTheExecutable(ctn_XTERM))
+  if (SystemCapabilities::hasExecutable(ctn_XTERM))
     res.append(ctn_XTERM);
 
   res.removeDuplicates();
@@ -0,0 +1,246 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "tracer.h"
+
+#include <iostream>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+QAtomicInt Tracer::s_enabled(0);
+QAtomicInt Tracer::s_trackOperations(0);
+
+struct TraceEvent
+{
+  const char *name;
+  char phase; //'X' (complete), 'b' or 'e' (async begin/end)
+  qint64 timestamp; //microseconds since the tracer started
+  qint64 duration;
+  qlonglong threadId;
+  quintptr id;
+  QString detail;
+};
+
+static QMutex s_traceMutex;
+static QElapsedTimer s_traceClock;
+static QVector<TraceEvent> s_traceEvents;
+static QString s_traceFileName;
+static qlonglong s_mainThreadId = 0;
+
+//The innermost span running in the GUI thread. Names are string literals, so they outlive their spans
+static QAtomicPointer<const char> s_currentOperation;
+static QAtomicInteger<qint64> s_currentOperationSince;
+static QElapsedTimer s_operationClock;
+
+/*
+ * Kernel thread ids are short and match what "top -H" or "perf" show
+ */
+static qlonglong getThreadId()
+{
+  return static_cast<qlonglong>(syscall(SYS_gettid));
+}
+
+/*
+ * Turns the tracer on. Events go to "fileName" when stop() is called
+ */
+void Tracer::start(const QString &fileName)
+{
+  QMutexLocker locker(&s_traceMutex);
+
+  s_traceFileName = fileName;
+  s_traceEvents.clear();
+  s_traceEvents.reserve(4096);
+  s_mainThreadId = getThreadId();
+  s_traceClock.start();
+  s_enabled.storeRelease(1);
+}
+
+/*
+ * Turns the tracer off and writes every recorded event as Chrome trace-event JSON
+ */
+void Tracer::stop()
+{
+  QMutexLocker locker(&s_traceMutex);
+  if (!isEnabled()) return;
+
+  s_enabled.storeRelease(0);
+
+  QJsonArray events;
+  qint64 pid = QCoreApplication::applicationPid();
+
+  QJsonObject processName;
+  processName.insert("name", QString("process_name"));
+  processName.insert("ph", QString("M"));
+  processName.insert("pid", double(pid));
+  QJsonObject processArgs;
+  processArgs.insert("name", QString("octoxbps"));
+  processName.insert("args", processArgs);
+  events.append(processName);
+
+  QJsonObject threadName;
+  threadName.insert("name", QString("thread_name"));
+  threadName.insert("ph", QString("M"));
+  threadName.insert("pid", double(pid));
+  threadName.insert("tid", double(s_mainThreadId));
+  QJsonObject threadArgs;
+  threadArgs.insert("name", QString("GUI"));
+  threadName.insert("args", threadArgs);
+  events.append(threadName);
+
+  foreach(TraceEvent traceEvent, s_traceEvents)
+  {
+    QJsonObject event;
+    event.insert("name", QString::fromLatin1(traceEvent.name));
+    event.insert("cat", QString("octoxbps"));
+    event.insert("ph", QString(QChar::fromLatin1(traceEvent.phase)));
+    event.insert("ts", double(traceEvent.timestamp));
+    event.insert("pid", double(pid));
+    event.insert("tid", double(traceEvent.threadId));
+
+    if (traceEvent.phase == 'X')
+      event.insert("dur", double(traceEvent.duration));
+    else
+      event.insert("id", QString("0x") + QString::number(traceEvent.id, 16));
+
+    if (!traceEvent.detail.isEmpty())
+    {
+      QJsonObject args;
+      args.insert("detail", traceEvent.detail);
+      event.insert("args", args);
+    }
+
+    events.append(event);
+  }
+
+  QJsonObject root;
+  root.insert("traceEvents", events);
+  root.insert("displayTimeUnit", QString("ms"));
+
+  QFile file(s_traceFileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    std::cerr << "Could not write the trace file " << s_traceFileName.toStdString() << std::endl;
+    return;
+  }
+
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  s_traceEvents.clear();
+}
+
+/*
+ * Microseconds since the tracer was started
+ */
+qint64 Tracer::now()
+{
+  return s_traceClock.nsecsElapsed() / 1000;
+}
+
+void Tracer::addCompleteEvent(const char *name, qint64 startTime, qint64 duration, const QString &detail)
+{
+  TraceEvent event;
+  event.name = name;
+  event.phase = 'X';
+  event.timestamp = startTime;
+  event.duration = duration;
+  event.threadId = getThreadId();
+  event.id = 0;
+  event.detail = detail;
+
+  QMutexLocker locker(&s_traceMutex);
+  if (isEnabled()) s_traceEvents.append(event);
+}
+
+void Tracer::addAsyncEvent(const char *name, const void *id, bool begin)
+{
+  TraceEvent event;
+  event.name = name;
+  event.phase = begin ? 'b' : 'e';
+  event.timestamp = now();
+  event.duration = 0;
+  event.threadId = getThreadId();
+  event.id = reinterpret_cast<quintptr>(id);
+
+  QMutexLocker locker(&s_traceMutex);
+  if (isEnabled()) s_traceEvents.append(event);
+}
+
+/*
+ * Turns on following the spans of the GUI thread. Call it from the GUI thread, before spans start
+ */
+void Tracer::setTrackOperations(bool value)
+{
+  if (value && !s_operationClock.isValid()) s_operationClock.start();
+  s_currentOperation.store(0);
+  s_trackOperations.storeRelease(value ? 1 : 0);
+}
+
+/*
+ * Makes "name" the current operation, returning the one it nests in. Spans of other threads are ignored
+ */
+bool Tracer::enterOperation(const char *name, const char **previousName, qint64 *previousSince)
+{
+  if (QThread::currentThread() != QCoreApplication::instance()->thread()) return false;
+
+  *previousName = s_currentOperation.load();
+  *previousSince = s_currentOperationSince.load();
+  s_currentOperationSince.store(operationClock());
+  s_currentOperation.store(name);
+
+  return true;
+}
+
+void Tracer::leaveOperation(const char *previousName, qint64 previousSince)
+{
+  s_currentOperation.store(previousName);
+  s_currentOperationSince.store(previousSince);
+}
+
+/*
+ * Returns the span the GUI thread is running (or 0) and since when, in operationClock() msecs.
+ * It's safe to call from any thread
+ */
+const char* Tracer::getCurrentOperation(qint64 *since)
+{
+  const char *res = s_currentOperation.load();
+  *since = s_currentOperationSince.load();
+
+  return res;
+}
+
+/*
+ * Milliseconds since operations started being followed
+ */
+qint64 Tracer::operationClock()
+{
+  return s_operationClock.elapsed();
+}
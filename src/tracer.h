@@ -0,0 +1,121 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QAtomicInt>
+#include <QString>
+#include <QStringList>
+
+/*
+ * A lightweight tracer. While it's on (see the "-trace <file>" switch), TraceSpan objects record
+ * how long their scope took, in which thread and nested in which span; async spans cover work
+ * which starts in one slot and ends in another. Everything is written as Chrome trace-event JSON
+ * (open it in chrome://tracing or Perfetto). When it's off, a span costs a single flag test.
+ *
+ * Spans in the GUI thread can also be followed as the "current operation", which is what
+ * StallWatchdog reports when the event loop stops answering.
+ */
+
+class Tracer
+{
+private:
+  //Read by spans of every thread, so they are atomic
+  static QAtomicInt s_enabled;
+  static QAtomicInt s_trackOperations;
+
+public:
+  static inline bool isEnabled(){ return s_enabled.loadAcquire() != 0; }
+  static inline bool isTrackingOperations(){ return s_trackOperations.loadAcquire() != 0; }
+
+  static void start(const QString &fileName);
+  static void stop();
+
+  static void addCompleteEvent(const char *name, qint64 startTime, qint64 duration, const QString &detail);
+  static void addAsyncEvent(const char *name, const void *id, bool begin);
+  static qint64 now();
+
+  static void setTrackOperations(bool value);
+  static bool enterOperation(const char *name, const char **previousName, qint64 *previousSince);
+  static void leaveOperation(const char *previousName, qint64 previousSince);
+  static const char* getCurrentOperation(qint64 *since);
+  static qint64 operationClock();
+};
+
+class TraceSpan
+{
+private:
+  const char *m_name;
+  QString m_detail;
+  qint64 m_startTime;
+  bool m_tracked;
+  const char *m_previousOperation;
+  qint64 m_previousSince;
+
+public:
+  inline explicit TraceSpan(const char *name): m_name(name), m_startTime(-1), m_tracked(false)
+  {
+    if (Tracer::isEnabled()) m_startTime = Tracer::now();
+    if (Tracer::isTrackingOperations()) m_tracked = Tracer::enterOperation(name, &m_previousOperation, &m_previousSince);
+  }
+
+  inline TraceSpan(const char *name, const QString &detail): m_name(name), m_startTime(-1), m_tracked(false)
+  {
+    if (Tracer::isEnabled())
+    {
+      m_detail = detail;
+      m_startTime = Tracer::now();
+    }
+    if (Tracer::isTrackingOperations()) m_tracked = Tracer::enterOperation(name, &m_previousOperation, &m_previousSince);
+  }
+
+  //The arguments are only joined when the tracer is on
+  inline TraceSpan(const char *name, const QStringList &detail): m_name(name), m_startTime(-1), m_tracked(false)
+  {
+    if (Tracer::isEnabled())
+    {
+      m_detail = detail.join(" ");
+      m_startTime = Tracer::now();
+    }
+    if (Tracer::isTrackingOperations()) m_tracked = Tracer::enterOperation(name, &m_previousOperation, &m_previousSince);
+  }
+
+  inline ~TraceSpan()
+  {
+    if (m_startTime >= 0) Tracer::addCompleteEvent(m_name, m_startTime, Tracer::now() - m_startTime, m_detail);
+    if (m_tracked) Tracer::leaveOperation(m_previousOperation, m_previousSince);
+  }
+};
+
+/*
+ * Async spans, for work started in one place and finished in another. "id" ties both ends together
+ */
+inline void traceAsyncBegin(const char *name, const void *id)
+{
+  if (Tracer::isEnabled()) Tracer::addAsyncEvent(name, id, true);
+}
+
+inline void traceAsyncEnd(const char *name, const void *id)
+{
+  if (Tracer::isEnabled()) Tracer::addAsyncEvent(name, id, false);
+}
+
+#endif // TRACER_H
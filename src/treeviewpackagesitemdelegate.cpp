@@ -27,15 +27,23 @@
 #include <QHelpEvent>
 #include <QFutureWatcher>
 #include <QTreeWidget>
+#include <QTimer>
 #include <QToolTip>
 #include <iostream>
 #include <QtConcurrent/QtConcurrentRun>
 
 QPoint gPoint;
 
+//Hovers closer in time than this are merged into one tooltip request
+const int ctn_TOOLTIP_DEBOUNCE_INTERVAL(150);
+
 TreeViewPackagesItemDelegate::TreeViewPackagesItemDelegate(QObject *parent):
   QStyledItemDelegate(parent)
 {
+  m_toolTipTimer = new QTimer(this);
+  m_toolTipTimer->setSingleShot(true);
+  m_toolTipTimer->setInterval(ctn_TOOLTIP_DEBOUNCE_INTERVAL);
+  connect(m_toolTipTimer, SIGNAL(timeout()), this, SLOT(requestToolTip()));
 }
 
 /*
@@ -44,78 +52,81 @@ TreeViewPackagesItemDelegate::TreeViewPackagesItemDelegate(QObject *parent):
 bool TreeViewPackagesItemDelegate::helpEvent ( QHelpEvent *event, QAbstractItemView*,
     const QStyleOptionViewItem&, const QModelIndex &index )
 {
+  QString pkgName;
+  QTreeView *treeView = qobject_cast<QTreeView*>(this->parent());
+
   if (this->parent()->objectName() == "tvPackages")
   {
-    QTreeView* tvPackages = qobject_cast<QTreeView*>(this->parent());
-    PackageModel* sim = qobject_cast<PackageModel*>(tvPackages->model());
+    PackageModel* sim = qobject_cast<PackageModel*>(treeView->model());
     if (sim == NULL || sim->getPackageCount() == 0) return false;
 
     const PackageRepository::PackageData*const si = sim->getData(index);
-    if (si != NULL)
-    {
-      QPoint p;
-      gPoint = tvPackages->mapToGlobal(event->pos());
-      QFuture<QString> f;
-      disconnect(&g_fwToolTip, SIGNAL(finished()), this, SLOT(execToolTip()));
-      f = QtConcurrent::run(showPackageInfo, si->name);
-      g_fwToolTip.setFuture(f);
-      connect(&g_fwToolTip, SIGNAL(finished()), this, SLOT(execToolTip()));
-    }
-    else return false;
+    if (si == NULL) return false;
+
+    pkgName = si->name;
   }
   else if (this->parent()->objectName() == "tvTransaction")
   {
-    QTreeView* tvTransaction = qobject_cast<QTreeView*>(this->parent());
-    QStandardItemModel *sim = qobject_cast<QStandardItemModel*>(tvTransaction->model());
-
-    if (sim->rowCount() == 0) return false;
+    //Only package items carry their name, "To be removed" and "To be installed" don't
+    pkgName = index.data(ctn_PACKAGE_NAME_ROLE).toString();
 
-    QStandardItem *si = sim->itemFromIndex(index);
-
-    if (si)
+    if (pkgName.isEmpty())
     {
-      //If it's really a package in the Transaction treeview...
-      QString pkgName=si->text();
-
-      //We have to separate Repository from Package Name, first
-      int slash = pkgName.indexOf("/");
-      if (slash != -1)
-      {
-        pkgName = pkgName.mid(slash+1);
-      }
-
-      if (si->icon().pixmap(22, 22).toImage() ==
-          IconHelper::getIconInstallItem().pixmap(22, 22).toImage() ||
-          si->icon().pixmap(22, 22).toImage() ==
-          IconHelper::getIconRemoveItem().pixmap(22, 22).toImage())
-      {
-        gPoint = tvTransaction->mapToGlobal(event->pos());
-        QFuture<QString> f;
-        disconnect(&g_fwToolTip, SIGNAL(finished()), this, SLOT(execToolTip()));
-        f = QtConcurrent::run(showPackageInfo, pkgName);
-        g_fwToolTip.setFuture(f);
-        connect(&g_fwToolTip, SIGNAL(finished()), this, SLOT(execToolTip()));
-      }
-      else
-      {
-        QToolTip::hideText();
-      }
+      m_toolTipTimer->stop();
+      m_toolTipPkgName.clear();
+      QToolTip::hideText();
+      return true;
     }
   }
+  else return true;
+
+  //The mouse is still over the package whose tooltip we are showing
+  if (pkgName == m_toolTipPkgName && (QToolTip::isVisible() || m_toolTipTimer->isActive()))
+    return true;
+
+  m_toolTipPkgName = pkgName;
+  gPoint = treeView->mapToGlobal(event->pos());
+  m_toolTipTimer->start();
 
   return true;
 }
 
+/*
+ * The mouse rested over a package: shows its cached description or starts fetching it
+ */
+void TreeViewPackagesItemDelegate::requestToolTip()
+{
+  QString info;
+
+  if (findCachedPackageInfo(m_toolTipPkgName, info))
+  {
+    showToolTip(info);
+    return;
+  }
+
+  QFuture<QString> f;
+  disconnect(&g_fwToolTip, SIGNAL(finished()), this, SLOT(execToolTip()));
+  f = QtConcurrent::run(showPackageInfo, m_toolTipPkgName);
+  g_fwToolTip.setFuture(f);
+  connect(&g_fwToolTip, SIGNAL(finished()), this, SLOT(execToolTip()));
+}
+
 /*
  * When the tooltip QFuture method is finished, we show the selected tooltip to the user
  */
 void TreeViewPackagesItemDelegate::execToolTip()
 {
-  if (g_fwToolTip.result().trimmed().isEmpty())
+  showToolTip(g_fwToolTip.result());
+}
+
+void TreeViewPackagesItemDelegate::showToolTip(const QString &info)
+{
+  if (info.trimmed().isEmpty())
     return;
 
-  gPoint.setX(gPoint.x() + 25);
-	gPoint.setY(gPoint.y() + 25);
+  QPoint point = gPoint;
+  point.setX(point.x() + 25);
+  point.setY(point.y() + 25);
 
-  QToolTip::showText(gPoint, g_fwToolTip.result());
+  QToolTip::showText(point, info);
 }
@@ -25,9 +25,20 @@
 #include <QStyledItemDelegate>
 #include <QString>
 
+class QTimer;
+
 class TreeViewPackagesItemDelegate : public QStyledItemDelegate
 {
   Q_OBJECT
+
+  private:
+    QTimer *m_toolTipTimer;
+    QString m_toolTipPkgName;
+
+    void showToolTip(const QString &info);
+
+  private slots:
+    void requestToolTip();
 	
 	public:
     TreeViewPackagesItemDelegate(QObject *parent);
@@ -57,6 +57,7 @@ QString OctopiTabInfo::formatTabInfo(const PackageRepository::PackageData& packa
   QString installedOn = StrConstants::getInstalledOn();
   QString options = StrConstants::getOptions();
   QString dependencies = StrConstants::getDependencies();
+  QString requiredBy = StrConstants::getRequiredBy();
   //Let's put package description in UTF-8 format  
   QString pkgDescription;
 
@@ -171,6 +172,13 @@ QString OctopiTabInfo::formatTabInfo(const PackageRepository::PackageData& packa
     if (! pid.options.isEmpty()) html += "<br>";
   }
 
+  if (package.installed())
+  {
+    QString requiredByList = Package::getReverseDependencies(package.name);
+    if (!requiredByList.isEmpty())
+      html += "<tr><td>" + requiredBy + "</td><td>" + requiredByList + "</td></tr>";
+  }
+
   if(! pid.options.isEmpty())
   {
     if (dependenciesList.isEmpty()) html += "<br>";
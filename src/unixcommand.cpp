@@ -19,9 +19,11 @@
 */
 
 #include "unixcommand.h"
-#include "strconstants.h"
 #include "wmhelper.h"
 #include "terminal.h"
+#include "pathresolver.h"
+#include "processaccounting.h"
+#include "privilegedhelperclient.h"
 #include <iostream>
 
 #include <QProcess>
@@ -45,6 +47,7 @@ QFile *UnixCommand::m_temporaryFile = 0;
 QString UnixCommand::runCommand(const QString& commandToRun)
 {
   QProcess proc;
+  ProcessWatcher watcher(&proc);
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.remove("LANG");
   env.remove("LC_MESSAGES");
@@ -56,6 +59,7 @@ QString UnixCommand::runCommand(const QString& commandToRun)
   proc.waitForFinished(-1);
 
   QString res = proc.readAllStandardError();
+  watcher.addBytesRead(res.size());
   proc.close();
 
   return res;
@@ -66,6 +70,7 @@ QString UnixCommand::runCommand(const QString& commandToRun)
  */
 QString UnixCommand::runCurlCommand(const QString& commandToRun){
   QProcess proc;
+  ProcessWatcher watcher(&proc);
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.insert("LANG", "C");
   env.insert("LC_MESSAGES", "C");
@@ -79,39 +84,13 @@ QString UnixCommand::runCurlCommand(const QString& commandToRun){
   if (proc.exitCode() != 0)
   {
     res = proc.readAllStandardError();
+    watcher.addBytesRead(res.size());
   }
 
   proc.close();
   return res;
 }
 
-/*
- * Returns the path of given executable
- */
-QString UnixCommand::discoverBinaryPath(const QString& binary){
-  QProcess proc;
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  env.insert("LANG", "C");
-  env.insert("LC_MESSAGES", "C");
-  proc.setProcessEnvironment(env);
-  proc.start("/usr/bin/sh -c \"which " + binary + "\"");
-  proc.waitForFinished();
-  QString res = proc.readAllStandardOutput();
-
-  proc.close();
-  res = res.remove('\n');
-
-  //If it still didn't find it, try "/sbin" dir...
-  if (res.isEmpty()){
-    QFile fbin("/sbin/" + binary);
-    if (fbin.exists()){
-      res = "/sbin/" + binary;
-    }
-  }
-
-  return res;
-}
-
 /*
  * Cleans Pacman's package cache.
  * Returns true if finished OK
@@ -119,6 +98,7 @@ QString UnixCommand::discoverBinaryPath(const QString& binary){
 bool UnixCommand::cleanPacmanCache()
 {
   QProcess pacman;
+  ProcessWatcher watcher(&pacman);
   QString commandStr = "\"xbps-remove -O\"";
 
   QString command = WMHelper::getSUCommand() + " " + commandStr;
@@ -128,397 +108,6 @@ bool UnixCommand::cleanPacmanCache()
   return (pacman.exitCode() == 0);
 }
 
-/*
- * Performs a pacman query
- */
-QByteArray UnixCommand::performQuery(const QStringList args)
-{
-  QByteArray result("");
-  QProcess pacman;
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  env.insert("LANG", "C");
-  env.insert("LC_MESSAGES", "C");
-  env.insert("LC_ALL", "C");
-  pacman.setProcessEnvironment(env);
-
-  pacman.start("pkg", args);
-  pacman.waitForFinished();
-  result = pacman.readAllStandardOutput();
-  pacman.close();
-
-  return result;
-}
-
-/*
- * Performs a pacman query
- * Overloaded with QString parameter
- */
-QByteArray UnixCommand::performQuery(const QString &args)
-{
-  QByteArray result("");
-  QProcess pacman;
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  env.remove("COLUMNS");
-  env.insert("COLUMNS", "170");
-  env.insert("LANG", "C");
-  env.insert("LC_MESSAGES", "C");
-  env.insert("LC_ALL", "C");
-  pacman.setProcessEnvironment(env);
-
-  pacman.start("xbps-" + args);
-  pacman.waitForFinished();
-  result = pacman.readAllStandardOutput();
-  pacman.close();
-  return result;
-}
-
-/*
- * Performs a yourt command
- */
-QByteArray UnixCommand::performAURCommand(const QString &args)
-{
-  QByteArray result("");
-  QProcess aur;
-
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  env.insert("LANG", "C");
-  env.insert("LC_MESSAGES", "C");
-  aur.setProcessEnvironment(env);
-
-  aur.start(StrConstants::getForeignRepositoryToolName() + " " + args);
-  aur.waitForFinished(-1);
-  result = aur.readAllStandardOutput();
-
-  aur.close();
-  return result;
-}
-
-/*
- * Returns a string containing all AUR packages given a searchString parameter
- */
-QByteArray UnixCommand::getRemotePackageList(const QString &searchString, bool useCommentSearch)
-{
-  QByteArray result("");
-
-  if (useCommentSearch)
-    result = performQuery("query -Rs " + searchString);
-  else
-    result = performQuery("query -Rs " + searchString);
-
-  return result;
-}
-
-/*
- * Returns a string containing all packages no one depends on
- */
-QByteArray UnixCommand::getUnrequiredPackageList()
-{
-  QByteArray result = performQuery("query -m");
-  return result;
-}
-
-/*
- * Returns a string containing all packages that are outdated since last DB sync
- */
-QByteArray UnixCommand::getOutdatedPackageList()
-{
-  //QByteArray result = "qt5-x11extras-5.5.0_2 update x86_64 http://repo.voidlinux.eu/current\nqtchooser-52_1 update x86_64 http://repo.voidlinux.eu/current\nrtkit-0.11_12 update x86_64 http://repo.voidlinux.eu/current\nsudo-1.8.14p3_1 update x86_64 http://repo.voidlinux.eu/current";
-  QByteArray result = performQuery("install -un");
-  return result;
-}
-
-/*
- * Returns a string containing all AUR outdated packages
- */
-QByteArray UnixCommand::getOutdatedAURPackageList()
-{
-  QByteArray result;
-
-  if (StrConstants::getForeignRepositoryToolName() == "kcp")
-  {
-    result = performAURCommand("-lO");
-  }
-  else if (StrConstants::getForeignRepositoryToolName() != "kcp")
-  {
-    result = performAURCommand("-Qua");
-  }
-
-  return result;
-}
-
-/*
- * Returns a string containing all packages that are not contained in any repository
- * (probably the ones installed by a tool such as yaourt)
- */
-QByteArray UnixCommand::getForeignPackageList()
-{
-  QByteArray result = performQuery(QStringList("-Qm"));
-  return result;
-}
-
-/*
- * Retrieves the dependencies pkg list
- */
-QByteArray UnixCommand::getDependenciesList(const QString &pkgName)
-{
-  QByteArray result = performQuery("query -x " + pkgName);
-  return result;
-}
-
-/*
- * Retrieves the remote dependencies pkg list
- */
-QByteArray UnixCommand::getRemoteDependenciesList(const QString &pkgName)
-{
-  QByteArray result = performQuery("query -Rx " + pkgName);
-  return result;
-}
-
-/*
- * Returns a string with the list of all packages available in all repositories
- * (installed + not installed)
- *
- * @param pkgName Used while the user is searching for the pkg that provides a certain file
- */
-QByteArray UnixCommand::getPackageList(const QString &pkgName)
-{
-  QByteArray result;
-
-  if (pkgName.isEmpty())
-  {
-#ifdef UNIFIED_SEARCH
-    result = performQuery("query -Rs -");
-#else
-    result = performQuery("query -l");
-#endif
-  }
-  else
-  {
-  }
-
-  return result;
-}
-
-/*
- * Given a package name and if it is default to the official repositories,
- * returns a string containing all of its information fields
- * (ex: name, description, version, dependsOn...)
- */
-QByteArray UnixCommand::getPackageInformation(const QString &pkgName, bool foreignPackage = false)
-{
-  QString args;
-
-  if(foreignPackage)
-  {
-  }
-  else
-  {
-    args = "query " + pkgName;
-  }
-
-  //if (pkgName.isEmpty() == false) // enables get for all ("")
-  //  args << pkgName;
-
-  QByteArray result = performQuery(args);
-  return result;
-}
-
-/*
- * Given an AUR package name, returns a string containing all of its information fields
- * (ex: name, description, version, dependsOn...)
- */
-QByteArray UnixCommand::getAURPackageVersionInformation()
-{
-  QByteArray result;
-
-  if (StrConstants::getForeignRepositoryToolName() == "kcp")
-  {
-    result = performAURCommand("-lO");
-  }
-  else if (StrConstants::getForeignRepositoryToolName() != "kcp")
-  {
-    result = performAURCommand("-Qua");
-  }
-
-  return result;
-}
-
-/*
- * Given a package name, returns a string containing all the files inside it
- */
-QByteArray UnixCommand::getPackageContentsUsingPacman(const QString& pkgName)
-{
-  QByteArray res = performQuery("query -f " + pkgName);
-  return res;
-}
-
-/*
- * Check if pkgfile is installed on the system
- */
-bool UnixCommand::isPkgfileInstalled()
-{
-  QProcess pkgfile;
-
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  pkgfile.setProcessEnvironment(env);
-
-  pkgfile.start("pkgfile -V");
-  pkgfile.waitForFinished();
-
-  return pkgfile.exitStatus() == QProcess::NormalExit;
-}
-
-/*
- * Given a package name, which can be installed or uninstalled on system
- * returns a string containing all the files inside it, the file list is
- * obtained using pkgfile
- */
-QByteArray UnixCommand::getPackageContentsUsingPkgfile(const QString &pkgName)
-{
-  QByteArray result("");
-  QProcess pkgfile;
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  env.insert("LANG", "C");
-  env.insert("LC_MESSAGES", "C");
-  pkgfile.setProcessEnvironment(env);
-
-  pkgfile.start("pkgfile -l " + pkgName);
-  pkgfile.waitForFinished();
-  result = pkgfile.readAllStandardOutput();
-
-  return result;
-}
-
-/*
- * Given a complete file path, returns the package that provides that file
- */
-QString UnixCommand::getPackageByFilePath(const QString &filePath)
-{
-  QString pkgName="";
-  QString out = performQuery("query -o " + filePath);
-
-  if (!out.isEmpty())
-  {
-    int pos = out.indexOf(":");
-    if (pos != -1)
-    {      
-      pkgName = out.left(pos);
-      //Now we have to remove the pkg version...
-      int dash = pkgName.lastIndexOf("-");
-      if (dash != -1)
-      {
-        pkgName = pkgName.left(dash);
-      }
-    }
-  }
-
-  return pkgName;
-}
-
-/*
- * Based on the given file, we use 'slocate' to suggest complete paths
- */
-QStringList UnixCommand::getFilePathSuggestions(const QString &file)
-{
-  QProcess slocate;
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  env.insert("LANG", "C");
-  env.insert("LC_MESSAGES", "C");
-  slocate.setProcessEnvironment(env);
-  slocate.start("slocate -l 8 " + file);
-  slocate.waitForFinished();
-
-  QString ba = slocate.readAllStandardOutput();
-  return ba.split("\n", QString::SkipEmptyParts);
-}
-
-/*
- * Retrives the list of package groups
- */
-QByteArray UnixCommand::getPackageGroups()
-{
-  QByteArray res = performQuery(QStringList("-Sg"));
-  return res;
-}
-
-/*
- * Given a group name, returns a string containing all packages from it
- */
-QByteArray UnixCommand::getPackagesFromGroup(const QString &groupName)
-{
-  QByteArray res =
-      performQuery(QString("--print-format \"%r %n\" -Spg " ) + groupName);
-
-  return res;
-}
-
-/*
- * Retrieves the list of installed packages in a special format for TargetList
- */
-QByteArray UnixCommand::getInstalledPackages()
-{
-  QString args = "query '%n-%v %n#%v";
-  QByteArray res = performQuery(args);
-  return res;
-}
-
-/*
- * Retrieves the list of targets needed to update the entire system or a given package
- */
-QByteArray UnixCommand::getTargetUpgradeList(const QString &pkgName)
-{
-  QString args;
-  QByteArray res = "";
-
-  if(!pkgName.isEmpty())
-  {
-    args = "install -n -f -Rs " + pkgName;
-    res = performQuery(args);
-  }
-  else //pkg upgrade
-  {
-    args = "install -un";
-    res = performQuery(args);
-  }
-
-  return res;
-}
-
-/*
- * Given a package name, retrieves the list of all targets needed for its removal
- */
-QByteArray UnixCommand::getTargetRemovalList(const QString &pkgName)
-{
-  QString args;
-  QByteArray res = "";
-
-  if(!pkgName.isEmpty())
-  {
-    args = "remove -R -n " + pkgName;
-    res = performQuery(args);
-  }
-
-  return res;
-}
-
-/*
- * Retrieves the given field for a local package search
- */
-QByteArray UnixCommand::getFieldFromLocalPackage(const QString &field, const QString &pkgName)
-{
-  QByteArray res = performQuery("query -p " + field + " " + pkgName);
-  return res;
-}
-
-/*
- * Retrieves the given field for a remote package search
- */
-QByteArray UnixCommand::getFieldFromRemotePackage(const QString &field, const QString &pkgName)
-{
-  QByteArray res = performQuery("query -R -p " + field + " " + pkgName);
-  return res;
-}
-
 /*
  * Retrieves the system arch
  */
@@ -526,6 +115,7 @@ QString UnixCommand::getSystemArchitecture()
 {
   QStringList slParam;
   QProcess proc;
+  ProcessWatcher watcher(&proc);
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.insert("LANG", "C");
   env.insert("LC_MESSAGES", "C");
@@ -536,6 +126,7 @@ QString UnixCommand::getSystemArchitecture()
   proc.waitForFinished();
 
   QString out = proc.readAllStandardOutput();
+  watcher.addBytesRead(out.size());
   proc.close();
 
   return out;
@@ -583,6 +174,7 @@ bool UnixCommand::hasInternetConnection()
 bool UnixCommand::doInternetPingTest()
 {
   QProcess ping;
+  ProcessWatcher watcher(&ping);
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.insert("LANG", "C");
   env.insert("LC_MESSAGES", "C");
@@ -604,18 +196,7 @@ bool UnixCommand::hasTheExecutable( const QString& exeName )
 {
   //std::cout << "Searching for the executable: " << exeName.toLatin1().data() << std::endl;
 
-  QProcess proc;
-  proc.setProcessChannelMode(QProcess::MergedChannels);
-  QString sParam = "\"which " + exeName + "\"";
-
-  proc.start("/bin/sh -c " + sParam);
-  proc.waitForFinished();
-
-  QString out = proc.readAllStandardOutput();
-  proc.close();
-
-  if (out.isEmpty() || out.count("which") > 0) return false;
-  else return true;
+  return !PathResolver::instance()->resolve(exeName).isEmpty();
 }
 
 /*
@@ -653,7 +234,7 @@ void UnixCommand::removeTemporaryFiles()
  */
 void UnixCommand::execCommandAsNormalUser(const QString &pCommand)
 {
-  QProcess::startDetached(pCommand);
+  ProcessAccounting::startDetached(pCommand);
 }
 
 /*
@@ -662,6 +243,7 @@ void UnixCommand::execCommandAsNormalUser(const QString &pCommand)
 void UnixCommand::execCommand(const QString &pCommand)
 {
   QProcess p;
+  ProcessWatcher watcher(&p);
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.insert("LANG", "C");
   env.insert("LC_MESSAGES", "C");
@@ -678,6 +260,7 @@ void UnixCommand::execCommand(const QString &pCommand)
 QByteArray UnixCommand::getCommandOutput(const QString &pCommand)
 {
   QProcess p;
+  ProcessWatcher watcher(&p);
   /*QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.insert("LANG", "C");
   env.insert("LC_MESSAGES", "C");
@@ -685,7 +268,11 @@ QByteArray UnixCommand::getCommandOutput(const QString &pCommand)
 
   p.start(pCommand);
   p.waitForFinished(-1);
-  return p.readAllStandardOutput();
+
+  QByteArray res = p.readAllStandardOutput();
+  watcher.addBytesRead(res.size());
+
+  return res;
 }
 
 /*
@@ -694,6 +281,7 @@ QByteArray UnixCommand::getCommandOutput(const QString &pCommand)
 bool UnixCommand::isTextFile(const QString& fileName)
 {
   QProcess *p = new QProcess();
+  ProcessWatcher watcher(p);
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.insert("LANG", "C");
   env.insert("LC_MESSAGES", "C");
@@ -704,6 +292,7 @@ bool UnixCommand::isTextFile(const QString& fileName)
   p->waitForFinished();
 
   QByteArray output = p->readAllStandardOutput();
+  watcher.addBytesRead(output.size());
   p->close();
   delete p;
 
@@ -769,19 +358,71 @@ void UnixCommand::executeCommand(const QString &pCommand, Language lang)
   }
   else
   {
-    if (WMHelper::getSUCommand() == ctn_KDESU)
-    {
-      command = WMHelper::getSUCommand() + pCommand;
-    }
-    else
-    {
-      command = WMHelper::getSUCommand() + "\"" + pCommand + "\"";
-    }
+    if (executeWithPrivilegedHelper(pCommand, lang)) return;
+
+    command = getRootCommand(pCommand);
   }
 
   m_process->start(command);
 }
 
+/*
+ * Wraps the given command in the SU front-end, so it runs with ROOT credentials
+ */
+QString UnixCommand::getRootCommand(const QString &pCommand)
+{
+  if (WMHelper::getSUCommand() == ctn_KDESU)
+  {
+    return WMHelper::getSUCommand() + pCommand;
+  }
+  else
+  {
+    return WMHelper::getSUCommand() + "\"" + pCommand + "\"";
+  }
+}
+
+/*
+ * Queues the given command in octoxbps-helper, which only asks for the password the first time.
+ * Returns false if the helper isn't installed or can't run it, so the SU front-end is used instead
+ */
+bool UnixCommand::executeWithPrivilegedHelper(const QString &pCommand, Language lang)
+{
+  if (!PrivilegedHelperClient::isAvailable()) return false;
+
+  QList<QStringList> commands = PrivilegedHelperClient::parseCommand(pCommand);
+  if (commands.isEmpty()) return false;
+
+  PrivilegedHelperClient *helper = PrivilegedHelperClient::instance();
+  QString locale = (lang == ectn_LANG_USER_DEFINED ? QLocale::system().name() + ".UTF-8" : "C");
+
+  QObject::connect(helper, SIGNAL( started() ), this, SIGNAL( started() ));
+  QObject::connect(helper, SIGNAL( readyReadStandardOutput() ), this, SIGNAL( readyReadStandardOutput() ));
+  QObject::connect(helper, SIGNAL( readyReadStandardError() ), this, SIGNAL( readyReadStandardError() ));
+  QObject::connect(helper, SIGNAL( finished ( int, QProcess::ExitStatus )), this,
+                   SIGNAL( finished ( int, QProcess::ExitStatus )) );
+  QObject::connect(helper, SIGNAL( finished ( int, QProcess::ExitStatus )), this,
+                   SLOT( onPrivilegedHelperFinished() ));
+
+  m_usingPrivilegedHelper = true;
+
+  if (!helper->execute(commands, locale))
+  {
+    onPrivilegedHelperFinished();
+    return false;
+  }
+
+  return true;
+}
+
+/*
+ * The helper is shared by every UnixCommand of this process, so we stop listening to it
+ */
+void UnixCommand::onPrivilegedHelperFinished()
+{
+  m_usingPrivilegedHelper = false;
+  QObject::disconnect(PrivilegedHelperClient::instance(), 0, this, 0);
+}
+
 /*
  * Executes the given command using QProcess async technology as a normal user
  */
@@ -795,8 +436,15 @@ void UnixCommand::executeCommandAsNormalUser(const QString &pCommand)
  */
 void UnixCommand::processReadyReadStandardOutput()
 {
-  if (m_process->isOpen())
+  if (m_usingPrivilegedHelper)
+  {
+    m_readAllStandardOutput = PrivilegedHelperClient::instance()->readAllStandardOutput();
+  }
+  else if (m_process->isOpen())
+  {
     m_readAllStandardOutput = m_process->readAllStandardOutput();
+    m_processWatcher->addBytesRead(m_readAllStandardOutput.size());
+  }
 }
 
 /*
@@ -804,9 +452,14 @@ void UnixCommand::processReadyReadStandardOutput()
  */
 void UnixCommand::processReadyReadStandardError()
 {
-  if (m_process->isOpen())
+  if (m_usingPrivilegedHelper)
+  {
+    m_readAllStandardError = PrivilegedHelperClient::instance()->readAllStandardError();
+  }
+  else if (m_process->isOpen())
   {
     m_readAllStandardError = m_process->readAllStandardError();
+    m_processWatcher->addBytesRead(m_readAllStandardError.size());
     m_errorString = m_process->errorString();
   }
 }
@@ -842,6 +495,7 @@ UnixCommand::UnixCommand(QObject *parent): QObject()
 {
   m_process = new QProcess(parent);
   m_terminal = new Terminal(parent, SettingsManager::getTerminal());
+  m_usingPrivilegedHelper = false;
 
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.insert("LANG", "C");
@@ -868,6 +522,8 @@ UnixCommand::UnixCommand(QObject *parent): QObject()
   QObject::connect(this, SIGNAL( readyReadStandardError() ), this,
                    SLOT( processReadyReadStandardError() ));
 
+  m_processWatcher = new ProcessWatcher(m_process, m_process);
+
   //Terminal signals
   QObject::connect(m_terminal, SIGNAL( started()), this,
                    SIGNAL( started()));
@@ -888,6 +544,7 @@ bool UnixCommand::isAppRunning(const QString &appName, bool justOneInstance)
 {
   QStringList slParam;
   QProcess proc;
+  ProcessWatcher watcher(&proc);
 
   slParam << "-C";
   //ps only works with 15 char process names
@@ -897,6 +554,7 @@ bool UnixCommand::isAppRunning(const QString &appName, bool justOneInstance)
   proc.waitForFinished();
 
   QString out = proc.readAll();
+  watcher.addBytesRead(out.size());
   proc.close();
 
   if (justOneInstance)
@@ -921,6 +579,7 @@ bool UnixCommand::isAppRunning(const QString &appName, bool justOneInstance)
 bool UnixCommand::isPackageInstalled(const QString &pkgName)
 {
   QProcess pacman;
+  ProcessWatcher watcher(&pacman);
   QString command = "xbps-query -S " + pkgName;
   pacman.start(command);
   pacman.waitForFinished();
@@ -1043,39 +702,3 @@ QStringList UnixCommand::getIgnorePkgsFromPacmanConf()
   resPkgs.removeDuplicates();
   return resPkgs;
 }
-
-/*
- * Retrieves the BSDFlavour where OctoPkg is running on!
- * Reads file "/etc/os-release" and searchs for compatible OctoPkg BSDs
- */
-LinuxDistro UnixCommand::getLinuxDistro()
-{
-  static LinuxDistro ret;
-  static bool firstTime = true;
-
-  if (firstTime)
-  {
-    if (QFile::exists("/etc/os-release"))
-    {
-      QFile file("/etc/os-release");
-
-      if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-        ret = ectn_UNKNOWN;
-
-      QString contents = file.readAll();
-
-      if (contents.contains("PRETTY_NAME=\"void\""))
-      {
-        ret = ectn_VOID;
-      }
-      else
-      {
-        ret = ectn_UNKNOWN;
-      }
-    }
-
-    firstTime = false;
-  }
-
-  return ret;
-}
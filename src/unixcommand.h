@@ -45,6 +45,7 @@ enum Language { ectn_LANG_ENGLISH, ectn_LANG_USER_DEFINED };*/
 class QString;
 class QStringList;
 class Terminal;
+class ProcessWatcher;
 
 class UnixCommand : public QObject{
   Q_OBJECT
@@ -55,12 +56,17 @@ private:
   QString m_errorString;
   Terminal *m_terminal;
   QProcess *m_process;
+  ProcessWatcher *m_processWatcher;
+  bool m_usingPrivilegedHelper;
   static QFile *m_temporaryFile;
 
+  bool executeWithPrivilegedHelper(const QString &pCommand, Language lang);
+
 public:
   UnixCommand(QObject *parent);
 
   inline QProcess * getProcess(){ return m_process; }
+  inline bool isUsingPrivilegedHelper(){ return m_usingPrivilegedHelper; }
 
   //Returns true if ILoveCandy is enabled in "/etc/pacman.conf"
   static bool isILoveCandyEnabled();
@@ -90,6 +96,7 @@ public:
   static QByteArray getForeignPackageList();
   static QByteArray getDependenciesList(const QString &pkgName);
   static QByteArray getRemoteDependenciesList(const QString &pkgName);
+  static QByteArray getReverseDependenciesList(const QString &pkgName);
   static QByteArray getPackageList(const QString &pkgName = "");
   static QByteArray getPackageInformation(const QString &pkgName, bool foreignPackage);
   static QByteArray getAURPackageVersionInformation();
@@ -153,6 +160,7 @@ public:
   static void execCommandAsNormalUser(const QString &pCommand);
   static void execCommand(const QString &pCommand);
   static QByteArray getCommandOutput(const QString &pCommand);
+  static QString getRootCommand(const QString &pCommand);
 
   void executeCommand(const QString &pCommand, Language lang=ectn_LANG_ENGLISH);
   void executeCommandAsNormalUser(const QString &pCommand);
@@ -165,6 +173,9 @@ public slots:
   void processReadyReadStandardOutput();
   void processReadyReadStandardError();
 
+private slots:
+  void onPrivilegedHelperFinished();
+
 signals:
   void started();
   void readyReadStandardOutput();
@@ -0,0 +1,472 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "unixcommand.h"
+#include "strconstants.h"
+#include "pathresolver.h"
+#include "queryrecorder.h"
+#include "tracer.h"
+#include "processaccounting.h"
+
+#include <QProcess>
+#include <QFile>
+#include <QByteArray>
+
+/*
+ * UnixCommand methods which only query XBPS (and the system) and return what they read.
+ * They don't need a GUI, so octoxbps-daemon links them without the rest of UnixCommand
+ */
+
+/*
+ * Returns the path of given executable
+ */
+QString UnixCommand::discoverBinaryPath(const QString& binary){
+  QString res = PathResolver::instance()->resolve(binary);
+
+  //If it still didn't find it, try "/sbin" dir...
+  if (res.isEmpty()){
+    QFile fbin("/sbin/" + binary);
+    if (fbin.exists()){
+      res = "/sbin/" + binary;
+    }
+  }
+
+  return res;
+}
+
+/*
+ * Performs a pacman query
+ */
+QByteArray UnixCommand::performQuery(const QStringList args)
+{
+  TraceSpan span("UnixCommand::performQuery", args);
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.insert("LANG", "C");
+  env.insert("LC_MESSAGES", "C");
+  env.insert("LC_ALL", "C");
+
+  return QueryRecorder::execute("pkg", args, env);
+}
+
+/*
+ * Performs a pacman query
+ * Overloaded with QString parameter
+ */
+QByteArray UnixCommand::performQuery(const QString &args)
+{
+  TraceSpan span("UnixCommand::performQuery", args);
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.remove("COLUMNS");
+  env.insert("COLUMNS", "170");
+  env.insert("LANG", "C");
+  env.insert("LC_MESSAGES", "C");
+  env.insert("LC_ALL", "C");
+
+  return QueryRecorder::execute("xbps-" + args, env);
+}
+
+/*
+ * Performs a yourt command
+ */
+QByteArray UnixCommand::performAURCommand(const QString &args)
+{
+  TraceSpan span("UnixCommand::performAURCommand", args);
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.insert("LANG", "C");
+  env.insert("LC_MESSAGES", "C");
+
+  return QueryRecorder::execute(StrConstants::getForeignRepositoryToolName() + " " + args, env, -1);
+}
+
+/*
+ * Returns a string containing all AUR packages given a searchString parameter
+ */
+QByteArray UnixCommand::getRemotePackageList(const QString &searchString, bool useCommentSearch)
+{
+  QByteArray result("");
+
+  if (useCommentSearch)
+    result = performQuery("query -Rs " + searchString);
+  else
+    result = performQuery("query -Rs " + searchString);
+
+  return result;
+}
+
+/*
+ * Returns a string containing all packages no one depends on
+ */
+QByteArray UnixCommand::getUnrequiredPackageList()
+{
+  QByteArray result = performQuery("query -m");
+  return result;
+}
+
+/*
+ * Returns a string containing all packages that are outdated since last DB sync
+ */
+QByteArray UnixCommand::getOutdatedPackageList()
+{
+  //QByteArray result = "qt5-x11extras-5.5.0_2 update x86_64 http://repo.voidlinux.eu/current\nqtchooser-52_1 update x86_64 http://repo.voidlinux.eu/current\nrtkit-0.11_12 update x86_64 http://repo.voidlinux.eu/current\nsudo-1.8.14p3_1 update x86_64 http://repo.voidlinux.eu/current";
+  QByteArray result = performQuery("install -un");
+  return result;
+}
+
+/*
+ * Returns a string containing all AUR outdated packages
+ */
+QByteArray UnixCommand::getOutdatedAURPackageList()
+{
+  QByteArray result;
+
+  if (StrConstants::getForeignRepositoryToolName() == "kcp")
+  {
+    result = performAURCommand("-lO");
+  }
+  else if (StrConstants::getForeignRepositoryToolName() != "kcp")
+  {
+    result = performAURCommand("-Qua");
+  }
+
+  return result;
+}
+
+/*
+ * Returns a string containing all packages that are not contained in any repository
+ * (probably the ones installed by a tool such as yaourt)
+ */
+QByteArray UnixCommand::getForeignPackageList()
+{
+  QByteArray result = performQuery(QStringList("-Qm"));
+  return result;
+}
+
+/*
+ * Retrieves the dependencies pkg list
+ */
+QByteArray UnixCommand::getDependenciesList(const QString &pkgName)
+{
+  QByteArray result = performQuery("query -x " + pkgName);
+  return result;
+}
+
+/*
+ * Retrieves the remote dependencies pkg list
+ */
+QByteArray UnixCommand::getRemoteDependenciesList(const QString &pkgName)
+{
+  QByteArray result = performQuery("query -Rx " + pkgName);
+  return result;
+}
+
+/*
+ * Retrieves the installed packages which depend on the given one
+ */
+QByteArray UnixCommand::getReverseDependenciesList(const QString &pkgName)
+{
+  QByteArray result = performQuery("query -X " + pkgName);
+  return result;
+}
+
+/*
+ * Returns a string with the list of all packages available in all repositories
+ * (installed + not installed)
+ *
+ * @param pkgName Used while the user is searching for the pkg that provides a certain file
+ */
+QByteArray UnixCommand::getPackageList(const QString &pkgName)
+{
+  QByteArray result;
+
+  if (pkgName.isEmpty())
+  {
+#ifdef UNIFIED_SEARCH
+    result = performQuery("query -Rs -");
+#else
+    result = performQuery("query -l");
+#endif
+  }
+  else
+  {
+  }
+
+  return result;
+}
+
+/*
+ * Given a package name and if it is default to the official repositories,
+ * returns a string containing all of its information fields
+ * (ex: name, description, version, dependsOn...)
+ */
+QByteArray UnixCommand::getPackageInformation(const QString &pkgName, bool foreignPackage = false)
+{
+  QString args;
+
+  if(foreignPackage)
+  {
+  }
+  else
+  {
+    args = "query " + pkgName;
+  }
+
+  //if (pkgName.isEmpty() == false) // enables get for all ("")
+  //  args << pkgName;
+
+  QByteArray result = performQuery(args);
+  return result;
+}
+
+/*
+ * Given an AUR package name, returns a string containing all of its information fields
+ * (ex: name, description, version, dependsOn...)
+ */
+QByteArray UnixCommand::getAURPackageVersionInformation()
+{
+  QByteArray result;
+
+  if (StrConstants::getForeignRepositoryToolName() == "kcp")
+  {
+    result = performAURCommand("-lO");
+  }
+  else if (StrConstants::getForeignRepositoryToolName() != "kcp")
+  {
+    result = performAURCommand("-Qua");
+  }
+
+  return result;
+}
+
+/*
+ * Given a package name, returns a string containing all the files inside it
+ */
+QByteArray UnixCommand::getPackageContentsUsingPacman(const QString& pkgName)
+{
+  QByteArray res = performQuery("query -f " + pkgName);
+  return res;
+}
+
+/*
+ * Check if pkgfile is installed on the system
+ */
+bool UnixCommand::isPkgfileInstalled()
+{
+  QProcess pkgfile;
+  ProcessWatcher watcher(&pkgfile);
+
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  pkgfile.setProcessEnvironment(env);
+
+  pkgfile.start("pkgfile -V");
+  pkgfile.waitForFinished();
+
+  return pkgfile.exitStatus() == QProcess::NormalExit;
+}
+
+/*
+ * Given a package name, which can be installed or uninstalled on system
+ * returns a string containing all the files inside it, the file list is
+ * obtained using pkgfile
+ */
+QByteArray UnixCommand::getPackageContentsUsingPkgfile(const QString &pkgName)
+{
+  QByteArray result("");
+  QProcess pkgfile;
+  ProcessWatcher watcher(&pkgfile);
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.insert("LANG", "C");
+  env.insert("LC_MESSAGES", "C");
+  pkgfile.setProcessEnvironment(env);
+
+  pkgfile.start("pkgfile -l " + pkgName);
+  pkgfile.waitForFinished();
+  result = pkgfile.readAllStandardOutput();
+  watcher.addBytesRead(result.size());
+
+  return result;
+}
+
+/*
+ * Given a complete file path, returns the package that provides that file
+ */
+QString UnixCommand::getPackageByFilePath(const QString &filePath)
+{
+  QString pkgName="";
+  QString out = performQuery("query -o " + filePath);
+
+  if (!out.isEmpty())
+  {
+    int pos = out.indexOf(":");
+    if (pos != -1)
+    {      
+      pkgName = out.left(pos);
+      //Now we have to remove the pkg version...
+      int dash = pkgName.lastIndexOf("-");
+      if (dash != -1)
+      {
+        pkgName = pkgName.left(dash);
+      }
+    }
+  }
+
+  return pkgName;
+}
+
+/*
+ * Based on the given file, we use 'slocate' to suggest complete paths
+ */
+QStringList UnixCommand::getFilePathSuggestions(const QString &file)
+{
+  QProcess slocate;
+  ProcessWatcher watcher(&slocate);
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.insert("LANG", "C");
+  env.insert("LC_MESSAGES", "C");
+  slocate.setProcessEnvironment(env);
+  slocate.start("slocate -l 8 " + file);
+  slocate.waitForFinished();
+
+  QString ba = slocate.readAllStandardOutput();
+  watcher.addBytesRead(ba.size());
+  return ba.split("\n", QString::SkipEmptyParts);
+}
+
+/*
+ * Retrives the list of package groups
+ */
+QByteArray UnixCommand::getPackageGroups()
+{
+  QByteArray res = performQuery(QStringList("-Sg"));
+  return res;
+}
+
+/*
+ * Given a group name, returns a string containing all packages from it
+ */
+QByteArray UnixCommand::getPackagesFromGroup(const QString &groupName)
+{
+  QByteArray res =
+      performQuery(QString("--print-format \"%r %n\" -Spg " ) + groupName);
+
+  return res;
+}
+
+/*
+ * Retrieves the list of installed packages in a special format for TargetList
+ */
+QByteArray UnixCommand::getInstalledPackages()
+{
+  QString args = "query '%n-%v %n#%v";
+  QByteArray res = performQuery(args);
+  return res;
+}
+
+/*
+ * Retrieves the list of targets needed to update the entire system or a given package
+ */
+QByteArray UnixCommand::getTargetUpgradeList(const QString &pkgName)
+{
+  QString args;
+  QByteArray res = "";
+
+  if(!pkgName.isEmpty())
+  {
+    args = "install -n -f -Rs " + pkgName;
+    res = performQuery(args);
+  }
+  else //pkg upgrade
+  {
+    args = "install -un";
+    res = performQuery(args);
+  }
+
+  return res;
+}
+
+/*
+ * Given a package name, retrieves the list of all targets needed for its removal
+ */
+QByteArray UnixCommand::getTargetRemovalList(const QString &pkgName)
+{
+  QString args;
+  QByteArray res = "";
+
+  if(!pkgName.isEmpty())
+  {
+    args = "remove -R -n " + pkgName;
+    res = performQuery(args);
+  }
+
+  return res;
+}
+
+/*
+ * Retrieves the given field for a local package search
+ */
+QByteArray UnixCommand::getFieldFromLocalPackage(const QString &field, const QString &pkgName)
+{
+  QByteArray res = performQuery("query -p " + field + " " + pkgName);
+  return res;
+}
+
+/*
+ * Retrieves the given field for a remote package search
+ */
+QByteArray UnixCommand::getFieldFromRemotePackage(const QString &field, const QString &pkgName)
+{
+  QByteArray res = performQuery("query -R -p " + field + " " + pkgName);
+  return res;
+}
+
+/*
+ * Retrieves the BSDFlavour where OctoPkg is running on!
+ * Reads file "/etc/os-release" and searchs for compatible OctoPkg BSDs
+ */
+LinuxDistro UnixCommand::getLinuxDistro()
+{
+  static LinuxDistro ret;
+  static bool firstTime = true;
+
+  if (firstTime)
+  {
+    if (QFile::exists("/etc/os-release"))
+    {
+      QFile file("/etc/os-release");
+
+      if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        ret = ectn_UNKNOWN;
+
+      QString contents = file.readAll();
+
+      if (contents.contains("PRETTY_NAME=\"void\""))
+      {
+        ret = ectn_VOID;
+      }
+      else
+      {
+        ret = ectn_UNKNOWN;
+      }
+    }
+
+    firstTime = false;
+  }
+
+  return ret;
+}
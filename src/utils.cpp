@@ -28,6 +28,7 @@
 #include "strconstants.h"
 #include "xbpsexec.h"
 #include "searchbar.h"
+#include "processaccounting.h"
 
 #include <QStandardItemModel>
 #include <QModelIndex>
@@ -70,6 +71,8 @@ utils::ProcessWrapper::ProcessWrapper(QObject *parent) :
   connect(m_timerSingleShot, SIGNAL(timeout()), this, SLOT(onSingleShot()));
   connect(m_timer, SIGNAL(timeout()), this, SLOT(onTimer()));
   connect(m_process, SIGNAL(started()), SLOT(onProcessStarted()));
+
+  new ProcessWatcher(m_process, m_process);
 }
 
 /*
@@ -190,6 +193,7 @@ void utils::ProcessWrapper::onSingleShot()
 void utils::ProcessWrapper::onTimer()
 {
   QProcess proc;
+  ProcessWatcher watcher(&proc);
   QString cmd = QString("ps -p %1 %2").arg(m_pidSH).arg(m_pidAUR);
 
   //qDebug() << "PIDS: " << cmd << "\n";
@@ -199,6 +203,7 @@ void utils::ProcessWrapper::onTimer()
 
   //If any of the processes have finished...
   QString out = proc.readAll();
+  watcher.addBytesRead(out.size());
 
   //qDebug() << "Output: " << out << "\n";
 
@@ -23,13 +23,14 @@
 
 #include <QObject>
 #include <QTimer>
-#include <QStandardItemModel>
 #include <QModelIndex>
 #include <QProcess>
 #include "constants.h"
 
+class QStandardItemModel;
 class QTextEdit;
 class QTextBrowser;
+class QWidget;
 class SearchBar;
 
 namespace utils{
@@ -23,11 +23,15 @@
 #include "strconstants.h"
 #include "settingsmanager.h"
 #include "terminal.h"
+#include "systemcapabilities.h"
+#include "processaccounting.h"
 #include <iostream>
 
 #include <QApplication>
 #include <QProcess>
 #include <QMessageBox>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QDebug>
 
 /*
@@ -41,89 +45,30 @@
  * Checks if KDE is running
  */
 bool WMHelper::isKDERunning(){
-  static bool ret;
-  static bool firstTime = true;
-
-  if (firstTime)
-  {
-    QProcess proc;
-    ret = false;
-    QStringList kdeDesktops = QStringList() << ctn_KDE_DESKTOP << ctn_KDE_X11_DESKTOP << ctn_KDE_WAYLAND_DESKTOP;
-    QStringList::const_iterator constIterator;
-
-    for (constIterator = kdeDesktops.constBegin(); constIterator != kdeDesktops.constEnd(); ++constIterator) {
-      QString desktop = (*constIterator).toLocal8Bit().constData();
-      proc.start("ps -A -o command");
-      proc.waitForStarted();
-      proc.waitForFinished();
-
-      QString out = proc.readAll();
-
-      proc.close();
-
-      if (out.count(desktop)>0)
-      {
-        ret = true;
-        break;
-      }
-    }
-
-    firstTime = false;
-  }
-
-  return ret;
+  return (SystemCapabilities::isProcessRunning(ctn_KDE_DESKTOP) ||
+          SystemCapabilities::isProcessRunning(ctn_KDE_X11_DESKTOP) ||
+          SystemCapabilities::isProcessRunning(ctn_KDE_WAYLAND_DESKTOP));
 }
 
 /*
  * Checks if TDE is running
  */
 bool WMHelper::isTDERunning(){
-  QProcess proc;
-  proc.start("ps -A -o command");
-  proc.waitForStarted();
-  proc.waitForFinished();
-
-  QString out = proc.readAll();
-  proc.close();
-
-  if (out.count(ctn_TDE_DESKTOP)>0)
-    return true;
-  else
-    return false;
+  return SystemCapabilities::isProcessRunning(ctn_TDE_DESKTOP);
 }
 
 /*
  * Checks if XFCE is running
  */
 bool WMHelper::isXFCERunning(){
-  QProcess proc;
-  proc.start("ps -A -o command");
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = proc.readAll();
-  proc.close();
-
-  if (out.count(ctn_XFCE_DESKTOP)>0)
-    return true;
-  else
-    return false;
+  return SystemCapabilities::isProcessRunning(ctn_XFCE_DESKTOP);
 }
 
 /*
  * Checks if LXDE is running
  */
 bool WMHelper::isLXDERunning(){
-  QProcess proc;
-  proc.start("ps -A -o command");
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = proc.readAll();
-  proc.close();
-
-  if (out.count(ctn_LXDE_DESKTOP)>0)
-    return true;
-  else
-    return false;
+  return SystemCapabilities::isProcessRunning(ctn_LXDE_DESKTOP);
 }
 
 /*
@@ -131,69 +76,28 @@ bool WMHelper::isLXDERunning(){
  */
 bool WMHelper::isLXQTRunning()
 {
-  QProcess proc;
-  proc.start("ps -A -o command");
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = proc.readAll();
-  proc.close();
-
-  if (out.count(ctn_LXQT_DESKTOP)>0)
-    return true;
-  else
-    return false;
+  return SystemCapabilities::isProcessRunning(ctn_LXQT_DESKTOP);
 }
 
 /*
  * Checks if OpenBox is running
  */
 bool WMHelper::isOPENBOXRunning(){
-  QProcess proc;
-  proc.start("ps -A -o command");
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = proc.readAll();
-  proc.close();
-
-  if (out.count(ctn_OPENBOX_DESKTOP)>0)
-    return true;
-  else
-      return false;
+  return SystemCapabilities::isProcessRunning(ctn_OPENBOX_DESKTOP);
 }
 
 /*
  * Checks if MATE is running
  */
 bool WMHelper::isMATERunning(){
-  QStringList slParam;
-  QProcess proc;
-  proc.start("ps -A -o command");
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = proc.readAll();
-  proc.close();
-
-  if (out.count(ctn_MATE_DESKTOP)>0)
-    return true;
-  else
-    return false;
+  return SystemCapabilities::isProcessRunning(ctn_MATE_DESKTOP);
 }
 
 /*
  * Checks if Cinnamon is running
  */
 bool WMHelper::isCinnamonRunning(){
-  QProcess proc;
-  proc.start("ps -A -o command");
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = proc.readAll();
-  proc.close();
-
-  if (out.count(ctn_CINNAMON_DESKTOP)>0)
-    return true;
-  else
-    return false;
+  return SystemCapabilities::isProcessRunning(ctn_CINNAMON_DESKTOP);
 }
 
 /*
@@ -201,24 +105,14 @@ bool WMHelper::isCinnamonRunning(){
  */
 bool WMHelper::isRazorQtRunning()
 {
-  QProcess proc;
-  proc.start("ps -A -o command");
-  proc.waitForStarted();
-  proc.waitForFinished();
-  QString out = proc.readAll();
-  proc.close();
-
-  if (out.count(ctn_RAZORQT_DESKTOP)>0)
-    return true;
-  else
-    return false;
+  return SystemCapabilities::isProcessRunning(ctn_RAZORQT_DESKTOP);
 }
 
 /*
  * Retrieves the XFCE editor...
  */
 QString WMHelper::getXFCEEditor(){
-  if (UnixCommand::hasTheExecutable(ctn_XFCE_EDITOR))
+  if (SystemCapabilities::hasExecutable(ctn_XFCE_EDITOR))
     return ctn_XFCE_EDITOR;
   else
     return ctn_XFCE_EDITOR_ALT;
@@ -264,7 +158,7 @@ QString WMHelper::getTDESUCommand(){
  */
 QString WMHelper::getGKSUCommand(){
   QString result;
-  result = UnixCommand::discoverBinaryPath(ctn_GKSU_2);
+  result = SystemCapabilities::getExecutablePath(ctn_GKSU_2);
   result += " -u root -m " + QString("\"") + StrConstants::getEnterAdministratorsPassword() + QString("\" ");
 
   return result;
@@ -282,29 +176,32 @@ QString WMHelper::getLXQTSUCommand(){
 
 /*
  * The generic SU get method. It retrieves the SU you have installed in your system!
+ * The front-end is chosen only once, when SystemCapabilities probes the system.
  */
 QString WMHelper::getSUCommand(){
-  QString result(ctn_NO_SU_COMMAND);
+  static QMutex mutex;
+  static QString suFrontEnd;
+  static QString result;
+  QString currentFrontEnd = SystemCapabilities::getSUFrontEnd();
+
+  //It's called from QtConcurrent workers too
+  QMutexLocker locker(&mutex);
 
-  if (isXFCERunning() && (UnixCommand::hasTheExecutable(ctn_GKSU_2))){
+  if (!result.isEmpty() && currentFrontEnd == suFrontEnd) return result;
+
+  suFrontEnd = currentFrontEnd;
+  result = ctn_NO_SU_COMMAND;
+
+  if (suFrontEnd == ctn_GKSU_2){
     result = getGKSUCommand();
   }
-  else if (isKDERunning()){        
+  else if (suFrontEnd == ctn_KDESU){
     result = getKDESUCommand();
   }
-  else if (isTDERunning() && UnixCommand::hasTheExecutable(ctn_TDESU)){
+  else if (suFrontEnd == ctn_TDESU){
     result = getTDESUCommand();
   }
-  else if (UnixCommand::hasTheExecutable(ctn_GKSU_2)){
-    result = getGKSUCommand();
-  }
-  else if (UnixCommand::hasTheExecutable(ctn_KDESU)){
-    result = getKDESUCommand();
-  }
-  else if (UnixCommand::hasTheExecutable(ctn_TDESU)){
-    result = getTDESUCommand();
-  } 
-  else if (UnixCommand::hasTheExecutable(ctn_LXQTSU)){
+  else if (suFrontEnd == ctn_LXQTSU){
     result = getLXQTSUCommand();
   }
 
@@ -315,9 +212,9 @@ QString WMHelper::getSUCommand(){
  * Chooses whether to use kde-open or kde5-open
  */
 QString WMHelper::getKDEOpenHelper(){
-  if (UnixCommand::hasTheExecutable(ctn_KDE4_OPEN))
+  if (SystemCapabilities::hasExecutable(ctn_KDE4_OPEN))
     return ctn_KDE4_OPEN;
-  else if (UnixCommand::hasTheExecutable(ctn_KDE5_OPEN))
+  else if (SystemCapabilities::hasExecutable(ctn_KDE5_OPEN))
     return ctn_KDE5_OPEN;
   else
     return "NONE";
@@ -338,58 +235,57 @@ void WMHelper::openFile(const QString& fileName){
     if ( res == QMessageBox::No ) return;
   }
 
-  QProcess *p = new QProcess(qApp->activeWindow());
   QStringList s;
 
-  if (isXFCERunning() && UnixCommand::hasTheExecutable(ctn_XFCE_FILE_MANAGER)){
+  if (isXFCERunning() && SystemCapabilities::hasExecutable(ctn_XFCE_FILE_MANAGER)){
     s << fileToOpen;
-    p->startDetached( ctn_XFCE_FILE_MANAGER, s );
+    ProcessAccounting::startDetached( ctn_XFCE_FILE_MANAGER, s );
   }
-  else if (isKDERunning() && UnixCommand::hasTheExecutable(ctn_KDE_FILE_MANAGER)){
+  else if (isKDERunning() && SystemCapabilities::hasExecutable(ctn_KDE_FILE_MANAGER)){
     s << "exec";
     s << "file:" + fileToOpen;
-    p->startDetached( ctn_KDE_FILE_MANAGER, s );
+    ProcessAccounting::startDetached( ctn_KDE_FILE_MANAGER, s );
   }
-  else if (UnixCommand::hasTheExecutable(ctn_KDE4_FILE_MANAGER)){
+  else if (SystemCapabilities::hasExecutable(ctn_KDE4_FILE_MANAGER)){
     s << fileToOpen;
 
     if (UnixCommand::isRootRunning())
     {
-      p->startDetached( "dbus-launch " + getKDEOpenHelper() + " " + fileToOpen );
+      ProcessAccounting::startDetached( "dbus-launch " + getKDEOpenHelper() + " " + fileToOpen );
     }
     else
     {
-      p->startDetached( getKDEOpenHelper(), s );
+      ProcessAccounting::startDetached( getKDEOpenHelper(), s );
     }
   }
-  else if (isTDERunning() && UnixCommand::hasTheExecutable(ctn_TDE_FILE_MANAGER)){
+  else if (isTDERunning() && SystemCapabilities::hasExecutable(ctn_TDE_FILE_MANAGER)){
     s << "exec";
     s << "file:" + fileToOpen;
-    p->startDetached( ctn_TDE_FILE_MANAGER, s );
+    ProcessAccounting::startDetached( ctn_TDE_FILE_MANAGER, s );
   }
-  else if (isMATERunning() && UnixCommand::hasTheExecutable(ctn_MATE_FILE_MANAGER)){
+  else if (isMATERunning() && SystemCapabilities::hasExecutable(ctn_MATE_FILE_MANAGER)){
     s << fileToOpen;
-    p->startDetached( ctn_MATE_FILE_MANAGER, s );
+    ProcessAccounting::startDetached( ctn_MATE_FILE_MANAGER, s );
   }
-  else if (isCinnamonRunning() && UnixCommand::hasTheExecutable(ctn_CINNAMON_FILE_MANAGER)){
+  else if (isCinnamonRunning() && SystemCapabilities::hasExecutable(ctn_CINNAMON_FILE_MANAGER)){
     s << fileToOpen;
-    p->startDetached( ctn_CINNAMON_FILE_MANAGER, s );
+    ProcessAccounting::startDetached( ctn_CINNAMON_FILE_MANAGER, s );
   }
-  else if (isLXQTRunning() && UnixCommand::hasTheExecutable(ctn_LXQT_FILE_MANAGER)){
+  else if (isLXQTRunning() && SystemCapabilities::hasExecutable(ctn_LXQT_FILE_MANAGER)){
     s << fileToOpen;
-    p->startDetached( ctn_LXQT_FILE_MANAGER, s );
+    ProcessAccounting::startDetached( ctn_LXQT_FILE_MANAGER, s );
   }
-  else if (UnixCommand::hasTheExecutable(ctn_ARCHBANG_FILE_MANAGER)){
+  else if (SystemCapabilities::hasExecutable(ctn_ARCHBANG_FILE_MANAGER)){
     s << fileToOpen;
-    p->startDetached( ctn_ARCHBANG_FILE_MANAGER, s );
+    ProcessAccounting::startDetached( ctn_ARCHBANG_FILE_MANAGER, s );
   }
-  else if (UnixCommand::hasTheExecutable(ctn_XFCE_FILE_MANAGER)){
+  else if (SystemCapabilities::hasExecutable(ctn_XFCE_FILE_MANAGER)){
     s << fileToOpen;
-    p->startDetached( ctn_XFCE_FILE_MANAGER, s );
+    ProcessAccounting::startDetached( ctn_XFCE_FILE_MANAGER, s );
   }
-  else if (UnixCommand::hasTheExecutable(ctn_LXDE_FILE_MANAGER)){
+  else if (SystemCapabilities::hasExecutable(ctn_LXDE_FILE_MANAGER)){
     s << fileToOpen;
-    p->startDetached( ctn_LXDE_FILE_MANAGER, s );
+    ProcessAccounting::startDetached( ctn_LXDE_FILE_MANAGER, s );
   }
 }
 
@@ -397,48 +293,47 @@ void WMHelper::openFile(const QString& fileName){
  * Edits a file based on your DE.
  */
 void WMHelper::editFile( const QString& fileName, EditOptions opt ){
-  QProcess *process = new QProcess(qApp->activeWindow());
   QString p;
 
-  if (isKDERunning() && UnixCommand::hasTheExecutable(ctn_KDE4_EDITOR)){
+  if (isKDERunning() && SystemCapabilities::hasExecutable(ctn_KDE4_EDITOR)){
     p += ctn_KDE4_EDITOR + " " + fileName;
   }
-  else if (isMATERunning() && UnixCommand::hasTheExecutable(ctn_MATE_EDITOR)){
+  else if (isMATERunning() && SystemCapabilities::hasExecutable(ctn_MATE_EDITOR)){
     p = ctn_MATE_EDITOR + " " + fileName;
   }
-  else if (isLXQTRunning() && UnixCommand::hasTheExecutable(ctn_LXQT_EDITOR)){
+  else if (isLXQTRunning() && SystemCapabilities::hasExecutable(ctn_LXQT_EDITOR)){
     p = ctn_LXQT_EDITOR + " " + fileName;
   }
-  else if (UnixCommand::hasTheExecutable(ctn_ARCHBANG_EDITOR))
+  else if (SystemCapabilities::hasExecutable(ctn_ARCHBANG_EDITOR))
   {
     p = ctn_ARCHBANG_EDITOR + " " + fileName;
   }
-  else if (UnixCommand::hasTheExecutable(ctn_CINNAMON_EDITOR)){
+  else if (SystemCapabilities::hasExecutable(ctn_CINNAMON_EDITOR)){
     p = ctn_CINNAMON_EDITOR + " " + fileName;
   }
-  else if (UnixCommand::hasTheExecutable(ctn_ARCHBANG_EDITOR))
+  else if (SystemCapabilities::hasExecutable(ctn_ARCHBANG_EDITOR))
   {
     p = ctn_ARCHBANG_EDITOR + " " + fileName;
   }
-  else if (isXFCERunning() && (UnixCommand::hasTheExecutable(ctn_XFCE_EDITOR) ||
-                               UnixCommand::hasTheExecutable(ctn_XFCE_EDITOR_ALT))){
+  else if (isXFCERunning() && (SystemCapabilities::hasExecutable(ctn_XFCE_EDITOR) ||
+                               SystemCapabilities::hasExecutable(ctn_XFCE_EDITOR_ALT))){
 
     p = getXFCEEditor() + " " + fileName;
   }
-  else if (isTDERunning() && UnixCommand::hasTheExecutable(ctn_TDE_EDITOR)){
+  else if (isTDERunning() && SystemCapabilities::hasExecutable(ctn_TDE_EDITOR)){
     p += ctn_TDE_EDITOR + " " + fileName;
   }
-  else if (UnixCommand::hasTheExecutable(ctn_XFCE_EDITOR) || UnixCommand::hasTheExecutable(ctn_XFCE_EDITOR_ALT)){
+  else if (SystemCapabilities::hasExecutable(ctn_XFCE_EDITOR) || SystemCapabilities::hasExecutable(ctn_XFCE_EDITOR_ALT)){
     p = getXFCEEditor() + " " + fileName;
   }
 
   if (UnixCommand::isRootRunning() || opt == ectn_EDIT_AS_NORMAL_USER)
   {
-    process->startDetached("/bin/sh -c \"" + p + "\"");
+    ProcessAccounting::startDetached("/bin/sh -c \"" + p + "\"");
   }
   else
   {
-    process->startDetached(getSUCommand() + p);
+    ProcessAccounting::startDetached(getSUCommand() + p);
   }
 }
 
@@ -446,7 +341,6 @@ void WMHelper::editFile( const QString& fileName, EditOptions opt ){
  * Opens a directory based on your DE.
  */
 void WMHelper::openDirectory( const QString& dirName ){
-  QProcess *p = new QProcess(qApp->activeWindow());
   QStringList s;
   QString dir(dirName);
 
@@ -460,76 +354,76 @@ void WMHelper::openDirectory( const QString& dirName ){
 
   if (f.exists())
   {
-    if (UnixCommand::hasTheExecutable(ctn_ARCHBANG_FILE_MANAGER))
+    if (SystemCapabilities::hasExecutable(ctn_ARCHBANG_FILE_MANAGER))
     {
       s << dir;
-      p->startDetached( ctn_ARCHBANG_FILE_MANAGER, s );
+      ProcessAccounting::startDetached( ctn_ARCHBANG_FILE_MANAGER, s );
     }
-    else if(isXFCERunning() && UnixCommand::hasTheExecutable(ctn_XFCE_FILE_MANAGER))
+    else if(isXFCERunning() && SystemCapabilities::hasExecutable(ctn_XFCE_FILE_MANAGER))
     {
       s << dir;
-      p->startDetached( ctn_XFCE_FILE_MANAGER, s );
+      ProcessAccounting::startDetached( ctn_XFCE_FILE_MANAGER, s );
     }
     else if (isKDERunning())
     {
-      if (UnixCommand::hasTheExecutable(ctn_KDE4_FILE_MANAGER))
+      if (SystemCapabilities::hasExecutable(ctn_KDE4_FILE_MANAGER))
       {
         s << dir;
 
         if (UnixCommand::isRootRunning())
         {
-          p->startDetached( "dbus-launch " + ctn_KDE4_FILE_MANAGER + " " + dir);
+          ProcessAccounting::startDetached( "dbus-launch " + ctn_KDE4_FILE_MANAGER + " " + dir);
         }
         else
         {
-          p->startDetached( ctn_KDE4_FILE_MANAGER, s);
+          ProcessAccounting::startDetached( ctn_KDE4_FILE_MANAGER, s);
         }
       }
-      else if (UnixCommand::hasTheExecutable(ctn_KDE_FILE_MANAGER))
+      else if (SystemCapabilities::hasExecutable(ctn_KDE_FILE_MANAGER))
       {
         s << "newTab";
         s << dir;
-        p->startDetached( ctn_KDE_FILE_MANAGER, s );
+        ProcessAccounting::startDetached( ctn_KDE_FILE_MANAGER, s );
       }
     }
     else if (isTDERunning())
     {
-      if (UnixCommand::hasTheExecutable(ctn_TDE_FILE_MANAGER))
+      if (SystemCapabilities::hasExecutable(ctn_TDE_FILE_MANAGER))
       {
         s << "newTab";
         s << dir;
-        p->startDetached( ctn_TDE_FILE_MANAGER, s );
+        ProcessAccounting::startDetached( ctn_TDE_FILE_MANAGER, s );
       }
     }
-    else if (isMATERunning() && UnixCommand::hasTheExecutable(ctn_MATE_FILE_MANAGER))
+    else if (isMATERunning() && SystemCapabilities::hasExecutable(ctn_MATE_FILE_MANAGER))
     {
       s << dir;
-      p->startDetached( ctn_MATE_FILE_MANAGER, s );
+      ProcessAccounting::startDetached( ctn_MATE_FILE_MANAGER, s );
     }
-    else if (UnixCommand::hasTheExecutable(ctn_ANTERGOS_FILE_MANAGER))
+    else if (SystemCapabilities::hasExecutable(ctn_ANTERGOS_FILE_MANAGER))
     {
       s << dir;
-      p->startDetached( ctn_ANTERGOS_FILE_MANAGER, s );
+      ProcessAccounting::startDetached( ctn_ANTERGOS_FILE_MANAGER, s );
     }
-    else if (isCinnamonRunning() && UnixCommand::hasTheExecutable(ctn_CINNAMON_FILE_MANAGER))
+    else if (isCinnamonRunning() && SystemCapabilities::hasExecutable(ctn_CINNAMON_FILE_MANAGER))
     {
       s << dir;
-      p->startDetached( ctn_CINNAMON_FILE_MANAGER, s );
+      ProcessAccounting::startDetached( ctn_CINNAMON_FILE_MANAGER, s );
     }
-    else if (isLXQTRunning() && UnixCommand::hasTheExecutable(ctn_LXQT_FILE_MANAGER))
+    else if (isLXQTRunning() && SystemCapabilities::hasExecutable(ctn_LXQT_FILE_MANAGER))
     {
       s << dir;
-      p->startDetached( ctn_LXQT_FILE_MANAGER, s );
+      ProcessAccounting::startDetached( ctn_LXQT_FILE_MANAGER, s );
     }
-    else if (UnixCommand::hasTheExecutable(ctn_XFCE_FILE_MANAGER))
+    else if (SystemCapabilities::hasExecutable(ctn_XFCE_FILE_MANAGER))
     {
       s << dir;
-      p->startDetached( ctn_XFCE_FILE_MANAGER, s );
+      ProcessAccounting::startDetached( ctn_XFCE_FILE_MANAGER, s );
     }
-    else if (UnixCommand::hasTheExecutable(ctn_LXDE_FILE_MANAGER))
+    else if (SystemCapabilities::hasExecutable(ctn_LXDE_FILE_MANAGER))
     {
       s << dir;
-      p->startDetached( ctn_LXDE_FILE_MANAGER, s );
+      ProcessAccounting::startDetached( ctn_LXDE_FILE_MANAGER, s );
     }
   }
 }
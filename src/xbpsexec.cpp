@@ -22,6 +22,7 @@
 #include "strconstants.h"
 #include "unixcommand.h"
 #include "wmhelper.h"
+#include "tracer.h"
 
 #include <QRegularExpression>
 #include <QDebug>
@@ -56,6 +57,37 @@ XBPSExec::XBPSExec(QObject *parent) : QObject(parent)
                    this, SLOT( onReadOutputError()));
 }
 
+/*
+ * Sets the list of installed packages used to validate "removing" output lines
+ */
+void XBPSExec::setInstalledPackages(const QSet<QString> &installedPackages)
+{
+  m_installedPackages = installedPackages;
+}
+
+/*
+ * Checks if pkgName (which may come with its version) is one of the transaction targets
+ * or was installed when the transaction started. No xbps-query is spawned here!
+ */
+bool XBPSExec::isKnownPackage(const QString &pkgName) const
+{
+  QString name = pkgName;
+  name.remove("`");
+  name.remove("'");
+
+  if (m_targetPackages.contains(name) || m_installedPackages.contains(name))
+    return true;
+
+  int dash = name.lastIndexOf("-");
+  if (dash > 0)
+  {
+    name = name.left(dash);
+    return (m_targetPackages.contains(name) || m_installedPackages.contains(name));
+  }
+
+  return false;
+}
+
 /*
  * Let's remove UnixCommand temporary file...
  */
@@ -122,6 +154,7 @@ bool XBPSExec::searchForKeyVerbs(QString output)
  */
 bool XBPSExec::splitOutputStrings(QString output)
 {
+  TraceSpan span("XBPSExec::splitOutputStrings");
   bool res = true;
   QString msg = output.trimmed();
   QStringList msgs = msg.split(QRegExp("\\n"), QString::SkipEmptyParts);
@@ -330,7 +363,7 @@ void XBPSExec::parseXBPSProcessOutput(QString output)
         //Does this package exist or is it a proccessOutput buggy string???
         QString pkgName = msg.mid(9).trimmed();
 
-        if (pkgName.indexOf("...") != -1 || UnixCommand::isPackageInstalled(pkgName))
+        if (pkgName.indexOf("...") != -1 || isKnownPackage(pkgName))
         {
           prepareTextToPrint("<b><font color=\"#E55451\">" + msg + "</font></b>"); //RED
         }
@@ -469,6 +502,7 @@ void XBPSExec::prepareTextToPrint(QString str, TreatString ts, TreatURLLinks tl)
  */
 void XBPSExec::onStarted()
 {
+  traceAsyncBegin("XBPSExec transaction", this);
   //First we output the name of action we are starting to execute!
   if (m_commandExecuting == ectn_CLEAN_CACHE)
   {
@@ -515,7 +549,18 @@ void XBPSExec::onStarted()
  */
 void XBPSExec::onReadOutput()
 {
-  if (WMHelper::getSUCommand().contains("kdesu"))
+  TraceSpan span("XBPSExec::onReadOutput");
+  if (m_unixCommand->isUsingPrivilegedHelper())
+  {
+    //octoxbps-helper hands us exactly what XBPS printed
+    QString output = m_unixCommand->readAllStandardOutput();
+
+    if (!output.trimmed().isEmpty())
+    {
+      splitOutputStrings(output);
+    }
+  }
+  else if (WMHelper::getSUCommand().contains("kdesu"))
   {
     QString output = m_unixCommand->readAllStandardOutput();
 
@@ -555,6 +600,7 @@ void XBPSExec::onReadOutput()
  */
 void XBPSExec::onReadOutputError()
 {
+  TraceSpan span("XBPSExec::onReadOutputError");
   QString msg = m_unixCommand->readAllStandardError();
   msg = msg.remove("Fontconfig warning: \"/etc/fonts/conf.d/50-user.conf\", line 14:");
   msg = msg.remove("reading configurations from ~/.fonts.conf is deprecated. please move it to /home/arnt/.config/fontconfig/fonts.conf manually");
@@ -572,6 +618,7 @@ void XBPSExec::onReadOutputError()
  */
 void XBPSExec::onFinished(int exitCode, QProcess::ExitStatus es)
 {
+  traceAsyncEnd("XBPSExec transaction", this);
   emit finished(exitCode, es);
 }
 
@@ -656,6 +703,7 @@ void XBPSExec::doRemove(const QString &listOfPackages)
 {
   QString command = "xbps-remove -R -f -y " + listOfPackages;
 
+  m_targetPackages = listOfPackages.split(" ", QString::SkipEmptyParts).toSet();
   m_lastCommandList.clear();
   m_lastCommandList.append("xbps-remove -R -f " + listOfPackages + ";");
   m_lastCommandList.append("echo -e;");
@@ -687,6 +735,7 @@ void XBPSExec::doRemoveAndInstall(const QString &listOfPackagestoRemove, const Q
   QString command = "xbps-remove -R -f -y " + listOfPackagestoRemove +
       "; xbps-install -f " + listOfPackagestoInstall;
 
+  m_targetPackages = listOfPackagestoRemove.split(" ", QString::SkipEmptyParts).toSet();
   m_lastCommandList.clear();
   m_lastCommandList.append("xbps-remove -R -f " + listOfPackagestoRemove + ";");
   m_lastCommandList.append("xbps-install -f " + listOfPackagestoInstall + ";");
@@ -22,6 +22,7 @@
 #define XBPSEXEC_H
 
 #include <QObject>
+#include <QSet>
 #include "constants.h"
 #include "unixcommand.h"
 
@@ -29,6 +30,8 @@ class XBPSExec : public QObject
 {
   Q_OBJECT
 
+  friend class OctoXBPSBench;
+
 private:
   bool m_iLoveCandy;
   bool m_debugMode;
@@ -36,7 +39,10 @@ private:
   CommandExecuting m_commandExecuting;
   QStringList m_lastCommandList; //run in terminal commands
   QStringList m_textPrinted;
+  QSet<QString> m_targetPackages; //packages this transaction deals with
+  QSet<QString> m_installedPackages; //installed packages when the transaction started
 
+  bool isKnownPackage(const QString &pkgName) const;
   bool searchForKeyVerbs(QString output);
   bool splitOutputStrings(QString output);
   void parseXBPSProcessOutput(QString output);
@@ -54,6 +60,7 @@ public:
   virtual ~XBPSExec();
 
   void setDebugMode(bool value);
+  void setInstalledPackages(const QSet<QString> &installedPackages);
   void runLastestCommandInTerminal();
   void removeTemporaryFile();
 
@@ -0,0 +1,161 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "xbpsplist.h"
+#include "unixcommand.h"
+#include "queryrecorder.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QProcessEnvironment>
+#include <QStringList>
+#include <QXmlStreamReader>
+
+/*
+ * Reads the value whose start element the reader is positioned at
+ */
+QVariant XBPSPlist::readValue(QXmlStreamReader &xml)
+{
+  const QString tag = xml.name().toString();
+
+  if (tag == "dict")
+  {
+    QVariantMap map;
+    QString key;
+
+    while (xml.readNextStartElement())
+    {
+      if (xml.name() == "key")
+        key = xml.readElementText();
+      else
+        map.insert(key, readValue(xml));
+    }
+
+    return map;
+  }
+  else if (tag == "array")
+  {
+    QVariantList list;
+
+    while (xml.readNextStartElement())
+      list.append(readValue(xml));
+
+    return list;
+  }
+  else if (tag == "integer")
+  {
+    return xml.readElementText().toLongLong();
+  }
+  else if (tag == "real")
+  {
+    return xml.readElementText().toDouble();
+  }
+  else if (tag == "true" || tag == "false")
+  {
+    bool res = (tag == "true");
+    xml.skipCurrentElement();
+    return res;
+  }
+
+  //string, data, date and whatever else we don't care about
+  return xml.readElementText(QXmlStreamReader::SkipChildElements);
+}
+
+/*
+ * Parses a whole plist document and returns its root object
+ */
+QVariant XBPSPlist::parse(QIODevice *device)
+{
+  QXmlStreamReader xml(device);
+
+  while (xml.readNextStartElement())
+  {
+    if (xml.name() == "plist")
+    {
+      if (xml.readNextStartElement())
+        return readValue(xml);
+
+      break;
+    }
+  }
+
+  return QVariant();
+}
+
+QVariant XBPSPlist::parse(const QByteArray &data)
+{
+  QBuffer buffer;
+  buffer.setData(data);
+  buffer.open(QIODevice::ReadOnly);
+
+  return parse(&buffer);
+}
+
+QVariant XBPSPlist::parseFile(const QString &fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) return QVariant();
+
+  return parse(&file);
+}
+
+/*
+ * Repodata files and .xbps packages are (compressed) tar archives.
+ * Extracts "member" to memory using bsdtar (or plain tar as a fallback).
+ * Both stop reading at the first match, so the payload after the metadata is never decompressed
+ */
+QByteArray XBPSPlist::extractFromArchive(const QString &archive, const QString &member)
+{
+  QStringList args;
+  QString tar = UnixCommand::discoverBinaryPath("bsdtar");
+
+  if (!tar.isEmpty())
+    args << "-q";
+  else
+  {
+    tar = UnixCommand::discoverBinaryPath("tar");
+    if (tar.isEmpty()) return QByteArray();
+
+    args << "--occurrence=1";
+  }
+
+  return QueryRecorder::execute(tar, args << "-xOf" << archive << member,
+                                QProcessEnvironment::systemEnvironment(), -1);
+}
+
+/*
+ * Returns the paths listed in a "files.plist": regular files, links and configuration files
+ */
+QStringList XBPSPlist::getFileList(const QVariant &filesPlist)
+{
+  QStringList res;
+  QVariantMap sections = filesPlist.toMap();
+
+  foreach(QString section, QStringList() << "files" << "links" << "conf_files")
+  {
+    foreach(QVariant file, sections.value(section).toList())
+    {
+      QString path = file.toMap().value("file").toString();
+      if (!path.isEmpty()) res.append(path);
+    }
+  }
+
+  return res;
+}
@@ -0,0 +1,52 @@
+/*
+* This file is part of OctoXBPS, an open-source GUI for XBPS.
+* Copyright (C) 2015 Alexandre Albuquerque Arnt
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef XBPSPLIST_H
+#define XBPSPLIST_H
+
+#include <QVariant>
+#include <QString>
+#include <QStringList>
+
+class QIODevice;
+class QXmlStreamReader;
+
+/*
+ * Minimal reader for the XML property lists XBPS uses in its package database (pkgdb),
+ * repository indexes and "files.plist" metadata.
+ *
+ * dict -> QVariantMap, array -> QVariantList, string/data/date -> QString,
+ * integer -> qlonglong, real -> double and true/false -> bool
+ */
+
+class XBPSPlist
+{
+private:
+  static QVariant readValue(QXmlStreamReader &xml);
+
+public:
+  static QVariant parse(QIODevice *device);
+  static QVariant parse(const QByteArray &data);
+  static QVariant parseFile(const QString &fileName);
+  static QByteArray extractFromArchive(const QString &archive, const QString &member);
+  static QStringList getFileList(const QVariant &filesPlist);
+};
+
+#endif // XBPSPLIST_H